@@ -0,0 +1,298 @@
+#pragma once
+#ifndef ARENA_HPP_
+#define ARENA_HPP_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace made {
+
+    namespace stl {
+
+        typedef size_t size_type;
+
+        // Growable bump allocator. Each thread bumps inside its own chunk without locking,
+        // the shared mutex is only taken to hand out a new chunk when the current one is full.
+        // Chunks are chained on demand and recycled by Reset() and Rewind().
+        // Reset() must not run concurrently with allocations; marks are per thread.
+        // Sizes no block can hold throw std::bad_alloc, alignments that are not a power
+        // of two throw std::invalid_argument.
+        class Arena
+        {
+            struct Block;
+            struct ThreadCursor;
+        public:
+            static constexpr size_type kDefaultBlockSize = 64 * 1024;
+
+            // Position of the calling thread's cursor, see Mark()/Rewind()
+            struct Marker {
+                Block* block;
+                char* cursor;
+            };
+
+            // Rewinds the calling thread's cursor to where it was at construction
+            class Scope {
+            public:
+                explicit Scope(Arena& arena) : arena_(arena), marker_(arena.Mark()) {}
+                ~Scope() { arena_.Rewind(marker_); }
+                Scope(const Scope&) = delete;
+                Scope& operator=(const Scope&) = delete;
+            private:
+                Arena& arena_;
+                Marker marker_;
+            };
+
+            explicit Arena(size_type block_size = kDefaultBlockSize);
+            ~Arena();
+            Arena(const Arena&) = delete;
+            Arena& operator=(const Arena&) = delete;
+
+            void* AllocBytes(size_type bytes, size_type alignment = alignof(std::max_align_t));
+            template <class T>
+            T* Alloc(size_type count);
+            template <class T, class... Args>
+            T* New(Args&&... args);
+            Marker Mark();
+            void Rewind(const Marker& marker);
+            void Reset();
+            size_type ReservedBytes();
+        private:
+            struct Block {
+                Block* next;
+                size_type size;
+                char* Begin() { return reinterpret_cast<char*>(this + 1); }
+                char* End() { return Begin() + size; }
+            };
+
+            struct ThreadCursor {
+                std::thread::id owner;
+                Block* first = nullptr;
+                Block* current = nullptr;
+                char* cursor = nullptr;
+                char* end = nullptr;
+            };
+
+            // Cursors of the last arenas a thread looked up, newest first
+            struct LocalCache {
+                static constexpr size_type kEntries = 8;
+                struct Entry {
+                    std::uint64_t arena_id;
+                    ThreadCursor* cursor;
+                };
+                Entry entries[kEntries];
+            };
+
+            static std::uint64_t NextId();
+            static char* AlignUp(char* ptr, size_type alignment);
+            static LocalCache& Cache();
+            ThreadCursor& Local();
+            ThreadCursor& LocalSlow();
+            void* Bump(size_type bytes, size_type alignment);
+            void* AllocSlow(ThreadCursor& local, size_type bytes, size_type alignment);
+            Block* AcquireBlock(size_type min_size);
+            void ReleaseBlocks(Block* first);
+
+            const size_type block_size_;
+            const std::uint64_t id_;
+            std::mutex mutex_;
+            Block* free_blocks_ = nullptr;
+            size_type reserved_bytes_ = 0;
+            std::vector<std::unique_ptr<ThreadCursor>> cursors_;
+        };
+
+        inline Arena::Arena(size_type block_size) : block_size_(block_size), id_(NextId()) {}
+
+        inline Arena::~Arena() {
+            Reset();
+            while (free_blocks_) {
+                Block* next = free_blocks_->next;
+                std::free(free_blocks_);
+                free_blocks_ = next;
+            }
+        }
+
+        inline void* Arena::AllocBytes(size_type bytes, size_type alignment) {
+            if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+                throw std::invalid_argument("arena alignment must be a power of two");
+            }
+            return Bump(bytes, alignment);
+        }
+
+        // alignof() is always a power of two, so Alloc() and New() come here directly
+        inline void* Arena::Bump(size_type bytes, size_type alignment) {
+            ThreadCursor& local = Local();
+            char* result = AlignUp(local.cursor, alignment);
+            if (local.cursor && result <= local.end && bytes <= static_cast<size_type>(local.end - result)) {
+                local.cursor = result + bytes;
+                return result;
+            }
+            return AllocSlow(local, bytes, alignment);
+        }
+
+        template <class T>
+        T* Arena::Alloc(size_type count) {
+            if (count > static_cast<size_type>(-1) / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+            return static_cast<T*>(Bump(count * sizeof(T), alignof(T)));
+        }
+
+        template <class T, class... Args>
+        T* Arena::New(Args&&... args) {
+            return new (Bump(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        inline Arena::Marker Arena::Mark() {
+            ThreadCursor& local = Local();
+            return { local.current, local.cursor };
+        }
+
+        inline void Arena::Rewind(const Marker& marker) {
+            ThreadCursor& local = Local();
+            // A mark taken before the first allocation rewinds to the start of the first block,
+            // which is kept so that a scope per request does not take the mutex every time
+            Block* kept = marker.block ? marker.block : local.first;
+            if (!kept) {
+                return;
+            }
+            if (kept->next) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ReleaseBlocks(kept->next);
+                kept->next = nullptr;
+            }
+            local.current = kept;
+            local.cursor = marker.block ? marker.cursor : kept->Begin();
+            local.end = kept->End();
+        }
+
+        inline void Arena::Reset() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& local : cursors_) {
+                ReleaseBlocks(local->first);
+                *local = ThreadCursor{ local->owner };
+            }
+        }
+
+        inline size_type Arena::ReservedBytes() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return reserved_bytes_;
+        }
+
+        inline std::uint64_t Arena::NextId() {
+            static std::atomic<std::uint64_t> next_id(1);
+            return next_id++;
+        }
+
+        inline char* Arena::AlignUp(char* ptr, size_type alignment) {
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(ptr);
+            return reinterpret_cast<char*>((address + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1));
+        }
+
+        // The last few arenas a thread touched are cached, so the lookup under the mutex
+        // only happens on the first allocation of a thread in an arena, or when it uses
+        // more arenas in turns than the cache holds. Ids are never reused, so entries
+        // of destroyed arenas just age out.
+        inline Arena::LocalCache& Arena::Cache() {
+            static thread_local LocalCache cache = {};
+            return cache;
+        }
+
+        inline Arena::ThreadCursor& Arena::Local() {
+            LocalCache& cache = Cache();
+            for (size_type i = 0; i < LocalCache::kEntries; ++i) {
+                if (cache.entries[i].arena_id == id_) {
+                    return *cache.entries[i].cursor;
+                }
+            }
+            return LocalSlow();
+        }
+
+        inline Arena::ThreadCursor& Arena::LocalSlow() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const std::thread::id self = std::this_thread::get_id();
+            ThreadCursor* found = nullptr;
+            for (auto& local : cursors_) {
+                if (local->owner == self) {
+                    found = local.get();
+                    break;
+                }
+            }
+            if (!found) {
+                cursors_.push_back(std::unique_ptr<ThreadCursor>(new ThreadCursor{ self }));
+                found = cursors_.back().get();
+            }
+            LocalCache& cache = Cache();
+            for (size_type i = LocalCache::kEntries - 1; i > 0; --i) {
+                cache.entries[i] = cache.entries[i - 1];
+            }
+            cache.entries[0] = { id_, found };
+            return *found;
+        }
+
+        inline void* Arena::AllocSlow(ThreadCursor& local, size_type bytes, size_type alignment) {
+            // The block header and the alignment padding must fit in size_type too
+            if (bytes > static_cast<size_type>(-1) - (alignment - 1) - sizeof(Block)) {
+                throw std::bad_alloc();
+            }
+            Block* block = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                block = AcquireBlock(bytes + alignment - 1);
+            }
+            if (local.current) {
+                local.current->next = block;
+            }
+            else {
+                local.first = block;
+            }
+            local.current = block;
+            char* result = AlignUp(block->Begin(), alignment);
+            local.cursor = result + bytes;
+            local.end = block->End();
+            return result;
+        }
+
+        inline Arena::Block* Arena::AcquireBlock(size_type min_size) {
+            for (Block** link = &free_blocks_; *link; link = &(*link)->next) {
+                if ((*link)->size >= min_size) {
+                    Block* block = *link;
+                    *link = block->next;
+                    block->next = nullptr;
+                    return block;
+                }
+            }
+            size_type size = min_size > block_size_ ? min_size : block_size_;
+            Block* block = static_cast<Block*>(std::malloc(sizeof(Block) + size));
+            if (!block) {
+                throw std::bad_alloc();
+            }
+            block->next = nullptr;
+            block->size = size;
+            reserved_bytes_ += size;
+            return block;
+        }
+
+        inline void Arena::ReleaseBlocks(Block* first) {
+            if (!first) {
+                return;
+            }
+            Block* last = first;
+            while (last->next) {
+                last = last->next;
+            }
+            last->next = free_blocks_;
+            free_blocks_ = first;
+        }
+    }
+
+}
+
+#endif  // !ARENA_HPP_
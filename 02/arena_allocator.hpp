@@ -0,0 +1,82 @@
+#pragma once
+#ifndef ARENA_ALLOCATOR_HPP_
+#define ARENA_ALLOCATOR_HPP_
+#include <cstddef>
+#include <memory_resource>
+#include <type_traits>
+#include "arena.hpp"
+#include "linear_allocator.hpp"
+
+namespace made {
+
+    namespace stl {
+
+        // std::pmr::memory_resource drawing from an Arena (or LinearAllocator<T>).
+        // Deallocation is a no-op, memory comes back with the arena's Reset()/Rewind().
+        template <class TArena = Arena>
+        class ArenaResource : public std::pmr::memory_resource
+        {
+        public:
+            explicit ArenaResource(TArena& arena) noexcept : arena_(&arena) {}
+            TArena& arena() const noexcept { return *arena_; }
+        private:
+            void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+            void do_deallocate(void*, std::size_t, std::size_t) override {}
+            bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+            TArena* arena_;
+        };
+
+        // Stateful allocator (Allocator concept) drawing from an Arena (or LinearAllocator<T>),
+        // e.g. made::stl::Vector<int, ArenaAlloc<int>> v(ArenaAlloc<int>(arena)).
+        // Deallocation is a no-op, memory comes back with the arena's Reset()/Rewind().
+        template <class T, class TArena = Arena>
+        class ArenaAlloc
+        {
+            template <class U, class UArena>
+            friend class ArenaAlloc;
+        public:
+            using value_type = T;
+            using propagate_on_container_copy_assignment = std::true_type;
+            using propagate_on_container_move_assignment = std::true_type;
+            using propagate_on_container_swap = std::true_type;
+
+            explicit ArenaAlloc(TArena& arena) noexcept : arena_(&arena) {}
+            template <class U>
+            ArenaAlloc(const ArenaAlloc<U, TArena>& other) noexcept : arena_(other.arena_) {}
+
+            T* allocate(std::size_t count);
+            void deallocate(T*, std::size_t) noexcept {}
+            TArena& arena() const noexcept { return *arena_; }
+
+            template <class U>
+            bool operator==(const ArenaAlloc<U, TArena>& rhs) const noexcept { return arena_ == rhs.arena_; }
+            template <class U>
+            bool operator!=(const ArenaAlloc<U, TArena>& rhs) const noexcept { return arena_ != rhs.arena_; }
+        private:
+            TArena* arena_;
+        };
+
+        template <class TArena>
+        void* ArenaResource<TArena>::do_allocate(std::size_t bytes, std::size_t alignment) {
+            return arena_->AllocBytes(bytes, alignment);
+        }
+
+        template <class TArena>
+        bool ArenaResource<TArena>::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+            const ArenaResource* resource = dynamic_cast<const ArenaResource*>(&other);
+            return resource && resource->arena_ == arena_;
+        }
+
+        template <class T, class TArena>
+        T* ArenaAlloc<T, TArena>::allocate(std::size_t count) {
+            if (count > static_cast<std::size_t>(-1) / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+            return static_cast<T*>(arena_->AllocBytes(count * sizeof(T), alignof(T)));
+        }
+    }
+
+}
+
+#endif  // !ARENA_ALLOCATOR_HPP_
@@ -0,0 +1,426 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+#include "linear_allocator.hpp"
+#include "arena.hpp"
+#include "arena_allocator.hpp"
+#include "object_pool.hpp"
+#include "../08/vector.hpp"
+
+namespace made {
+
+    namespace stl {
+
+        namespace linear_allocator_bench {
+
+            typedef void(*BenchFunc)();
+
+            struct Benchmark {
+                const char* name;
+                BenchFunc function;
+            };
+
+            // Allocation sizes of valid_reset::t2 in test.cpp, one group per simulated request
+            const size_type kGroupSizes[] = { 3, 3, 3, 1 };
+            const size_type kGroupLength = sizeof(kGroupSizes) / sizeof(kGroupSizes[0]);
+            const size_type kGroups = 2500000;
+            const size_type kAllocations = kGroups * kGroupLength;
+
+            template <class T>
+            void Consume(const T& value) {
+                static volatile T sink;
+                sink = value;
+            }
+
+            // Best wall time of `repeats` runs, in seconds
+            double MeasureBest(const std::function<void()>& func, int repeats = 3) {
+                double best = 0;
+                for (int i = 0; i < repeats; ++i) {
+                    auto start = std::chrono::steady_clock::now();
+                    func();
+                    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                    if (i == 0 || elapsed.count() < best) {
+                        best = elapsed.count();
+                    }
+                }
+                return best;
+            }
+
+            void Report(const std::string& label, double seconds, size_type allocations, const char* unit = "Malloc/s") {
+                std::cout << "  " << std::left << std::setw(48) << label << std::right
+                    << std::fixed << std::setprecision(3) << std::setw(10) << seconds * 1e3 << " ms"
+                    << std::setw(10) << std::setprecision(1) << allocations / seconds / 1e6 << " " << unit << std::endl;
+            }
+
+            namespace churn {
+
+                void malloc_free() {
+                    int* p[kGroupLength];
+                    for (size_type g = 0; g < kGroups; ++g) {
+                        for (size_type i = 0; i < kGroupLength; ++i) {
+                            p[i] = static_cast<int*>(std::malloc(kGroupSizes[i] * sizeof(int)));
+                            p[i][0] = static_cast<int>(g);
+                        }
+                        Consume(p[kGroupLength - 1][0]);
+                        for (size_type i = 0; i < kGroupLength; ++i) {
+                            std::free(p[i]);
+                        }
+                    }
+                }
+
+                void new_delete() {
+                    int* p[kGroupLength];
+                    for (size_type g = 0; g < kGroups; ++g) {
+                        for (size_type i = 0; i < kGroupLength; ++i) {
+                            p[i] = new int[kGroupSizes[i]];
+                            p[i][0] = static_cast<int>(g);
+                        }
+                        Consume(p[kGroupLength - 1][0]);
+                        for (size_type i = 0; i < kGroupLength; ++i) {
+                            delete[] p[i];
+                        }
+                    }
+                }
+
+                void linear_allocator() {
+                    LinearAllocator<int> allocator(10);
+                    for (size_type g = 0; g < kGroups; ++g) {
+                        int* p = nullptr;
+                        for (size_type i = 0; i < kGroupLength; ++i) {
+                            p = allocator.Alloc(kGroupSizes[i]);
+                            p[0] = static_cast<int>(g);
+                        }
+                        Consume(p[0]);
+                        allocator.Reset();
+                    }
+                }
+
+                void arena_scope(Arena& arena) {
+                    for (size_type g = 0; g < kGroups; ++g) {
+                        Arena::Scope scope(arena);
+                        int* p = nullptr;
+                        for (size_type i = 0; i < kGroupLength; ++i) {
+                            p = arena.Alloc<int>(kGroupSizes[i]);
+                            p[0] = static_cast<int>(g);
+                        }
+                        Consume(p[0]);
+                    }
+                }
+
+                void arena_scope() {
+                    Arena arena;
+                    arena_scope(arena);
+                }
+
+                // Two arenas used in turns, e.g. one per request and one for the session
+                void arenas_interleaved() {
+                    Arena first;
+                    Arena second;
+                    for (size_type g = 0; g < kGroups; ++g) {
+                        Arena::Scope first_scope(first);
+                        Arena::Scope second_scope(second);
+                        int* p = nullptr;
+                        for (size_type i = 0; i < kGroupLength; ++i) {
+                            Arena& arena = i % 2 ? second : first;
+                            p = arena.Alloc<int>(kGroupSizes[i]);
+                            p[0] = static_cast<int>(g);
+                        }
+                        Consume(p[0]);
+                    }
+                }
+
+                void arena_reset() {
+                    Arena arena;
+                    for (size_type g = 0; g < kGroups; ++g) {
+                        int* p = nullptr;
+                        for (size_type i = 0; i < kGroupLength; ++i) {
+                            p = arena.Alloc<int>(kGroupSizes[i]);
+                            p[0] = static_cast<int>(g);
+                        }
+                        Consume(p[0]);
+                        if (g % 1024 == 1023) {
+                            arena.Reset();
+                        }
+                    }
+                }
+
+                void run() {
+                    Report("malloc/free", MeasureBest(malloc_free), kAllocations);
+                    Report("new[]/delete[]", MeasureBest(new_delete), kAllocations);
+                    Report("LinearAllocator<int>(10), Reset per group", MeasureBest(linear_allocator), kAllocations);
+                    Report("Arena, Scope per group", MeasureBest([]() { arena_scope(); }), kAllocations);
+                    Report("two Arenas in turns, Scope per group", MeasureBest(arenas_interleaved), kAllocations);
+                    Report("Arena, Reset every 1024 groups", MeasureBest(arena_reset), kAllocations);
+                }
+            }
+
+            namespace retained {
+
+                // All allocations stay alive until the end, then are released at once
+                void malloc_free() {
+                    std::vector<int*> live;
+                    live.reserve(kAllocations);
+                    for (size_type g = 0; g < kGroups; ++g) {
+                        for (size_type i = 0; i < kGroupLength; ++i) {
+                            live.push_back(static_cast<int*>(std::malloc(kGroupSizes[i] * sizeof(int))));
+                            live.back()[0] = static_cast<int>(g);
+                        }
+                    }
+                    Consume(live.back()[0]);
+                    for (int* p : live) {
+                        std::free(p);
+                    }
+                }
+
+                void new_delete() {
+                    std::vector<int*> live;
+                    live.reserve(kAllocations);
+                    for (size_type g = 0; g < kGroups; ++g) {
+                        for (size_type i = 0; i < kGroupLength; ++i) {
+                            live.push_back(new int[kGroupSizes[i]]);
+                            live.back()[0] = static_cast<int>(g);
+                        }
+                    }
+                    Consume(live.back()[0]);
+                    for (int* p : live) {
+                        delete[] p;
+                    }
+                }
+
+                void arena() {
+                    Arena arena;
+                    std::vector<int*> live;
+                    live.reserve(kAllocations);
+                    for (size_type g = 0; g < kGroups; ++g) {
+                        for (size_type i = 0; i < kGroupLength; ++i) {
+                            live.push_back(arena.Alloc<int>(kGroupSizes[i]));
+                            live.back()[0] = static_cast<int>(g);
+                        }
+                    }
+                    Consume(live.back()[0]);
+                    arena.Reset();
+                }
+
+                void run() {
+                    Report("malloc, free all at the end", MeasureBest(malloc_free), kAllocations);
+                    Report("new[], delete[] all at the end", MeasureBest(new_delete), kAllocations);
+                    Report("Arena, Reset at the end", MeasureBest(arena), kAllocations);
+                }
+            }
+
+            namespace threaded {
+
+                void run_threads(size_type threads_count, const std::function<void()>& body) {
+                    std::vector<std::thread> threads;
+                    for (size_type t = 0; t < threads_count; ++t) {
+                        threads.emplace_back(body);
+                    }
+                    for (auto& thread : threads) {
+                        thread.join();
+                    }
+                }
+
+                void run() {
+                    const size_type max_threads = std::max(4u, std::thread::hardware_concurrency());
+                    for (size_type threads_count = 1; threads_count <= max_threads; threads_count *= 2) {
+                        const std::string prefix = std::to_string(threads_count) + " threads, ";
+                        double seconds = MeasureBest([threads_count]() { run_threads(threads_count, churn::malloc_free); });
+                        Report(prefix + "malloc/free", seconds, kAllocations * threads_count);
+                        seconds = MeasureBest([threads_count]() {
+                            Arena arena;
+                            run_threads(threads_count, [&arena]() { churn::arena_scope(arena); });
+                        });
+                        Report(prefix + "shared Arena, Scope per group", seconds, kAllocations * threads_count);
+                    }
+                }
+            }
+
+            namespace short_lived_vectors {
+
+                // Every simulated request builds a handful of small vectors, reads them and drops them
+                const size_type kRequests = 200000;
+                const size_type kVectorsPerRequest = 8;
+                const int kLengths[kVectorsPerRequest] = { 4, 16, 7, 64, 2, 33, 128, 9 };
+                const size_type kVectors = kRequests * kVectorsPerRequest;
+
+                template <class TVector, class MakeVector>
+                void build_request(MakeVector make_vector) {
+                    long long sum = 0;
+                    for (size_type v = 0; v < kVectorsPerRequest; ++v) {
+                        TVector vector = make_vector();
+                        for (int i = 0; i < kLengths[v]; ++i) {
+                            vector.push_back(i);
+                        }
+                        sum += vector[vector.size() / 2];
+                    }
+                    Consume(sum);
+                }
+
+                void std_vector() {
+                    for (size_type r = 0; r < kRequests; ++r) {
+                        build_request<std::vector<int>>([]() { return std::vector<int>(); });
+                    }
+                }
+
+                void made_vector() {
+                    for (size_type r = 0; r < kRequests; ++r) {
+                        build_request<Vector<int>>([]() { return Vector<int>(); });
+                    }
+                }
+
+                void made_vector_arena() {
+                    Arena arena;
+                    for (size_type r = 0; r < kRequests; ++r) {
+                        Arena::Scope scope(arena);
+                        build_request<Vector<int, ArenaAlloc<int>>>([&arena]() { return Vector<int, ArenaAlloc<int>>(ArenaAlloc<int>(arena)); });
+                    }
+                }
+
+                void pmr_vector_arena() {
+                    Arena arena;
+                    ArenaResource<> resource(arena);
+                    for (size_type r = 0; r < kRequests; ++r) {
+                        Arena::Scope scope(arena);
+                        build_request<std::pmr::vector<int>>([&resource]() { return std::pmr::vector<int>(&resource); });
+                    }
+                }
+
+                void pmr_vector_monotonic() {
+                    char buffer[16 * 1024];
+                    for (size_type r = 0; r < kRequests; ++r) {
+                        std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer));
+                        build_request<std::pmr::vector<int>>([&resource]() { return std::pmr::vector<int>(&resource); });
+                    }
+                }
+
+                void run() {
+                    Report("std::vector<int>", MeasureBest(std_vector), kVectors, "Mvector/s");
+                    Report("made::stl::Vector<int>", MeasureBest(made_vector), kVectors, "Mvector/s");
+                    Report("made::stl::Vector<int, ArenaAlloc<int>>", MeasureBest(made_vector_arena), kVectors, "Mvector/s");
+                    Report("std::pmr::vector<int>, ArenaResource", MeasureBest(pmr_vector_arena), kVectors, "Mvector/s");
+                    Report("std::pmr::vector<int>, monotonic_buffer_resource", MeasureBest(pmr_vector_monotonic), kVectors, "Mvector/s");
+                }
+            }
+
+            namespace pool_churn {
+
+                // Task-like node: every operation picks a random slot of a per-thread window,
+                // frees the object living there or allocates a new one into it
+                struct Task {
+                    Task* next;
+                    std::uint64_t id;
+                    int payload[4];
+                    explicit Task(std::uint64_t task_id) : next(nullptr), id(task_id) {}
+                };
+
+                const size_type kWindow = 4096;
+                const size_type kOperations = 5000000;
+
+                template <class NewTask, class DeleteTask>
+                void churn(NewTask new_task, DeleteTask delete_task) {
+                    std::vector<Task*> window(kWindow, nullptr);
+                    std::uint64_t state = 88172645463325252ull;
+                    for (size_type i = 0; i < kOperations; ++i) {
+                        state ^= state << 13;
+                        state ^= state >> 7;
+                        state ^= state << 17;
+                        Task*& slot = window[state % kWindow];
+                        if (slot) {
+                            Consume(slot->id);
+                            delete_task(slot);
+                            slot = nullptr;
+                        }
+                        else {
+                            slot = new_task(i);
+                        }
+                    }
+                    for (Task* task : window) {
+                        if (task) {
+                            delete_task(task);
+                        }
+                    }
+                }
+
+                void new_delete() {
+                    churn([](size_type i) { return new Task(i); }, [](Task* task) { delete task; });
+                }
+
+                void object_pool(ObjectPool<Task>& pool) {
+                    churn([&pool](size_type i) { return pool.New(i); }, [&pool](Task* task) { pool.Delete(task); });
+                }
+
+                // Every other task from a second pool
+                void object_pools_interleaved() {
+                    ObjectPool<Task> first;
+                    ObjectPool<Task> second;
+                    churn([&](size_type i) { return (i % 2 ? second : first).New(i); },
+                        [&](Task* task) { (task->id % 2 ? second : first).Delete(task); });
+                }
+
+                void run_threads(size_type threads_count, const std::function<void()>& body) {
+                    std::vector<std::thread> threads;
+                    for (size_type t = 0; t < threads_count; ++t) {
+                        threads.emplace_back(body);
+                    }
+                    for (auto& thread : threads) {
+                        thread.join();
+                    }
+                }
+
+                void run() {
+                    Report("two ObjectPools in turns, New/Delete", MeasureBest(object_pools_interleaved), kOperations, "Mop/s");
+                    const size_type max_threads = std::max(4u, std::thread::hardware_concurrency());
+                    for (size_type threads_count = 1; threads_count <= max_threads; threads_count *= 2) {
+                        const std::string prefix = std::to_string(threads_count) + " threads, ";
+                        double seconds = MeasureBest([threads_count]() { run_threads(threads_count, new_delete); });
+                        Report(prefix + "new/delete", seconds, kOperations * threads_count, "Mop/s");
+                        seconds = MeasureBest([threads_count]() {
+                            ObjectPool<Task> pool;
+                            run_threads(threads_count, [&pool]() { object_pool(pool); });
+                        });
+                        Report(prefix + "shared ObjectPool New/Delete", seconds, kOperations * threads_count, "Mop/s");
+                    }
+                }
+            }
+
+            std::vector<Benchmark> GetBenchmarks() {
+                return {
+                    { "small allocation churn", churn::run },
+                    { "small allocations retained", retained::run },
+                    { "multi-threaded churn", threaded::run },
+                    { "short-lived vectors per request", short_lived_vectors::run },
+                    { "object pool churn", pool_churn::run },
+                };
+            }
+
+            int RunBenchmarks(const std::string& filter) {
+                std::vector<Benchmark> benchmarks = GetBenchmarks();
+                std::size_t benchmarks_count = benchmarks.size();
+                for (std::size_t i = 0; i < benchmarks_count; ++i) {
+                    if (std::string(benchmarks[i].name).find(filter) == std::string::npos) {
+                        continue;
+                    }
+                    std::cout << "Running benchmark " << i + 1 << "/" << benchmarks_count << "... "
+                        << benchmarks[i].name << std::endl;
+                    benchmarks[i].function();
+                }
+                return 0;
+            }
+
+        }
+
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    made::stl::linear_allocator_bench::RunBenchmarks(argc > 1 ? argv[1] : "");
+}
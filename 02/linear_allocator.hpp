@@ -1,7 +1,10 @@
 #pragma once
 #ifndef LINEAR_ALLOCATOR_HPP_
 #define LINEAR_ALLOCATOR_HPP_
+#include <cstdint>
+#include <cstdlib>
 #include <exception>
+#include <new>
 #include <string>
 
 namespace made {
@@ -23,6 +26,7 @@ namespace made {
             LinearAllocator(size_type max_size);
             ~LinearAllocator();
             T* Alloc(size_type size);
+            void* AllocBytes(size_type bytes, size_type alignment);
             void Reset();
         private:
             void* buffer_ = nullptr;
@@ -59,6 +63,17 @@ namespace made {
             return result;
         }
 
+        // Untyped allocation for the adapters in arena_allocator.hpp,
+        // takes whole elements of T covering the aligned block
+        template <class T>
+        void* LinearAllocator<T>::AllocBytes(size_type bytes, size_type alignment) {
+            std::uintptr_t tail = reinterpret_cast<std::uintptr_t>(tail_);
+            std::uintptr_t aligned = (tail + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+            size_type used = static_cast<size_type>(aligned - tail) + bytes;
+            Alloc((used + sizeof(T) - 1) / sizeof(T));
+            return reinterpret_cast<void*>(aligned);
+        }
+
         template <class T>
         void LinearAllocator<T>::Reset() {
             tail_ = static_cast<T*>(buffer_);
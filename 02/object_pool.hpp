@@ -0,0 +1,260 @@
+#pragma once
+#ifndef OBJECT_POOL_HPP_
+#define OBJECT_POOL_HPP_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace made {
+
+    namespace stl {
+
+        typedef size_t size_type;
+
+        // Slab allocator of fixed size blocks with O(1) (amortized) Alloc()/Free().
+        // Free blocks are kept in intrusive lists: every thread pops and pushes its own
+        // cache without locking, and exchanges whole batches with the shared pool under
+        // the mutex when its cache runs empty or grows past two batches.
+        // Blocks may be freed by any thread; blocks cached by a finished thread stay with
+        // its cache until the pool is destroyed.
+        class FixedBlockPool
+        {
+            struct FreeNode;
+            struct ThreadCache;
+        public:
+            FixedBlockPool(size_type block_size, size_type alignment = alignof(std::max_align_t), size_type batch_size = 64);
+            ~FixedBlockPool();
+            FixedBlockPool(const FixedBlockPool&) = delete;
+            FixedBlockPool& operator=(const FixedBlockPool&) = delete;
+
+            void* Alloc();
+            void Free(void* block);
+            size_type BlockSize() const { return block_size_; }
+            size_type ReservedBlocks();
+        private:
+            // next links blocks of a batch, next_batch links batches in the shared pool
+            struct FreeNode {
+                FreeNode* next;
+                FreeNode* next_batch;
+            };
+
+            struct ThreadCache {
+                std::thread::id owner;
+                FreeNode* head = nullptr;
+                size_type count = 0;
+            };
+
+            // Caches of the last pools a thread looked up, newest first
+            struct LocalCache {
+                static constexpr size_type kEntries = 8;
+                struct Entry {
+                    std::uint64_t pool_id;
+                    ThreadCache* cache;
+                };
+                Entry entries[kEntries];
+            };
+
+            static std::uint64_t NextId();
+            static LocalCache& Cache();
+            ThreadCache& Local();
+            ThreadCache& LocalSlow();
+            void Refill(ThreadCache& local);
+            void Flush(ThreadCache& local);
+            FreeNode* CarveBatch();
+
+            const size_type alignment_;
+            const size_type block_size_;
+            const size_type batch_size_;
+            const std::uint64_t id_;
+            std::mutex mutex_;
+            FreeNode* batches_ = nullptr;
+            std::vector<void*> slabs_;
+            char* slab_cursor_ = nullptr;
+            char* slab_end_ = nullptr;
+            size_type reserved_blocks_ = 0;
+            std::vector<std::unique_ptr<ThreadCache>> caches_;
+        };
+
+        // Typed front end of FixedBlockPool constructing and destroying T in pooled blocks
+        template <class T>
+        class ObjectPool
+        {
+        public:
+            explicit ObjectPool(size_type batch_size = 64) : pool_(sizeof(T), alignof(T), batch_size) {}
+
+            template <class... Args>
+            T* New(Args&&... args);
+            void Delete(T* object);
+        private:
+            FixedBlockPool pool_;
+        };
+
+        inline FixedBlockPool::FixedBlockPool(size_type block_size, size_type alignment, size_type batch_size)
+            : alignment_(alignment < alignof(FreeNode) ? alignof(FreeNode) : alignment),
+            block_size_(((block_size < sizeof(FreeNode) ? sizeof(FreeNode) : block_size) + alignment_ - 1) & ~(alignment_ - 1)),
+            batch_size_(batch_size ? batch_size : 1),
+            id_(NextId()) {}
+
+        inline FixedBlockPool::~FixedBlockPool() {
+            for (void* slab : slabs_) {
+                std::free(slab);
+            }
+        }
+
+        inline void* FixedBlockPool::Alloc() {
+            ThreadCache& local = Local();
+            if (!local.head) {
+                Refill(local);
+            }
+            FreeNode* node = local.head;
+            local.head = node->next;
+            --local.count;
+            return node;
+        }
+
+        inline void FixedBlockPool::Free(void* block) {
+            if (!block) {
+                return;
+            }
+            ThreadCache& local = Local();
+            FreeNode* node = static_cast<FreeNode*>(block);
+            node->next = local.head;
+            local.head = node;
+            if (++local.count >= 2 * batch_size_) {
+                Flush(local);
+            }
+        }
+
+        inline size_type FixedBlockPool::ReservedBlocks() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return reserved_blocks_;
+        }
+
+        inline std::uint64_t FixedBlockPool::NextId() {
+            static std::atomic<std::uint64_t> next_id(1);
+            return next_id++;
+        }
+
+        // Like Arena, a thread finds the caches of the pools it uses in turns without
+        // the mutex
+        inline FixedBlockPool::LocalCache& FixedBlockPool::Cache() {
+            static thread_local LocalCache cache = {};
+            return cache;
+        }
+
+        inline FixedBlockPool::ThreadCache& FixedBlockPool::Local() {
+            LocalCache& cache = Cache();
+            for (size_type i = 0; i < LocalCache::kEntries; ++i) {
+                if (cache.entries[i].pool_id == id_) {
+                    return *cache.entries[i].cache;
+                }
+            }
+            return LocalSlow();
+        }
+
+        inline FixedBlockPool::ThreadCache& FixedBlockPool::LocalSlow() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            const std::thread::id self = std::this_thread::get_id();
+            ThreadCache* found = nullptr;
+            for (auto& local : caches_) {
+                if (local->owner == self) {
+                    found = local.get();
+                    break;
+                }
+            }
+            if (!found) {
+                caches_.push_back(std::unique_ptr<ThreadCache>(new ThreadCache{ self }));
+                found = caches_.back().get();
+            }
+            LocalCache& cache = Cache();
+            for (size_type i = LocalCache::kEntries - 1; i > 0; --i) {
+                cache.entries[i] = cache.entries[i - 1];
+            }
+            cache.entries[0] = { id_, found };
+            return *found;
+        }
+
+        // Takes one batch from the shared pool, carving a new one from a slab if there is none
+        inline void FixedBlockPool::Refill(ThreadCache& local) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            FreeNode* batch = batches_;
+            if (batch) {
+                batches_ = batch->next_batch;
+            }
+            else {
+                batch = CarveBatch();
+            }
+            local.head = batch;
+            local.count = batch_size_;
+        }
+
+        // Gives one batch back to the shared pool, keeping the other half of the cache
+        inline void FixedBlockPool::Flush(ThreadCache& local) {
+            FreeNode* batch = local.head;
+            FreeNode* last = batch;
+            for (size_type i = 1; i < batch_size_; ++i) {
+                last = last->next;
+            }
+            local.head = last->next;
+            local.count -= batch_size_;
+            last->next = nullptr;
+            std::lock_guard<std::mutex> lock(mutex_);
+            batch->next_batch = batches_;
+            batches_ = batch;
+        }
+
+        inline FixedBlockPool::FreeNode* FixedBlockPool::CarveBatch() {
+            const size_type batch_bytes = block_size_ * batch_size_;
+            if (static_cast<size_type>(slab_end_ - slab_cursor_) < batch_bytes) {
+                const size_type slab_bytes = batch_bytes * 16 + alignment_;
+                void* slab = std::malloc(slab_bytes);
+                if (!slab) {
+                    throw std::bad_alloc();
+                }
+                slabs_.push_back(slab);
+                std::uintptr_t address = reinterpret_cast<std::uintptr_t>(slab);
+                slab_cursor_ = reinterpret_cast<char*>((address + alignment_ - 1) & ~static_cast<std::uintptr_t>(alignment_ - 1));
+                slab_end_ = static_cast<char*>(slab) + slab_bytes;
+            }
+            FreeNode* head = reinterpret_cast<FreeNode*>(slab_cursor_);
+            for (size_type i = 0; i < batch_size_; ++i) {
+                FreeNode* node = reinterpret_cast<FreeNode*>(slab_cursor_ + i * block_size_);
+                node->next = i + 1 < batch_size_ ? reinterpret_cast<FreeNode*>(slab_cursor_ + (i + 1) * block_size_) : nullptr;
+            }
+            slab_cursor_ += batch_bytes;
+            reserved_blocks_ += batch_size_;
+            return head;
+        }
+
+        template <class T>
+        template <class... Args>
+        T* ObjectPool<T>::New(Args&&... args) {
+            void* block = pool_.Alloc();
+            try {
+                return new (block) T(std::forward<Args>(args)...);
+            }
+            catch (...) {
+                pool_.Free(block);
+                throw;
+            }
+        }
+
+        template <class T>
+        void ObjectPool<T>::Delete(T* object) {
+            if (object) {
+                object->~T();
+                pool_.Free(object);
+            }
+        }
+    }
+
+}
+
+#endif  // !OBJECT_POOL_HPP_
@@ -1,6 +1,14 @@
 #include <vector>
 #include <iostream>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
 #include "linear_allocator.hpp"
+#include "arena.hpp"
+#include "arena_allocator.hpp"
+#include "object_pool.hpp"
+#include "../08/vector.hpp"
 
 namespace made {
 
@@ -128,6 +136,405 @@ namespace made {
                 }
             }
 
+            namespace valid_arena {
+
+                void t1() {
+                    Arena arena(64);
+                    // Allocations chain new blocks instead of running out of memory
+                    std::vector<int*> blocks;
+                    for (int i = 0; i < 100; i++) {
+                        int* p = arena.Alloc<int>(10);
+                        for (int j = 0; j < 10; j++) {
+                            p[j] = i * 10 + j;
+                        }
+                        blocks.push_back(p);
+                    }
+                    for (int i = 0; i < 100; i++) {
+                        for (int j = 0; j < 10; j++) {
+                            if (blocks[i][j] != i * 10 + j) {
+                                throw std::logic_error("arena blocks overlap");
+                            }
+                        }
+                    }
+                }
+
+                void t2() {
+                    struct alignas(64) CacheLine {
+                        char data[64];
+                    };
+                    Arena arena(256);
+                    for (int i = 0; i < 10; i++) {
+                        arena.Alloc<char>(1);
+                        CacheLine* line = arena.New<CacheLine>();
+                        double* d = arena.Alloc<double>(1);
+                        if (reinterpret_cast<std::uintptr_t>(line) % 64 != 0 || reinterpret_cast<std::uintptr_t>(d) % alignof(double) != 0) {
+                            throw std::logic_error("arena allocation is misaligned");
+                        }
+                    }
+                }
+
+                void t3() {
+                    Arena arena(64);
+                    // Nested scopes rewind to their marks, even across chained blocks
+                    int* p1 = arena.Alloc<int>(3);
+                    Arena::Marker outer = arena.Mark();
+                    int* p2 = arena.Alloc<int>(3);
+                    {
+                        Arena::Scope scope(arena);
+                        arena.Alloc<int>(100);
+                        {
+                            Arena::Scope inner(arena);
+                            arena.Alloc<int>(100);
+                        }
+                    }
+                    int* p3 = arena.Alloc<int>(3);
+                    if (p3 != p2 + 3) {
+                        throw std::logic_error("scope did not rewind the arena");
+                    }
+                    arena.Rewind(outer);
+                    if (arena.Alloc<int>(3) != p2 || p1 + 3 != p2) {
+                        throw std::logic_error("rewind did not restore the mark");
+                    }
+                }
+
+                void t4() {
+                    Arena arena(64);
+                    // Assume reseting reuses the chained blocks instead of allocating new ones
+                    int* p1 = arena.Alloc<int>(10);
+                    for (int i = 0; i < 100; i++) {
+                        arena.Alloc<int>(10);
+                    }
+                    size_type reserved = arena.ReservedBytes();
+                    arena.Reset();
+                    for (int i = 0; i < 100; i++) {
+                        arena.Alloc<int>(10);
+                    }
+                    if (arena.ReservedBytes() != reserved) {
+                        throw std::logic_error("arena allocated new blocks after reset");
+                    }
+                    arena.Reset();
+                    if (arena.Alloc<int>(10) == nullptr || p1 == nullptr) {
+                        throw std::logic_error("arena returned null");
+                    }
+                }
+
+                void t5() {
+                    Arena arena(1024);
+                    // Threads bump their own chunks, so their allocations never overlap
+                    const int threads_count = 4;
+                    const int allocs = 10000;
+                    std::vector<std::vector<int*>> results(threads_count);
+                    std::vector<std::thread> threads;
+                    // An exception escaping a thread terminates the run, so it is reported after join()
+                    std::atomic<bool> failed(false);
+                    for (int t = 0; t < threads_count; t++) {
+                        threads.emplace_back([&arena, &results, &failed, t]() {
+                            try {
+                                for (int i = 0; i < allocs; i++) {
+                                    int* p = arena.Alloc<int>(3);
+                                    p[0] = p[1] = p[2] = t;
+                                    results[t].push_back(p);
+                                }
+                            }
+                            catch (...) {
+                                failed = true;
+                            }
+                        });
+                    }
+                    for (auto& thread : threads) {
+                        thread.join();
+                    }
+                    if (failed) {
+                        throw std::logic_error("arena allocation failed in a thread");
+                    }
+                    for (int t = 0; t < threads_count; t++) {
+                        for (int* p : results[t]) {
+                            if (p[0] != t || p[1] != t || p[2] != t) {
+                                throw std::logic_error("allocations of different threads overlap");
+                            }
+                        }
+                    }
+                }
+
+                void t6() {
+                    // More arenas in turns than a thread caches: every lookup still finds its own cursor
+                    const int arenas_count = 11;
+                    std::vector<std::unique_ptr<Arena>> arenas;
+                    std::vector<std::vector<int*>> results(arenas_count);
+                    for (int a = 0; a < arenas_count; a++) {
+                        arenas.emplace_back(new Arena(256));
+                    }
+                    for (int i = 0; i < 1000; i++) {
+                        const int a = (i * 7) % arenas_count;
+                        int* p = arenas[a]->Alloc<int>(2);
+                        p[0] = p[1] = a;
+                        results[a].push_back(p);
+                    }
+                    for (int a = 0; a < arenas_count; a++) {
+                        for (int* p : results[a]) {
+                            if (p[0] != a || p[1] != a) {
+                                throw std::logic_error("arenas used in turns overlap");
+                            }
+                        }
+                        Arena::Marker marker = arenas[a]->Mark();
+                        if (marker.cursor != reinterpret_cast<char*>(results[a].back() + 2)) {
+                            throw std::logic_error("arena lost its cursor to another arena");
+                        }
+                    }
+                }
+            }
+
+            namespace valid_arena_limits {
+
+                void t1() {
+                    Arena arena(256);
+                    // Sizes that wrap around with the header and padding fail instead of
+                    // handing out a small block
+                    void* before = arena.AllocBytes(16);
+                    bool failed = false;
+                    try {
+                        arena.AllocBytes(static_cast<size_type>(-1) - 8, 16);
+                    }
+                    catch (std::bad_alloc&) {
+                        failed = true;
+                    }
+                    if (!failed) {
+                        throw std::logic_error("arena allocated more bytes than fit in size_type");
+                    }
+                    failed = false;
+                    try {
+                        arena.Alloc<int>(static_cast<size_type>(-1) / 2);
+                    }
+                    catch (std::bad_array_new_length&) {
+                        failed = true;
+                    }
+                    if (!failed) {
+                        throw std::logic_error("arena allocated an array whose size overflows");
+                    }
+                    char* first = static_cast<char*>(arena.AllocBytes(16));
+                    char* second = static_cast<char*>(arena.AllocBytes(16));
+                    if (first == before || second < first + 16) {
+                        throw std::logic_error("arena handed out the same bytes twice");
+                    }
+                }
+
+                void t2() {
+                    Arena arena;
+                    for (size_type alignment : { size_type(0), size_type(3), size_type(24) }) {
+                        bool failed = false;
+                        try {
+                            arena.AllocBytes(8, alignment);
+                        }
+                        catch (std::invalid_argument&) {
+                            failed = true;
+                        }
+                        if (!failed) {
+                            throw std::logic_error("arena took an alignment that is not a power of two");
+                        }
+                    }
+                }
+            }
+
+            namespace valid_arena_allocator {
+
+                void t1() {
+                    Arena arena;
+                    // made::stl::Vector grows inside the arena
+                    Vector<int, ArenaAlloc<int>> v{ ArenaAlloc<int>(arena) };
+                    for (int i = 0; i < 1000; i++) {
+                        v.push_back(i);
+                    }
+                    for (int i = 0; i < 1000; i++) {
+                        if (v[i] != i) {
+                            throw std::logic_error("vector in arena lost its values");
+                        }
+                    }
+                    if (arena.ReservedBytes() == 0 || v.get_allocator() != ArenaAlloc<long>(arena)) {
+                        throw std::logic_error("vector did not allocate from arena");
+                    }
+                }
+
+                void t2() {
+                    Arena arena;
+                    ArenaResource<> resource(arena);
+                    // std::pmr containers, including nested ones, draw from the same arena
+                    std::pmr::vector<std::pmr::vector<int>> v(&resource);
+                    for (int i = 0; i < 100; i++) {
+                        v.emplace_back(static_cast<size_t>(i), i);
+                    }
+                    for (int i = 0; i < 100; i++) {
+                        if (v[i].size() != static_cast<size_t>(i) || (i > 0 && v[i].back() != i) || v[i].get_allocator().resource() != &resource) {
+                            throw std::logic_error("pmr vector in arena lost its values");
+                        }
+                    }
+                }
+
+                void t3() {
+                    LinearAllocator<int> allocator(10);
+                    // Fixed size LinearAllocator still runs out of memory behind the adapter
+                    Vector<int, ArenaAlloc<int, LinearAllocator<int>>> v{ ArenaAlloc<int, LinearAllocator<int>>(allocator) };
+                    for (int i = 0; i < 10; i++) {
+                        v.push_back(i);
+                    }
+                }
+            }
+
+            namespace valid_object_pool {
+
+                void t1() {
+                    FixedBlockPool pool(sizeof(int) * 3, alignof(int), 4);
+                    // Freed block is handed out again by the next allocation
+                    void* p1 = pool.Alloc();
+                    void* p2 = pool.Alloc();
+                    pool.Free(p1);
+                    void* p3 = pool.Alloc();
+                    if (p3 != p1 || p2 == p1) {
+                        throw std::logic_error("freed block was not reused");
+                    }
+                }
+
+                void t2() {
+                    FixedBlockPool pool(48, 32, 8);
+                    // Blocks across many batches are distinct and aligned
+                    std::vector<int*> blocks;
+                    for (int i = 0; i < 1000; i++) {
+                        int* p = static_cast<int*>(pool.Alloc());
+                        if (reinterpret_cast<std::uintptr_t>(p) % 32 != 0) {
+                            throw std::logic_error("pool block is misaligned");
+                        }
+                        for (int j = 0; j < 12; j++) {
+                            p[j] = i;
+                        }
+                        blocks.push_back(p);
+                    }
+                    for (int i = 0; i < 1000; i++) {
+                        for (int j = 0; j < 12; j++) {
+                            if (blocks[i][j] != i) {
+                                throw std::logic_error("pool blocks overlap");
+                            }
+                        }
+                    }
+                    // Batches flushed to the shared pool are reused instead of carving new slabs
+                    size_type reserved = pool.ReservedBlocks();
+                    for (int* p : blocks) {
+                        pool.Free(p);
+                    }
+                    for (int i = 0; i < 1000; i++) {
+                        pool.Alloc();
+                    }
+                    if (pool.ReservedBlocks() != reserved) {
+                        throw std::logic_error("pool did not reuse freed batches");
+                    }
+                }
+
+                void t3() {
+                    struct Counted {
+                        int& alive;
+                        explicit Counted(int& counter) : alive(counter) { ++alive; }
+                        ~Counted() { --alive; }
+                    };
+                    int alive = 0;
+                    ObjectPool<Counted> pool;
+                    std::vector<Counted*> objects;
+                    for (int i = 0; i < 100; i++) {
+                        objects.push_back(pool.New(alive));
+                    }
+                    for (Counted* object : objects) {
+                        pool.Delete(object);
+                    }
+                    if (alive != 0) {
+                        throw std::logic_error("object pool did not run destructors");
+                    }
+                }
+
+                void t4() {
+                    FixedBlockPool pool(sizeof(int) * 4);
+                    // Blocks allocated on one thread are freed on another
+                    const int threads_count = 4;
+                    const int allocs = 10000;
+                    std::vector<std::vector<int*>> results(threads_count);
+                    std::vector<std::thread> threads;
+                    // Failures are reported after join(): an exception escaping a thread terminates the run
+                    std::atomic<bool> failed(false);
+                    std::atomic<bool> overlap(false);
+                    for (int t = 0; t < threads_count; t++) {
+                        threads.emplace_back([&pool, &results, &failed, t]() {
+                            try {
+                                for (int i = 0; i < allocs; i++) {
+                                    int* p = static_cast<int*>(pool.Alloc());
+                                    p[0] = p[3] = t;
+                                    results[t].push_back(p);
+                                }
+                            }
+                            catch (...) {
+                                failed = true;
+                            }
+                        });
+                    }
+                    for (auto& thread : threads) {
+                        thread.join();
+                    }
+                    if (failed) {
+                        throw std::logic_error("pool allocation failed in a thread");
+                    }
+                    threads.clear();
+                    for (int t = 0; t < threads_count; t++) {
+                        threads.emplace_back([&pool, &results, &overlap, t]() {
+                            for (int* p : results[(t + 1) % threads_count]) {
+                                if (p[0] != (t + 1) % threads_count || p[3] != p[0]) {
+                                    overlap = true;
+                                }
+                                pool.Free(p);
+                            }
+                        });
+                    }
+                    for (auto& thread : threads) {
+                        thread.join();
+                    }
+                    if (overlap) {
+                        throw std::logic_error("pool blocks of different threads overlap");
+                    }
+                }
+
+                void t5() {
+                    // A thread freeing into many pools in turns keeps each pool's blocks apart
+                    const int pools_count = 11;
+                    std::vector<std::unique_ptr<FixedBlockPool>> pools;
+                    std::vector<std::vector<void*>> blocks(pools_count);
+                    for (int i = 0; i < pools_count; i++) {
+                        pools.emplace_back(new FixedBlockPool(16 * (i + 1), alignof(std::max_align_t), 4));
+                    }
+                    for (int round = 0; round < 3; round++) {
+                        for (int i = 0; i < 200; i++) {
+                            const int k = (i * 7) % pools_count;
+                            blocks[k].push_back(pools[k]->Alloc());
+                        }
+                        // Blocks of pool k are 16 * (k + 1) bytes: a block given to the wrong pool overlaps others
+                        for (int k = 0; k < pools_count; k++) {
+                            for (void* block : blocks[k]) {
+                                std::memset(block, k, 16 * (k + 1));
+                            }
+                        }
+                        for (int k = 0; k < pools_count; k++) {
+                            for (void* block : blocks[k]) {
+                                const unsigned char* bytes = static_cast<const unsigned char*>(block);
+                                if (std::count(bytes, bytes + 16 * (k + 1), k) != 16 * (k + 1)) {
+                                    throw std::logic_error("pools used in turns mixed their blocks");
+                                }
+                                pools[k]->Free(block);
+                            }
+                            blocks[k].clear();
+                        }
+                    }
+                    for (int k = 0; k < pools_count; k++) {
+                        // Freed blocks went back to their own pool, which did not need more
+                        if (pools[k]->ReservedBlocks() > 4 * 16) {
+                            throw std::logic_error("pools used in turns mixed their blocks");
+                        }
+                    }
+                }
+            }
+
             std::vector<TestCase> GetTests() {
                 return {
                     { valid_oom::t1, true },
@@ -139,6 +546,22 @@ namespace made {
                     { valid_consistency::t1, false },
                     { valid_consistency::t2, false },
                     { valid_consistency::t3, false },
+                    { valid_arena::t1, false },
+                    { valid_arena::t2, false },
+                    { valid_arena::t3, false },
+                    { valid_arena::t4, false },
+                    { valid_arena::t5, false },
+                    { valid_arena::t6, false },
+                    { valid_arena_limits::t1, false },
+                    { valid_arena_limits::t2, false },
+                    { valid_arena_allocator::t1, false },
+                    { valid_arena_allocator::t2, false },
+                    { valid_arena_allocator::t3, true },
+                    { valid_object_pool::t1, false },
+                    { valid_object_pool::t2, false },
+                    { valid_object_pool::t3, false },
+                    { valid_object_pool::t4, false },
+                    { valid_object_pool::t5, false },
                 };
             }
 
@@ -0,0 +1,669 @@
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#include "matrix.h"
+#include "fixed_matrix.h"
+#include "layout.h"
+#include "matrix_io.h"
+#include "parallel.h"
+#include "sparse_matrix.h"
+
+namespace made {
+
+    namespace bench {
+        // Counts every heap allocation made through operator new / new[]
+        std::atomic<std::size_t> allocations(0);
+
+        typedef void(*BenchFunc)();
+
+        struct Benchmark {
+            const char* name;
+            BenchFunc function;
+        };
+
+        // Best wall time of `repeats` runs, in seconds
+        double MeasureBest(const std::function<void()>& func, int repeats = 3) {
+            double best = 0;
+            for (int i = 0; i < repeats; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                func();
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                if (i == 0 || elapsed.count() < best) {
+                    best = elapsed.count();
+                }
+            }
+            return best;
+        }
+
+        template <class T>
+        void Consume(const T& value) {
+            static volatile T sink;
+            sink = value;
+        }
+
+        void Report(const std::string& label, double seconds, double amount, const char* unit) {
+            std::cout << "  " << std::left << std::setw(48) << label << std::right
+                << std::fixed << std::setprecision(3) << std::setw(12) << seconds * 1e3 << " ms"
+                << std::setw(10) << std::setprecision(2) << amount / seconds / 1e9 << " " << unit << std::endl;
+        }
+
+        namespace matrix {
+            using namespace made::math;
+
+            template <class T>
+            void Fill(Matrix<T>& matrix, uint seed) {
+                for (uint i = 0; i < matrix.rows(); ++i) {
+                    for (uint j = 0; j < matrix.cols(); ++j) {
+                        matrix[i][j] = static_cast<T>(static_cast<int>((i * 31 + j * 17 + seed) % 19) - 9);
+                    }
+                }
+            }
+
+            namespace product {
+                const uint kSizes[] = { 64, 128, 256, 512, 1024, 2048, 4096 };
+                const uint kNaiveMaxSize = 1024; // naive 2048^3 and up takes minutes
+
+                // Classic i-j-k triple loop over plain row-major arrays
+                void naive(uint n, const std::vector<int>& a, const std::vector<int>& b, std::vector<int>& c) {
+                    for (uint i = 0; i < n; ++i) {
+                        for (uint j = 0; j < n; ++j) {
+                            int sum = 0;
+                            for (uint k = 0; k < n; ++k) {
+                                sum += a[i * n + k] * b[k * n + j];
+                            }
+                            c[i * n + j] = sum;
+                        }
+                    }
+                }
+
+                void run() {
+                    for (uint n : kSizes) {
+                        const double ops = 2.0 * n * n * n;
+                        const int repeats = n <= 512 ? 5 : 1;
+                        Matrix a(n, n);
+                        Matrix b(n, n);
+                        Fill(a, 1);
+                        Fill(b, 2);
+                        const std::string size = std::to_string(n) + "x" + std::to_string(n);
+                        if (n <= kNaiveMaxSize) {
+                            std::vector<int> plain_a(n * n), plain_b(n * n), plain_c(n * n);
+                            for (uint i = 0; i < n; ++i) {
+                                for (uint j = 0; j < n; ++j) {
+                                    plain_a[i * n + j] = a[i][j];
+                                    plain_b[i * n + j] = b[i][j];
+                                }
+                            }
+                            double seconds = MeasureBest([&]() {
+                                naive(n, plain_a, plain_b, plain_c);
+                                Consume(plain_c[n + 1]);
+                            }, repeats);
+                            Report(size + " naive triple loop", seconds, ops, "GOP/s");
+                        }
+                        double seconds = MeasureBest([&]() {
+                            Matrix c = a * b;
+                            Consume(c[0][0]);
+                        }, repeats);
+                        Report(size + " blocked Matrix * Matrix", seconds, ops, "GOP/s");
+                    }
+                }
+            }
+
+            namespace element_access {
+                const uint kSize = 2048;
+
+                // Sums every element through `access`, row by row
+                template <class Access>
+                void sum(const std::string& label, Access access) {
+                    double seconds = MeasureBest([&]() {
+                        long long total = 0;
+                        for (uint i = 0; i < kSize; ++i) {
+                            for (uint j = 0; j < kSize; ++j) {
+                                total += access(i, j);
+                            }
+                        }
+                        Consume(total);
+                    }, 5);
+                    Report(label, seconds, 1.0 * kSize * kSize, "G elem/s");
+                }
+
+                void run() {
+                    Matrix<int> matrix(kSize, kSize);
+                    Fill(matrix, 1);
+                    const Matrix<int>& constant = matrix;
+                    sum("m.at(i, j), always checked", [&](uint i, uint j) { return constant.at(i, j); });
+                    sum("m[i][j], Row proxy (checked in debug only)", [&](uint i, uint j) { return matrix[i][j]; });
+                    sum("m(i, j), unchecked", [&](uint i, uint j) { return constant(i, j); });
+                    sum("m.row_data(i)[j]", [&](uint i, uint j) { return constant.row_data(i)[j]; });
+                    MatrixView<const int> view = constant.View();
+                    sum("MatrixView(i, j)", [&](uint i, uint j) { return view(i, j); });
+                    MatrixView<const int> transposed = constant.Transposed();
+                    sum("transposed MatrixView(i, j), strided", [&](uint i, uint j) { return transposed(i, j); });
+                }
+            }
+
+            namespace chained {
+                const uint kSize = 256;
+                const int kRepeats = 20;
+
+                // Runs `expression` kRepeats times, reporting time and heap allocations per run
+                template <class Expression>
+                void measure(const std::string& label, Expression expression) {
+                    std::size_t allocated = 0;
+                    double seconds = MeasureBest([&]() {
+                        const std::size_t before = allocations;
+                        for (int i = 0; i < kRepeats; ++i) {
+                            Matrix<float> result = expression();
+                            Consume(result(i % kSize, 1));
+                        }
+                        allocated = allocations - before;
+                    });
+                    std::cout << "  " << std::left << std::setw(48) << label << std::right
+                        << std::fixed << std::setprecision(3) << std::setw(12) << seconds * 1e3 / kRepeats << " ms"
+                        << std::setw(10) << allocated / kRepeats << " allocations" << std::endl;
+                }
+
+                void run() {
+                    Matrix<float> a(kSize, kSize), b(kSize, kSize), c(kSize, kSize), d(kSize, kSize);
+                    Fill(a, 1);
+                    Fill(b, 2);
+                    Fill(c, 3);
+                    Fill(d, 4);
+                    measure("(a + b) * c - d, named temporaries", [&]() {
+                        Matrix<float> sum = a + b;
+                        Matrix<float> product = sum * c;
+                        Matrix<float> result = product - d;
+                        return result;
+                    });
+                    measure("(a + b) * c - d, chained", [&]() { return (a + b) * c - d; });
+                    measure("a + b - c + d, named temporaries", [&]() {
+                        Matrix<float> sum = a + b;
+                        Matrix<float> difference = sum - c;
+                        Matrix<float> result = difference + d;
+                        return result;
+                    });
+                    measure("a + b - c + d, chained", [&]() { return a + b - c + d; });
+                    measure("(a - b) * 2 + c * 3, chained", [&]() { return (a - b) * 2.0f + c * 3.0f; });
+                }
+            }
+
+            namespace fused {
+                const uint kRows = 10000;
+                const uint kCols = 10000;
+
+                // `traffic` is the number of bytes the variant reads and writes
+                template <class Expression>
+                void measure(const std::string& label, double traffic, Expression expression) {
+                    const std::size_t before = allocations;
+                    double seconds = MeasureBest(expression);
+                    const std::size_t allocated = (allocations - before) / 3;
+                    const int tenths = static_cast<int>(traffic / 1e8 + 0.5);
+                    Report(label + ", " + std::to_string(allocated) + " alloc, " + std::to_string(tenths / 10) + "."
+                        + std::to_string(tenths % 10) + " GB", seconds, traffic, "GB/s");
+                }
+
+                void run() {
+                    const double matrix_bytes = 1.0 * kRows * kCols * sizeof(float);
+                    Matrix<float> a(kRows, kCols), b(kRows, kCols), c(kRows, kCols), result(kRows, kCols);
+                    Fill(a, 1);
+                    Fill(b, 2);
+                    Fill(c, 3);
+                    Fill(result, 4);
+                    std::cout << "  result = a + b * 2 - c on " << kRows << "x" << kCols << " floats" << std::endl;
+                    measure("eager, temporary per operator", 8 * matrix_bytes, [&]() {
+                        Matrix<float> scaled(b * 2.0f);
+                        Matrix<float> sum(a + scaled);
+                        Matrix<float> difference(sum - c);
+                        Consume(difference(1, 1));
+                    });
+                    measure("eager, rvalue buffer reuse", 8 * matrix_bytes, [&]() {
+                        Matrix<float> difference = Matrix<float>(b * 2.0f) + a - c;
+                        Consume(difference(1, 1));
+                    });
+                    measure("fused into a new matrix", 4 * matrix_bytes, [&]() {
+                        Matrix<float> difference = a + b * 2.0f - c;
+                        Consume(difference(1, 1));
+                    });
+                    measure("fused into an existing matrix", 4 * matrix_bytes, [&]() {
+                        result = a + b * 2.0f - c;
+                        Consume(result(1, 1));
+                    });
+                }
+            }
+
+            namespace scaling {
+                const uint kSize = 2048;
+
+                void run() {
+                    const uint hardware = std::max(1u, std::thread::hardware_concurrency());
+                    std::vector<uint> thread_counts;
+                    for (uint threads = 1; threads < hardware; threads *= 2) {
+                        thread_counts.push_back(threads);
+                    }
+                    thread_counts.push_back(hardware);
+                    Matrix<float> a(kSize, kSize), b(kSize, kSize), result(kSize, kSize);
+                    Fill(a, 1);
+                    Fill(b, 2);
+                    const double elements = 1.0 * kSize * kSize;
+                    for (uint threads : thread_counts) {
+                        ThreadPool pool(threads - 1);
+                        std::cout << "  " << threads << " thread(s), " << kSize << "x" << kSize << " floats" << std::endl;
+                        double seconds = MeasureBest([&]() { Consume(parallel::Multiply(pool, a, b)(1, 1)); });
+                        Report("  product", seconds, 2.0 * elements * kSize, "GFLOP/s");
+                        seconds = MeasureBest([&]() { parallel::Assign(pool, result, a + b * 2.0f); }, 5);
+                        Report("  result = a + b * 2", seconds, 3 * elements * sizeof(float), "GB/s");
+                        seconds = MeasureBest([&]() { Consume(parallel::Transpose(pool, a)(1, 1)); }, 5);
+                        Report("  transpose", seconds, 2 * elements * sizeof(float), "GB/s");
+                        seconds = MeasureBest([&]() { Consume(parallel::Sum(pool, a)); }, 5);
+                        Report("  sum", seconds, elements * sizeof(float), "GB/s");
+                        seconds = MeasureBest([&]() { Consume(parallel::Max(pool, a)); }, 5);
+                        Report("  max", seconds, elements * sizeof(float), "GB/s");
+                        seconds = MeasureBest([&]() { Consume(parallel::FrobeniusNorm(pool, a)); }, 5);
+                        Report("  Frobenius norm", seconds, elements * sizeof(float), "GB/s");
+                        seconds = MeasureBest([&]() { Consume(parallel::Norm1(pool, a)); }, 5);
+                        Report("  1-norm (column sums)", seconds, elements * sizeof(float), "GB/s");
+                    }
+                }
+            }
+
+            namespace spmv {
+                const uint kSize = 4096;
+                const double kDensities[] = { 0.001, 0.005, 0.01, 0.05, 0.1, 0.25, 0.5 };
+
+                // y = A x over the rows of a dense row-major matrix, eight partial sums per
+                // row so the loop vectorizes (cols is a multiple of 8 here)
+                void dense(const Matrix<float>& matrix, const std::vector<float>& x, std::vector<float>& y) {
+                    const uint cols = matrix.cols();
+                    for (uint i = 0; i < matrix.rows(); ++i) {
+                        const float* row = matrix.row_data(i);
+                        float sums[8] = {};
+                        for (uint j = 0; j < cols; j += 8) {
+                            for (uint lane = 0; lane < 8; ++lane) {
+                                sums[lane] += row[j + lane] * x[j + lane];
+                            }
+                        }
+                        y[i] = ((sums[0] + sums[1]) + (sums[2] + sums[3])) + ((sums[4] + sums[5]) + (sums[6] + sums[7]));
+                    }
+                }
+
+                void run() {
+                    ThreadPool pool;
+                    std::vector<float> x(kSize), y(kSize);
+                    for (uint j = 0; j < kSize; ++j) {
+                        x[j] = static_cast<float>(j % 7) - 3;
+                    }
+                    Matrix<float> matrix(kSize, kSize);
+                    for (double density : kDensities) {
+                        const uint threshold = static_cast<uint>(density * (1u << 24));
+                        uint state = 12345;
+                        for (uint i = 0; i < kSize; ++i) {
+                            float* row = matrix.row_data(i);
+                            for (uint j = 0; j < kSize; ++j) {
+                                state = state * 1664525u + 1013904223u;
+                                row[j] = (state >> 8) < threshold ? static_cast<float>(state % 19) - 9 : 0.0f;
+                            }
+                        }
+                        CsrMatrix<float> csr(matrix);
+                        CscMatrix<float> csc(csr);
+                        const double flops = 2.0 * csr.nonzeros();
+                        const std::string label = std::to_string(density * 100).substr(0, 4) + "% nonzero, ";
+                        double seconds = MeasureBest([&]() {
+                            dense(matrix, x, y);
+                            Consume(y[1]);
+                        }, 5);
+                        Report(label + "dense mat-vec", seconds, flops, "GFLOP/s");
+                        seconds = MeasureBest([&]() { Consume((csr * x)[1]); }, 5);
+                        Report(label + "CSR SpMV", seconds, flops, "GFLOP/s");
+                        seconds = MeasureBest([&]() { Consume((csc * x)[1]); }, 5);
+                        Report(label + "CSC SpMV", seconds, flops, "GFLOP/s");
+                        seconds = MeasureBest([&]() { Consume(parallel::Multiply(pool, csr, x)[1]); }, 5);
+                        Report(label + "CSR SpMV, " + std::to_string(pool.size()) + " thread(s)", seconds, flops, "GFLOP/s");
+                    }
+                }
+            }
+
+            namespace transpose {
+                // 64 MB and 256 MB of floats per matrix, beyond any L3
+                const uint kSizes[] = { 4096, 8192 };
+
+                // Reads rows, writes columns: every store lands on a different cache line
+                void naive(const Matrix<float>& matrix, Matrix<float>& result) {
+                    const uint rows = matrix.rows(), cols = matrix.cols();
+                    for (uint i = 0; i < rows; ++i) {
+                        const float* row = matrix.row_data(i);
+                        for (uint j = 0; j < cols; ++j) {
+                            result.row_data(j)[i] = row[j];
+                        }
+                    }
+                }
+
+                void run() {
+                    for (uint n : kSizes) {
+                        Matrix<float> matrix(n, n), result(n, n);
+                        Fill(matrix, 1);
+                        Fill(result, 2);
+                        const double traffic = 2.0 * n * n * sizeof(float);
+                        const std::string size = std::to_string(n) + "x" + std::to_string(n);
+                        double seconds = MeasureBest([&]() {
+                            naive(matrix, result);
+                            Consume(result(1, 2));
+                        });
+                        Report(size + " naive transpose", seconds, traffic, "GB/s");
+                        seconds = MeasureBest([&]() {
+                            layout::Transpose(matrix.data(), n, n, n, result.data(), n);
+                            Consume(result(1, 2));
+                        });
+                        Report(size + " blocked 8x8 SIMD transpose", seconds, traffic, "GB/s");
+                        seconds = MeasureBest([&]() {
+                            TransposeInPlace(matrix);
+                            Consume(matrix(1, 2));
+                        });
+                        Report(size + " blocked in-place transpose", seconds, traffic, "GB/s");
+                        seconds = MeasureBest([&]() {
+                            ColumnMajorMatrix<float> columns(matrix);
+                            Consume(columns(1, 2));
+                        });
+                        Report(size + " to a new ColumnMajorMatrix", seconds, traffic, "GB/s");
+                    }
+                }
+            }
+
+            namespace small_product {
+                const uint kMultiplies = 10000000;
+                const uint kOperands = 64;
+
+                template <uint N>
+                void fixed() {
+                    typedef FixedMatrix<float, N, N> Fixed;
+                    std::vector<Fixed> lhs(kOperands), rhs(kOperands);
+                    for (uint m = 0; m < kOperands; ++m) {
+                        for (uint i = 0; i < N; ++i) {
+                            for (uint j = 0; j < N; ++j) {
+                                lhs[m](i, j) = static_cast<float>((i * 31 + j * 17 + m) % 19) - 9;
+                                rhs[m](i, j) = static_cast<float>((i * 13 + j * 7 + m) % 23) - 11;
+                            }
+                        }
+                    }
+                    double seconds = MeasureBest([&]() {
+                        float sum = 0;
+                        for (uint i = 0; i < kMultiplies; ++i) {
+                            Fixed c = lhs[i % kOperands] * rhs[(i * 7) % kOperands];
+                            sum += c(i % N, (i / N) % N);
+                        }
+                        Consume(sum);
+                    });
+                    const std::string size = std::to_string(N) + "x" + std::to_string(N);
+                    Report("1e7 x " + size + " FixedMatrix<float> products", seconds, 2.0 * N * N * N * kMultiplies, "GFLOP/s");
+                }
+
+                template <uint N>
+                void dynamic() {
+                    std::vector<Matrix<float>> lhs, rhs;
+                    for (uint m = 0; m < kOperands; ++m) {
+                        lhs.emplace_back(N, N);
+                        rhs.emplace_back(N, N);
+                        Fill(lhs.back(), m);
+                        Fill(rhs.back(), m * 3 + 1);
+                    }
+                    double seconds = MeasureBest([&]() {
+                        float sum = 0;
+                        for (uint i = 0; i < kMultiplies; ++i) {
+                            Matrix<float> c = lhs[i % kOperands] * rhs[(i * 7) % kOperands];
+                            sum += c[i % N][(i / N) % N];
+                        }
+                        Consume(sum);
+                    });
+                    const std::string size = std::to_string(N) + "x" + std::to_string(N);
+                    Report("1e7 x " + size + " Matrix<float> products", seconds, 2.0 * N * N * N * kMultiplies, "GFLOP/s");
+                }
+
+                void run() {
+                    dynamic<3>();
+                    fixed<3>();
+                    dynamic<4>();
+                    fixed<4>();
+                }
+            }
+
+            namespace file_io {
+                // 64 MB of floats, as binary and as whitespace-separated text
+                const uint kSize = 4096;
+
+                template <class View>
+                double SumAll(const View& view) {
+                    double sum = 0;
+                    for (uint i = 0; i < view.rows(); ++i) {
+                        const float* row = view.row_data(i);
+                        for (uint j = 0; j < view.cols(); ++j) {
+                            sum += row[j];
+                        }
+                    }
+                    return sum;
+                }
+
+                void save_text(const Matrix<float>& matrix, const std::string& path) {
+                    std::ofstream stream(path);
+                    stream << matrix.rows() << " " << matrix.cols() << "\n";
+                    for (uint i = 0; i < matrix.rows(); ++i) {
+                        for (uint j = 0; j < matrix.cols(); ++j) {
+                            stream << matrix(i, j) << " ";
+                        }
+                        stream << "\n";
+                    }
+                }
+
+                Matrix<float> load_text(const std::string& path) {
+                    std::ifstream stream(path);
+                    uint rows, cols;
+                    stream >> rows >> cols;
+                    Matrix<float> matrix(rows, cols);
+                    for (uint i = 0; i < rows; ++i) {
+                        for (uint j = 0; j < cols; ++j) {
+                            stream >> matrix(i, j);
+                        }
+                    }
+                    return matrix;
+                }
+
+                void run() {
+                    const std::string directory = std::filesystem::temp_directory_path().string();
+                    const std::string binary = directory + "/made-matrix-bench.bin";
+                    const std::string text = directory + "/made-matrix-bench.txt";
+                    Matrix<float> matrix(kSize, kSize);
+                    Fill(matrix, 1);
+                    const double bytes = static_cast<double>(kSize) * kSize * sizeof(float);
+                    const std::string size = std::to_string(kSize) + "x" + std::to_string(kSize);
+
+                    double seconds = MeasureBest([&]() { Save(matrix, binary); });
+                    Report(size + " binary Save", seconds, bytes, "GB/s");
+                    seconds = MeasureBest([&]() {
+                        MatrixWriter<float> writer(binary, kSize, kSize);
+                        for (uint i = 0; i < kSize; ++i) {
+                            writer.WriteRow(matrix.row_data(i));
+                        }
+                        writer.Close();
+                    });
+                    Report(size + " MatrixWriter row by row", seconds, bytes, "GB/s");
+                    seconds = MeasureBest([&]() { save_text(matrix, text); }, 1);
+                    Report(size + " text write", seconds, bytes, "GB/s");
+
+                    // Files are in the page cache: this is the cost of the format, not the disk
+                    seconds = MeasureBest([&]() {
+                        MappedMatrix<float> mapped(binary);
+                        Consume(mapped(kSize / 2, kSize / 2));
+                    });
+                    Report(size + " open to first access: mmap", seconds, bytes, "GB/s");
+                    seconds = MeasureBest([&]() {
+                        Matrix<float> loaded = Load<float>(binary);
+                        Consume(loaded(kSize / 2, kSize / 2));
+                    });
+                    Report(size + " open to first access: binary Load", seconds, bytes, "GB/s");
+                    seconds = MeasureBest([&]() {
+                        Matrix<float> loaded = load_text(text);
+                        Consume(loaded(kSize / 2, kSize / 2));
+                    }, 1);
+                    Report(size + " open to first access: text parse", seconds, bytes, "GB/s");
+
+                    seconds = MeasureBest([&]() {
+                        MappedMatrix<float> mapped(binary);
+                        Consume(SumAll(mapped));
+                    });
+                    Report(size + " open and sum: mmap", seconds, bytes, "GB/s");
+                    seconds = MeasureBest([&]() {
+                        Matrix<float> loaded = Load<float>(binary);
+                        Consume(SumAll(loaded));
+                    });
+                    Report(size + " open and sum: binary Load", seconds, bytes, "GB/s");
+                    std::remove(binary.c_str());
+                    std::remove(text.c_str());
+                }
+            }
+
+            namespace compare_fill {
+                // 64 MB of floats per matrix, beyond any L3
+                const uint kSize = 4096;
+
+                // The former operator==: nested loops with i * cols + j indexing
+                bool naive_equal(const Matrix<float>& lhs, const Matrix<float>& rhs) {
+                    if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols())
+                        return false;
+                    const uint rows = lhs.rows(), cols = lhs.cols();
+                    const float* a = lhs.data();
+                    const float* b = rhs.data();
+                    for (uint i = 0; i < rows; ++i) {
+                        for (uint j = 0; j < cols; ++j) {
+                            if (a[i * cols + j] != b[i * cols + j]) {
+                                return false;
+                            }
+                        }
+                    }
+                    return true;
+                }
+
+                bool naive_approx_equal(const Matrix<float>& lhs, const Matrix<float>& rhs, float eps) {
+                    const float* a = lhs.data();
+                    const float* b = rhs.data();
+                    for (size_t i = 0, size = static_cast<size_t>(lhs.rows()) * lhs.cols(); i < size; ++i) {
+                        if (!elementwise::Close(a[i], b[i], eps)) {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+
+                void run() {
+                    Matrix<float> lhs(kSize, kSize), rhs(kSize, kSize);
+                    Fill(lhs, 1);
+                    rhs = lhs;
+                    const double elements = static_cast<double>(kSize) * kSize;
+                    const double bytes = elements * sizeof(float);
+                    const std::string size = std::to_string(kSize) + "x" + std::to_string(kSize);
+
+                    double seconds = MeasureBest([&]() { Consume(naive_equal(lhs, rhs)); });
+                    Report(size + " equal, nested loop", seconds, 2 * bytes, "GB/s");
+                    seconds = MeasureBest([&]() { Consume(lhs == rhs); });
+                    Report(size + " equal, SIMD blocks", seconds, 2 * bytes, "GB/s");
+                    // Both stop halfway, at the first difference
+                    rhs(kSize / 2, 0) += 1.0f;
+                    seconds = MeasureBest([&]() { Consume(naive_equal(lhs, rhs)); });
+                    Report(size + " differ halfway, nested loop", seconds, bytes, "GB/s");
+                    seconds = MeasureBest([&]() { Consume(lhs == rhs); });
+                    Report(size + " differ halfway, SIMD blocks", seconds, bytes, "GB/s");
+                    rhs(kSize / 2, 0) -= 1.0f;
+
+                    seconds = MeasureBest([&]() { Consume(naive_approx_equal(lhs, rhs, 1e-6f)); });
+                    Report(size + " approx equal, scalar", seconds, 2 * bytes, "GB/s");
+                    seconds = MeasureBest([&]() { Consume(lhs.ApproxEqual(rhs, 1e-6f)); });
+                    Report(size + " approx equal, SIMD blocks", seconds, 2 * bytes, "GB/s");
+
+                    seconds = MeasureBest([&]() {
+                        float* data = lhs.data();
+                        for (size_t i = 0; i < elements; ++i) {
+                            data[i] = 3.0f;
+                        }
+                        Consume(lhs(1, 2));
+                    });
+                    Report(size + " fill, scalar loop", seconds, bytes, "GB/s");
+                    seconds = MeasureBest([&]() {
+                        lhs.Fill(3.0f);
+                        Consume(lhs(1, 2));
+                    });
+                    Report(size + " Fill, streaming stores", seconds, bytes, "GB/s");
+                    seconds = MeasureBest([&]() {
+                        float* data = lhs.data();
+                        for (size_t i = 0; i < elements; ++i) {
+                            data[i] = 0.5f + static_cast<float>(i) * 0.25f;
+                        }
+                        Consume(lhs(1, 2));
+                    });
+                    Report(size + " iota, scalar loop", seconds, bytes, "GB/s");
+                    seconds = MeasureBest([&]() {
+                        lhs.Iota(0.5f, 0.25f);
+                        Consume(lhs(1, 2));
+                    });
+                    Report(size + " Iota, SIMD", seconds, bytes, "GB/s");
+                }
+            }
+        }
+
+        std::vector<Benchmark> GetBenchmarks() {
+            return {
+                { "int matrix product", matrix::product::run },
+                { "small float matrix product", matrix::small_product::run },
+                { "element access", matrix::element_access::run },
+                { "chained arithmetic allocations", matrix::chained::run },
+                { "fused element-wise expression", matrix::fused::run },
+                { "parallel kernels scaling", matrix::scaling::run },
+                { "sparse matrix-vector product", matrix::spmv::run },
+                { "transpose bandwidth", matrix::transpose::run },
+                { "binary file I/O", matrix::file_io::run },
+                { "comparison and fill", matrix::compare_fill::run },
+            };
+        }
+
+        int RunBenchmarks(const std::string& filter) {
+            std::vector<Benchmark> benchmarks = GetBenchmarks();
+            std::size_t benchmarks_count = benchmarks.size();
+            for (std::size_t i = 0; i < benchmarks_count; ++i) {
+                if (std::string(benchmarks[i].name).find(filter) == std::string::npos) {
+                    continue;
+                }
+                std::cout << "Running benchmark " << i + 1 << "/" << benchmarks_count << "... "
+                    << benchmarks[i].name << std::endl;
+                benchmarks[i].function();
+            }
+            return 0;
+        }
+    }
+
+}
+
+void* operator new(std::size_t size) {
+    ++made::bench::allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char* argv[]) {
+    made::bench::RunBenchmarks(argc > 1 ? argv[1] : "");
+}
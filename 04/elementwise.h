@@ -0,0 +1,216 @@
+#pragma once
+#ifndef ELEMENTWISE_H_
+#define ELEMENTWISE_H_
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace made {
+
+    namespace math {
+
+        // Whole-buffer comparison, fill and iota over contiguous elements. Comparisons
+        // test kBlock elements at a time without branching and stop at the first block
+        // that differs; int, float and double blocks use AVX/AVX2 compares.
+        namespace elementwise {
+            const size_t kBlock = 32;
+            // Fills of more bytes than this skip the caches with streaming stores:
+            // the buffer would not stay in cache anyway, and no line has to be read first
+            const size_t kStreamBytes = size_t(1) << 23;
+
+            // |a - b| <= eps * max(1, |a|, |b|): absolute tolerance around zero, relative
+            // elsewhere. Equal values (infinities included) match, NaN never does.
+            template <class T>
+            inline bool Close(T lhs, T rhs, T eps) {
+                return lhs == rhs || std::abs(lhs - rhs) <= eps * std::max(T(1), std::max(std::abs(lhs), std::abs(rhs)));
+            }
+
+            template <class T>
+            inline bool BlockDiffers(const T* lhs, const T* rhs) {
+                bool differ = false;
+                for (size_t i = 0; i < kBlock; ++i) {
+                    differ |= lhs[i] != rhs[i];
+                }
+                return differ;
+            }
+
+            template <class T>
+            inline bool BlockClose(const T* lhs, const T* rhs, T eps) {
+                bool close = true;
+                for (size_t i = 0; i < kBlock; ++i) {
+                    close &= Close(lhs[i], rhs[i], eps);
+                }
+                return close;
+            }
+
+#if defined(__AVX__)
+            template <>
+            inline bool BlockDiffers<float>(const float* lhs, const float* rhs) {
+                __m256 differ = _mm256_setzero_ps();
+                for (size_t i = 0; i < kBlock; i += 8) {
+                    differ = _mm256_or_ps(differ, _mm256_cmp_ps(_mm256_loadu_ps(lhs + i), _mm256_loadu_ps(rhs + i), _CMP_NEQ_UQ));
+                }
+                return _mm256_movemask_ps(differ) != 0;
+            }
+
+            template <>
+            inline bool BlockDiffers<double>(const double* lhs, const double* rhs) {
+                __m256d differ = _mm256_setzero_pd();
+                for (size_t i = 0; i < kBlock; i += 4) {
+                    differ = _mm256_or_pd(differ, _mm256_cmp_pd(_mm256_loadu_pd(lhs + i), _mm256_loadu_pd(rhs + i), _CMP_NEQ_UQ));
+                }
+                return _mm256_movemask_pd(differ) != 0;
+            }
+
+            template <>
+            inline bool BlockClose<float>(const float* lhs, const float* rhs, float eps) {
+                const __m256 sign = _mm256_set1_ps(-0.0f), one = _mm256_set1_ps(1.0f), tolerance = _mm256_set1_ps(eps);
+                __m256 close = _mm256_cmp_ps(one, one, _CMP_EQ_OQ);
+                for (size_t i = 0; i < kBlock; i += 8) {
+                    const __m256 a = _mm256_loadu_ps(lhs + i), b = _mm256_loadu_ps(rhs + i);
+                    const __m256 scale = _mm256_max_ps(one, _mm256_max_ps(_mm256_andnot_ps(sign, a), _mm256_andnot_ps(sign, b)));
+                    const __m256 within = _mm256_cmp_ps(_mm256_andnot_ps(sign, _mm256_sub_ps(a, b)), _mm256_mul_ps(tolerance, scale), _CMP_LE_OQ);
+                    close = _mm256_and_ps(close, _mm256_or_ps(within, _mm256_cmp_ps(a, b, _CMP_EQ_OQ)));
+                }
+                return _mm256_movemask_ps(close) == 0xFF;
+            }
+
+            template <>
+            inline bool BlockClose<double>(const double* lhs, const double* rhs, double eps) {
+                const __m256d sign = _mm256_set1_pd(-0.0), one = _mm256_set1_pd(1.0), tolerance = _mm256_set1_pd(eps);
+                __m256d close = _mm256_cmp_pd(one, one, _CMP_EQ_OQ);
+                for (size_t i = 0; i < kBlock; i += 4) {
+                    const __m256d a = _mm256_loadu_pd(lhs + i), b = _mm256_loadu_pd(rhs + i);
+                    const __m256d scale = _mm256_max_pd(one, _mm256_max_pd(_mm256_andnot_pd(sign, a), _mm256_andnot_pd(sign, b)));
+                    const __m256d within = _mm256_cmp_pd(_mm256_andnot_pd(sign, _mm256_sub_pd(a, b)), _mm256_mul_pd(tolerance, scale), _CMP_LE_OQ);
+                    close = _mm256_and_pd(close, _mm256_or_pd(within, _mm256_cmp_pd(a, b, _CMP_EQ_OQ)));
+                }
+                return _mm256_movemask_pd(close) == 0xF;
+            }
+#endif
+
+#if defined(__AVX2__)
+            template <>
+            inline bool BlockDiffers<int>(const int* lhs, const int* rhs) {
+                __m256i same = _mm256_set1_epi32(-1);
+                for (size_t i = 0; i < kBlock; i += 8) {
+                    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+                    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+                    same = _mm256_and_si256(same, _mm256_cmpeq_epi32(a, b));
+                }
+                return _mm256_movemask_epi8(same) != -1;
+            }
+#endif
+
+            template <class T>
+            bool Equal(const T* lhs, const T* rhs, size_t size) {
+                size_t i = 0;
+                for (; i + kBlock <= size; i += kBlock) {
+                    if (BlockDiffers(lhs + i, rhs + i)) {
+                        return false;
+                    }
+                }
+                for (; i < size; ++i) {
+                    if (lhs[i] != rhs[i]) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            template <class T>
+            bool ApproxEqual(const T* lhs, const T* rhs, size_t size, T eps) {
+                static_assert(std::is_floating_point<T>::value, "approximate comparison needs a floating point type");
+                size_t i = 0;
+                for (; i + kBlock <= size; i += kBlock) {
+                    if (!BlockClose(lhs + i, rhs + i, eps)) {
+                        return false;
+                    }
+                }
+                for (; i < size; ++i) {
+                    if (!Close(lhs[i], rhs[i], eps)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            // Any trivially copyable T whose size divides 32 bytes is stored as a repeated
+            // 32-byte pattern, so one kernel covers every such type
+            template <class T>
+            void Fill(T* data, size_t size, const T& value) {
+#if defined(__AVX__)
+                if constexpr (std::is_trivially_copyable<T>::value && 32 % sizeof(T) == 0) {
+                    alignas(32) unsigned char bytes[32];
+                    for (size_t offset = 0; offset < sizeof(bytes); offset += sizeof(T)) {
+                        std::memcpy(bytes + offset, &value, sizeof(T));
+                    }
+                    const __m256i pattern = _mm256_load_si256(reinterpret_cast<const __m256i*>(bytes));
+                    const size_t lanes = 32 / sizeof(T);
+                    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(data);
+                    // Steps of sizeof(T) reach a 32-byte boundary only from a multiple of
+                    // sizeof(T); buffers that never do take the unaligned stores
+                    const bool stream = size > kStreamBytes / sizeof(T) && address % sizeof(T) == 0;
+                    const size_t head = stream ? std::min(size, (32 - address % 32) % 32 / sizeof(T)) : 0;
+                    std::fill(data, data + head, value);
+                    const size_t end = head + (size - head) / lanes * lanes;
+                    if (stream) {
+                        for (size_t i = head; i < end; i += lanes) {
+                            _mm256_stream_si256(reinterpret_cast<__m256i*>(data + i), pattern);
+                        }
+                        _mm_sfence();
+                    }
+                    else {
+                        for (size_t i = head; i < end; i += lanes) {
+                            _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), pattern);
+                        }
+                    }
+                    std::fill(data + end, data + size, value);
+                    return;
+                }
+#endif
+                std::fill(data, data + size, value);
+            }
+
+            // data[i] = start + i * step; computed from i rather than accumulated, so
+            // floating point values do not drift along the buffer
+            template <class T>
+            void Iota(T* data, size_t size, T start, T step) {
+                size_t i = 0;
+#if defined(__AVX2__)
+                if constexpr (std::is_same<T, float>::value || std::is_same<T, int>::value) {
+                    if (size <= static_cast<size_t>(INT_MAX)) {
+                        __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+                        const __m256i eight = _mm256_set1_epi32(8);
+                        for (; i + 8 <= size; i += 8) {
+                            if constexpr (std::is_same<T, float>::value) {
+                                const __m256 value = _mm256_add_ps(_mm256_set1_ps(start), _mm256_mul_ps(_mm256_cvtepi32_ps(index), _mm256_set1_ps(step)));
+                                _mm256_storeu_ps(data + i, value);
+                            }
+                            else {
+                                const __m256i value = _mm256_add_epi32(_mm256_set1_epi32(start), _mm256_mullo_epi32(index, _mm256_set1_epi32(step)));
+                                _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), value);
+                            }
+                            index = _mm256_add_epi32(index, eight);
+                        }
+                    }
+                }
+#endif
+                for (; i < size; ++i) {
+                    data[i] = start + static_cast<T>(i) * step;
+                }
+            }
+        }
+    }
+}
+
+#endif  // !ELEMENTWISE_H_
@@ -0,0 +1,152 @@
+#pragma once
+#ifndef FIXED_MATRIX_H_
+#define FIXED_MATRIX_H_
+
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <utility>
+
+namespace made {
+
+    namespace math {
+        typedef unsigned int uint;
+
+        // R x C matrix with inline row-major storage and sizes known at compile time.
+        // Meant for small transforms (3x3, 4x4): no heap allocation, no bounds checks,
+        // every operation is constexpr and expands into straight-line code over the elements.
+        template <class T, uint R, uint C>
+        class FixedMatrix {
+            template <class U, uint R2, uint C2>
+            friend class FixedMatrix;
+        public:
+            typedef T value_type;
+            static constexpr uint kSize = R * C;
+
+            constexpr FixedMatrix() : data_{} {}
+            // Row-major element list, missing elements are zero
+            constexpr FixedMatrix(std::initializer_list<T> values) : data_{} {
+                uint i = 0;
+                for (const T& value : values) {
+                    if (i == kSize) {
+                        break;
+                    }
+                    data_[i++] = value;
+                }
+            }
+
+            static constexpr FixedMatrix Identity();
+
+            static constexpr uint rows() { return R; }
+            static constexpr uint cols() { return C; }
+            constexpr T& operator()(uint row, uint col) { return data_[row * C + col]; }
+            constexpr const T& operator()(uint row, uint col) const { return data_[row * C + col]; }
+
+            constexpr FixedMatrix& operator*=(const T multiplier);
+            constexpr FixedMatrix operator+(const FixedMatrix& rhs) const;
+            constexpr FixedMatrix operator-(const FixedMatrix& rhs) const;
+            constexpr bool operator==(const FixedMatrix& rhs) const;
+            constexpr bool operator!=(const FixedMatrix& rhs) const { return !(*this == rhs); }
+            constexpr FixedMatrix<T, C, R> Transposed() const;
+            void Print() const;
+
+            template <uint K>
+            constexpr FixedMatrix<T, R, K> operator*(const FixedMatrix<T, C, K>& rhs) const;
+        private:
+            struct Elements {};
+
+            // Builds the matrix from exactly kSize values produced by a pack expansion
+            template <class... Values>
+            constexpr FixedMatrix(Elements, Values... values) : data_{ static_cast<T>(values)... } {}
+
+            template <std::size_t... I>
+            constexpr FixedMatrix Add(const FixedMatrix& rhs, std::index_sequence<I...>) const {
+                return FixedMatrix(Elements(), (data_[I] + rhs.data_[I])...);
+            }
+            template <std::size_t... I>
+            constexpr FixedMatrix Subtract(const FixedMatrix& rhs, std::index_sequence<I...>) const {
+                return FixedMatrix(Elements(), (data_[I] - rhs.data_[I])...);
+            }
+            template <std::size_t... I>
+            constexpr bool Equal(const FixedMatrix& rhs, std::index_sequence<I...>) const {
+                return ((data_[I] == rhs.data_[I]) && ...);
+            }
+            template <std::size_t... I>
+            constexpr FixedMatrix<T, C, R> Transpose(std::index_sequence<I...>) const {
+                return FixedMatrix<T, C, R>(typename FixedMatrix<T, C, R>::Elements(), data_[(I % R) * C + I / R]...);
+            }
+            template <uint K, std::size_t... P>
+            constexpr T Dot(const FixedMatrix<T, C, K>& rhs, uint row, uint col, std::index_sequence<P...>) const {
+                return ((data_[row * C + P] * rhs.data_[P * K + col]) + ...);
+            }
+            template <uint K, std::size_t... I>
+            constexpr FixedMatrix<T, R, K> Product(const FixedMatrix<T, C, K>& rhs, std::index_sequence<I...>) const {
+                return FixedMatrix<T, R, K>(typename FixedMatrix<T, R, K>::Elements(),
+                    Dot(rhs, I / K, I % K, std::make_index_sequence<C>())...);
+            }
+            template <std::size_t... I>
+            static constexpr FixedMatrix MakeIdentity(std::index_sequence<I...>) {
+                return FixedMatrix(Elements(), (I / C == I % C ? T(1) : T())...);
+            }
+
+            T data_[kSize];
+        };
+
+        template <class T, uint R, uint C>
+        constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::Identity() {
+            return MakeIdentity(std::make_index_sequence<kSize>());
+        }
+
+        template <class T, uint R, uint C>
+        constexpr FixedMatrix<T, R, C>& FixedMatrix<T, R, C>::operator*=(const T multiplier) {
+            for (uint i = 0; i < kSize; ++i) {
+                data_[i] *= multiplier;
+            }
+            return *this;
+        }
+
+        template <class T, uint R, uint C>
+        constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::operator+(const FixedMatrix& rhs) const {
+            return Add(rhs, std::make_index_sequence<kSize>());
+        }
+
+        template <class T, uint R, uint C>
+        constexpr FixedMatrix<T, R, C> FixedMatrix<T, R, C>::operator-(const FixedMatrix& rhs) const {
+            return Subtract(rhs, std::make_index_sequence<kSize>());
+        }
+
+        template <class T, uint R, uint C>
+        constexpr bool FixedMatrix<T, R, C>::operator==(const FixedMatrix& rhs) const {
+            return Equal(rhs, std::make_index_sequence<kSize>());
+        }
+
+        template <class T, uint R, uint C>
+        constexpr FixedMatrix<T, C, R> FixedMatrix<T, R, C>::Transposed() const {
+            return Transpose(std::make_index_sequence<kSize>());
+        }
+
+        template <class T, uint R, uint C>
+        template <uint K>
+        constexpr FixedMatrix<T, R, K> FixedMatrix<T, R, C>::operator*(const FixedMatrix<T, C, K>& rhs) const {
+            return Product(rhs, std::make_index_sequence<R * K>());
+        }
+
+        template <class T, uint R, uint C>
+        void FixedMatrix<T, R, C>::Print() const {
+            std::cout << std::endl;
+            for (uint i = 0; i < R; ++i) {
+                for (uint j = 0; j < C; ++j) {
+                    std::cout << data_[i * C + j] << " ";
+                }
+                std::cout << std::endl;
+            }
+        }
+
+        typedef FixedMatrix<float, 3, 3> Matrix3f;
+        typedef FixedMatrix<float, 4, 4> Matrix4f;
+        typedef FixedMatrix<double, 3, 3> Matrix3d;
+        typedef FixedMatrix<double, 4, 4> Matrix4d;
+    }
+}
+
+#endif  // !FIXED_MATRIX_H_
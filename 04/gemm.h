@@ -0,0 +1,316 @@
+#pragma once
+#ifndef GEMM_H_
+#define GEMM_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace made {
+
+    namespace math {
+        typedef unsigned int uint;
+
+        namespace gemm {
+            // Register block of the micro-kernel (MR x NR of C kept in registers)
+            // and cache blocks: a KC x NR panel of B stays in L1, an MC x KC block of A in L2.
+            template <class T>
+            struct Blocking {
+                static constexpr uint MR = 4;
+                static constexpr uint NR = 16;
+                static constexpr uint KC = 256;
+                static constexpr uint MC = 96;
+                static constexpr uint NC = 4096;
+            };
+
+            // 6 x 16 float and 6 x 8 double: twelve ymm accumulators
+            template <>
+            struct Blocking<float> {
+                static constexpr uint MR = 6;
+                static constexpr uint NR = 16;
+                static constexpr uint KC = 256;
+                static constexpr uint MC = 96;
+                static constexpr uint NC = 4096;
+            };
+
+            template <>
+            struct Blocking<double> {
+                static constexpr uint MR = 6;
+                static constexpr uint NR = 8;
+                static constexpr uint KC = 256;
+                static constexpr uint MC = 96;
+                static constexpr uint NC = 4096;
+            };
+
+            // Products up to this many multiply-adds skip packing altogether
+            constexpr size_t kSmallProduct = 16 * 16 * 16;
+
+            // Copies an mc x kc block of A into MR-row panels, p-major inside each panel,
+            // padding the last panel with zeros
+            template <class T>
+            void PackA(uint mc, uint kc, const T* a, uint lda, T* packed) {
+                constexpr uint MR = Blocking<T>::MR;
+                for (uint i = 0; i < mc; i += MR) {
+                    const uint rows = std::min(MR, mc - i);
+                    for (uint p = 0; p < kc; ++p) {
+                        for (uint r = 0; r < rows; ++r) {
+                            packed[r] = a[(i + r) * lda + p];
+                        }
+                        for (uint r = rows; r < MR; ++r) {
+                            packed[r] = T();
+                        }
+                        packed += MR;
+                    }
+                }
+            }
+
+            // Copies a kc x nc block of B into NR-column panels, p-major inside each panel,
+            // padding the last panel with zeros
+            template <class T>
+            void PackB(uint kc, uint nc, const T* b, uint ldb, T* packed) {
+                constexpr uint NR = Blocking<T>::NR;
+                for (uint j = 0; j < nc; j += NR) {
+                    const uint cols = std::min(NR, nc - j);
+                    for (uint p = 0; p < kc; ++p) {
+                        const T* row = b + p * ldb + j;
+                        for (uint c = 0; c < cols; ++c) {
+                            packed[c] = row[c];
+                        }
+                        for (uint c = cols; c < NR; ++c) {
+                            packed[c] = T();
+                        }
+                        packed += NR;
+                    }
+                }
+            }
+
+            // C[mr x nr] += Apanel * Bpanel, portable version
+            template <class T>
+            void MicroKernel(uint kc, const T* a, const T* b, T* c, uint ldc, uint mr, uint nr) {
+                constexpr uint MR = Blocking<T>::MR;
+                constexpr uint NR = Blocking<T>::NR;
+                T acc[MR][NR] = {};
+                for (uint p = 0; p < kc; ++p, a += MR, b += NR) {
+                    for (uint r = 0; r < MR; ++r) {
+                        const T value = a[r];
+                        for (uint j = 0; j < NR; ++j) {
+                            acc[r][j] += value * b[j];
+                        }
+                    }
+                }
+                for (uint r = 0; r < mr; ++r) {
+                    for (uint j = 0; j < nr; ++j) {
+                        c[r * ldc + j] += acc[r][j];
+                    }
+                }
+            }
+
+#if defined(__AVX2__)
+            // 4 x 16 int block in eight ymm accumulators
+            template <>
+            inline void MicroKernel<int>(uint kc, const int* a, const int* b, int* c, uint ldc, uint mr, uint nr) {
+                __m256i c00 = _mm256_setzero_si256(), c01 = _mm256_setzero_si256();
+                __m256i c10 = _mm256_setzero_si256(), c11 = _mm256_setzero_si256();
+                __m256i c20 = _mm256_setzero_si256(), c21 = _mm256_setzero_si256();
+                __m256i c30 = _mm256_setzero_si256(), c31 = _mm256_setzero_si256();
+                for (uint p = 0; p < kc; ++p, a += 4, b += 16) {
+                    const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+                    const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 8));
+                    __m256i value = _mm256_set1_epi32(a[0]);
+                    c00 = _mm256_add_epi32(c00, _mm256_mullo_epi32(value, b0));
+                    c01 = _mm256_add_epi32(c01, _mm256_mullo_epi32(value, b1));
+                    value = _mm256_set1_epi32(a[1]);
+                    c10 = _mm256_add_epi32(c10, _mm256_mullo_epi32(value, b0));
+                    c11 = _mm256_add_epi32(c11, _mm256_mullo_epi32(value, b1));
+                    value = _mm256_set1_epi32(a[2]);
+                    c20 = _mm256_add_epi32(c20, _mm256_mullo_epi32(value, b0));
+                    c21 = _mm256_add_epi32(c21, _mm256_mullo_epi32(value, b1));
+                    value = _mm256_set1_epi32(a[3]);
+                    c30 = _mm256_add_epi32(c30, _mm256_mullo_epi32(value, b0));
+                    c31 = _mm256_add_epi32(c31, _mm256_mullo_epi32(value, b1));
+                }
+                alignas(32) int acc[4][16];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(acc[0]), c00);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(acc[0] + 8), c01);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(acc[1]), c10);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(acc[1] + 8), c11);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(acc[2]), c20);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(acc[2] + 8), c21);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(acc[3]), c30);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(acc[3] + 8), c31);
+                if (mr == 4 && nr == 16) {
+                    for (uint r = 0; r < 4; ++r) {
+                        __m256i* row = reinterpret_cast<__m256i*>(c + r * ldc);
+                        const __m256i* sum = reinterpret_cast<const __m256i*>(acc[r]);
+                        _mm256_storeu_si256(row, _mm256_add_epi32(_mm256_loadu_si256(row), _mm256_load_si256(sum)));
+                        _mm256_storeu_si256(row + 1, _mm256_add_epi32(_mm256_loadu_si256(row + 1), _mm256_load_si256(sum + 1)));
+                    }
+                    return;
+                }
+                for (uint r = 0; r < mr; ++r) {
+                    for (uint j = 0; j < nr; ++j) {
+                        c[r * ldc + j] += acc[r][j];
+                    }
+                }
+            }
+
+#if defined(__FMA__)
+            // ymm operations for the float and double kernels
+            template <class T>
+            struct Ymm;
+
+            template <>
+            struct Ymm<float> {
+                typedef __m256 type;
+                static constexpr uint kLanes = 8;
+                static type Zero() { return _mm256_setzero_ps(); }
+                static type Load(const float* p) { return _mm256_loadu_ps(p); }
+                static void Store(float* p, type v) { _mm256_storeu_ps(p, v); }
+                static type Broadcast(float v) { return _mm256_set1_ps(v); }
+                static type Fma(type a, type b, type c) { return _mm256_fmadd_ps(a, b, c); }
+                static type Add(type a, type b) { return _mm256_add_ps(a, b); }
+            };
+
+            template <>
+            struct Ymm<double> {
+                typedef __m256d type;
+                static constexpr uint kLanes = 4;
+                static type Zero() { return _mm256_setzero_pd(); }
+                static type Load(const double* p) { return _mm256_loadu_pd(p); }
+                static void Store(double* p, type v) { _mm256_storeu_pd(p, v); }
+                static type Broadcast(double v) { return _mm256_set1_pd(v); }
+                static type Fma(type a, type b, type c) { return _mm256_fmadd_pd(a, b, c); }
+                static type Add(type a, type b) { return _mm256_add_pd(a, b); }
+            };
+
+            // 6 x (2 * kLanes) block in twelve named ymm accumulators, spelled out like the
+            // int kernel so they stay in registers
+            template <class T>
+            inline void FmaKernel(uint kc, const T* a, const T* b, T* c, uint ldc, uint mr, uint nr) {
+                typedef Ymm<T> V;
+                typedef typename V::type Y;
+                constexpr uint MR = Blocking<T>::MR;
+                constexpr uint NR = Blocking<T>::NR;
+                constexpr uint L = V::kLanes;
+                static_assert(MR == 6 && NR == 2 * L, "FmaKernel expects a 6 x (2 * kLanes) block");
+                Y c00 = V::Zero(), c01 = V::Zero(), c10 = V::Zero(), c11 = V::Zero();
+                Y c20 = V::Zero(), c21 = V::Zero(), c30 = V::Zero(), c31 = V::Zero();
+                Y c40 = V::Zero(), c41 = V::Zero(), c50 = V::Zero(), c51 = V::Zero();
+                for (uint p = 0; p < kc; ++p, a += MR, b += NR) {
+                    const Y b0 = V::Load(b);
+                    const Y b1 = V::Load(b + L);
+                    Y value = V::Broadcast(a[0]);
+                    c00 = V::Fma(value, b0, c00);
+                    c01 = V::Fma(value, b1, c01);
+                    value = V::Broadcast(a[1]);
+                    c10 = V::Fma(value, b0, c10);
+                    c11 = V::Fma(value, b1, c11);
+                    value = V::Broadcast(a[2]);
+                    c20 = V::Fma(value, b0, c20);
+                    c21 = V::Fma(value, b1, c21);
+                    value = V::Broadcast(a[3]);
+                    c30 = V::Fma(value, b0, c30);
+                    c31 = V::Fma(value, b1, c31);
+                    value = V::Broadcast(a[4]);
+                    c40 = V::Fma(value, b0, c40);
+                    c41 = V::Fma(value, b1, c41);
+                    value = V::Broadcast(a[5]);
+                    c50 = V::Fma(value, b0, c50);
+                    c51 = V::Fma(value, b1, c51);
+                }
+                const Y acc[MR][2] = { { c00, c01 }, { c10, c11 }, { c20, c21 }, { c30, c31 }, { c40, c41 }, { c50, c51 } };
+                if (mr == MR && nr == NR) {
+                    for (uint r = 0; r < MR; ++r) {
+                        T* row = c + r * ldc;
+                        V::Store(row, V::Add(V::Load(row), acc[r][0]));
+                        V::Store(row + L, V::Add(V::Load(row + L), acc[r][1]));
+                    }
+                    return;
+                }
+                alignas(32) T partial[MR][NR];
+                for (uint r = 0; r < MR; ++r) {
+                    V::Store(partial[r], acc[r][0]);
+                    V::Store(partial[r] + L, acc[r][1]);
+                }
+                for (uint r = 0; r < mr; ++r) {
+                    for (uint j = 0; j < nr; ++j) {
+                        c[r * ldc + j] += partial[r][j];
+                    }
+                }
+            }
+
+            template <>
+            inline void MicroKernel<float>(uint kc, const float* a, const float* b, float* c, uint ldc, uint mr, uint nr) {
+                FmaKernel(kc, a, b, c, ldc, mr, nr);
+            }
+
+            template <>
+            inline void MicroKernel<double>(uint kc, const double* a, const double* b, double* c, uint ldc, uint mr, uint nr) {
+                FmaKernel(kc, a, b, c, ldc, mr, nr);
+            }
+#endif
+#endif
+
+            // C[m x n] = A[m x k] * B[k x n] for row-major operands with leading dimensions lda, ldb, ldc
+            template <class T>
+            void Multiply(uint m, uint n, uint k, const T* a, uint lda, const T* b, uint ldb, T* c, uint ldc) {
+                constexpr uint MR = Blocking<T>::MR;
+                constexpr uint NR = Blocking<T>::NR;
+                constexpr uint KC = Blocking<T>::KC;
+                constexpr uint MC = Blocking<T>::MC;
+                constexpr uint NC = Blocking<T>::NC;
+                for (uint i = 0; i < m; ++i) {
+                    std::fill(c + i * ldc, c + i * ldc + n, T());
+                }
+                if (m == 0 || n == 0 || k == 0) {
+                    return;
+                }
+                if (static_cast<size_t>(m) * n * k <= kSmallProduct) {
+                    for (uint i = 0; i < m; ++i) {
+                        T* row = c + i * ldc;
+                        for (uint p = 0; p < k; ++p) {
+                            const T value = a[i * lda + p];
+                            const T* b_row = b + p * ldb;
+                            for (uint j = 0; j < n; ++j) {
+                                row[j] += value * b_row[j];
+                            }
+                        }
+                    }
+                    return;
+                }
+                // Buffers are sized to the operands and left uninitialized, packing overwrites them
+                const uint kc_max = std::min(KC, k);
+                const uint mc_max = std::min(MC, (m + MR - 1) / MR * MR);
+                const uint nc_max = std::min(NC, (n + NR - 1) / NR * NR);
+                std::unique_ptr<T[]> packed_a(new T[static_cast<size_t>(mc_max) * kc_max]);
+                std::unique_ptr<T[]> packed_b(new T[static_cast<size_t>(kc_max) * nc_max]);
+                for (uint jc = 0; jc < n; jc += NC) {
+                    const uint nc = std::min(NC, n - jc);
+                    for (uint pc = 0; pc < k; pc += KC) {
+                        const uint kc = std::min(KC, k - pc);
+                        PackB(kc, nc, b + pc * ldb + jc, ldb, packed_b.get());
+                        for (uint ic = 0; ic < m; ic += MC) {
+                            const uint mc = std::min(MC, m - ic);
+                            PackA(mc, kc, a + ic * lda + pc, lda, packed_a.get());
+                            for (uint jr = 0; jr < nc; jr += NR) {
+                                const uint nr = std::min(NR, nc - jr);
+                                const T* panel_b = packed_b.get() + jr * kc;
+                                for (uint ir = 0; ir < mc; ir += MR) {
+                                    const uint mr = std::min(MR, mc - ir);
+                                    MicroKernel(kc, packed_a.get() + ir * kc, panel_b, c + (ic + ir) * ldc + jc + jr, ldc, mr, nr);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif  // !GEMM_H_
@@ -0,0 +1,197 @@
+#pragma once
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+#include "matrix.h"
+
+namespace made {
+
+    namespace math {
+
+        // Transposes and row-major <-> column-major conversion. The matrix is walked in
+        // kTile x kTile tiles that fit in L1 for both source and destination, and every
+        // tile in 8 x 8 blocks; 32-bit elements use an AVX register transpose for those.
+        namespace layout {
+            const uint kBlock = 8;
+            const uint kTile = 32;
+
+            // dst[c * ldd + r] = src[r * lds + c] for an 8 x 8 block
+            template <class T>
+            inline void TransposeBlock8(const T* src, size_t lds, T* dst, size_t ldd) {
+                for (uint r = 0; r < kBlock; ++r) {
+                    for (uint c = 0; c < kBlock; ++c) {
+                        dst[c * ldd + r] = src[r * lds + c];
+                    }
+                }
+            }
+
+#if defined(__AVX__)
+            // Eight rows in ymm registers: unpack pairs, shuffle quads, swap 128-bit halves
+            inline void TransposeBlock8x32(const float* src, size_t lds, float* dst, size_t ldd) {
+                const __m256 r0 = _mm256_loadu_ps(src), r1 = _mm256_loadu_ps(src + lds);
+                const __m256 r2 = _mm256_loadu_ps(src + 2 * lds), r3 = _mm256_loadu_ps(src + 3 * lds);
+                const __m256 r4 = _mm256_loadu_ps(src + 4 * lds), r5 = _mm256_loadu_ps(src + 5 * lds);
+                const __m256 r6 = _mm256_loadu_ps(src + 6 * lds), r7 = _mm256_loadu_ps(src + 7 * lds);
+                const __m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+                const __m256 t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+                const __m256 t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5);
+                const __m256 t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+                const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+                const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+                const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+                const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+                const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+                const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+                const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+                const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+                _mm256_storeu_ps(dst, _mm256_permute2f128_ps(s0, s4, 0x20));
+                _mm256_storeu_ps(dst + ldd, _mm256_permute2f128_ps(s1, s5, 0x20));
+                _mm256_storeu_ps(dst + 2 * ldd, _mm256_permute2f128_ps(s2, s6, 0x20));
+                _mm256_storeu_ps(dst + 3 * ldd, _mm256_permute2f128_ps(s3, s7, 0x20));
+                _mm256_storeu_ps(dst + 4 * ldd, _mm256_permute2f128_ps(s0, s4, 0x31));
+                _mm256_storeu_ps(dst + 5 * ldd, _mm256_permute2f128_ps(s1, s5, 0x31));
+                _mm256_storeu_ps(dst + 6 * ldd, _mm256_permute2f128_ps(s2, s6, 0x31));
+                _mm256_storeu_ps(dst + 7 * ldd, _mm256_permute2f128_ps(s3, s7, 0x31));
+            }
+
+            template <>
+            inline void TransposeBlock8<float>(const float* src, size_t lds, float* dst, size_t ldd) {
+                TransposeBlock8x32(src, lds, dst, ldd);
+            }
+
+            // The shuffles only move bits, so ints go through the float kernel
+            template <>
+            inline void TransposeBlock8<int>(const int* src, size_t lds, int* dst, size_t ldd) {
+                TransposeBlock8x32(reinterpret_cast<const float*>(src), lds, reinterpret_cast<float*>(dst), ldd);
+            }
+#endif
+
+            // dst (cols x rows, leading dimension ldd) = transpose of src (rows x cols, leading dimension lds)
+            template <class T>
+            void Transpose(const T* src, uint rows, uint cols, size_t lds, T* dst, size_t ldd) {
+                for (uint i0 = 0; i0 < rows; i0 += kTile) {
+                    const uint i1 = std::min(rows, i0 + kTile);
+                    for (uint j0 = 0; j0 < cols; j0 += kTile) {
+                        const uint j1 = std::min(cols, j0 + kTile);
+                        uint i = i0;
+                        for (; i + kBlock <= i1; i += kBlock) {
+                            uint j = j0;
+                            for (; j + kBlock <= j1; j += kBlock) {
+                                TransposeBlock8(src + i * lds + j, lds, dst + j * ldd + i, ldd);
+                            }
+                            for (uint r = i; r < i + kBlock; ++r) {
+                                for (uint c = j; c < j1; ++c) {
+                                    dst[c * ldd + r] = src[r * lds + c];
+                                }
+                            }
+                        }
+                        for (; i < i1; ++i) {
+                            for (uint c = j0; c < j1; ++c) {
+                                dst[c * ldd + i] = src[i * lds + c];
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Swaps 8 x 8 blocks (i, j) and (j, i) of a square matrix, transposing both
+            template <class T>
+            inline void SwapBlocks8(T* data, size_t ld, uint i, uint j) {
+                T upper[kBlock * kBlock], lower[kBlock * kBlock];
+                TransposeBlock8(data + i * ld + j, ld, upper, kBlock);
+                TransposeBlock8(data + j * ld + i, ld, lower, kBlock);
+                for (uint r = 0; r < kBlock; ++r) {
+                    std::copy(upper + r * kBlock, upper + (r + 1) * kBlock, data + (j + r) * ld + i);
+                    std::copy(lower + r * kBlock, lower + (r + 1) * kBlock, data + (i + r) * ld + j);
+                }
+            }
+
+            // In-place transpose of an n x n matrix with leading dimension ld
+            template <class T>
+            void TransposeSquare(T* data, uint n, size_t ld) {
+                const uint blocked = n / kBlock * kBlock;
+                for (uint i0 = 0; i0 < blocked; i0 += kTile) {
+                    const uint i1 = std::min(blocked, i0 + kTile);
+                    for (uint j0 = i0; j0 < blocked; j0 += kTile) {
+                        const uint j1 = std::min(blocked, j0 + kTile);
+                        for (uint i = i0; i < i1; i += kBlock) {
+                            for (uint j = std::max(i, j0); j < j1; j += kBlock) {
+                                SwapBlocks8(data, ld, i, j);
+                            }
+                        }
+                    }
+                }
+                // Rows and columns past the last full block
+                for (uint i = 0; i < n; ++i) {
+                    for (uint j = std::max(i + 1, blocked); j < n; ++j) {
+                        std::swap(data[i * ld + j], data[j * ld + i]);
+                    }
+                }
+            }
+        }
+
+        template <class T>
+        Matrix<T> Transpose(const Matrix<T>& matrix) {
+            Matrix<T> result(matrix.cols(), matrix.rows());
+            layout::Transpose(matrix.data(), matrix.rows(), matrix.cols(), matrix.cols(), result.data(), matrix.rows());
+            return result;
+        }
+
+        template <class T>
+        void TransposeInPlace(Matrix<T>& matrix) {
+            if (matrix.rows() != matrix.cols()) {
+                throw std::invalid_argument("in-place transpose needs a square matrix");
+            }
+            layout::TransposeSquare(matrix.data(), matrix.rows(), matrix.cols());
+        }
+
+        // Column-major counterpart of Matrix for consumers that want columns contiguous
+        // (Fortran-style libraries, column-wise kernels). Converts from and to Matrix with
+        // the blocked transpose.
+        template <class T = int>
+        class ColumnMajorMatrix {
+        public:
+            typedef T value_type;
+
+            ColumnMajorMatrix() = default;
+            ColumnMajorMatrix(uint rows, uint cols) : rows_(rows), cols_(cols), data_(static_cast<size_t>(rows) * cols) {}
+            explicit ColumnMajorMatrix(const Matrix<T>& matrix) : ColumnMajorMatrix(matrix.rows(), matrix.cols()) {
+                layout::Transpose(matrix.data(), rows_, cols_, cols_, data_.data(), rows_);
+            }
+
+            uint rows() const { return rows_; }
+            uint cols() const { return cols_; }
+            T& operator()(uint row, uint col) { return col_data(col)[row]; }
+            const T& operator()(uint row, uint col) const { return col_data(col)[row]; }
+            T* data() { return data_.data(); }
+            const T* data() const { return data_.data(); }
+            T* col_data(uint col) { return data_.data() + static_cast<size_t>(col) * rows_; }
+            const T* col_data(uint col) const { return data_.data() + static_cast<size_t>(col) * rows_; }
+
+            MatrixView<T> View() { return MatrixView<T>(data_.data(), rows_, cols_, 1, rows_); }
+            MatrixView<const T> View() const { return MatrixView<const T>(data_.data(), rows_, cols_, 1, rows_); }
+
+            Matrix<T> ToRowMajor() const {
+                Matrix<T> result(rows_, cols_);
+                layout::Transpose(data_.data(), cols_, rows_, rows_, result.data(), cols_);
+                return result;
+            }
+        private:
+            uint rows_ = 0;
+            uint cols_ = 0;
+            std::vector<T> data_;
+        };
+    }
+}
+
+#endif  // !LAYOUT_H_
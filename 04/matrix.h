@@ -2,92 +2,371 @@
 #ifndef MATRIX_H_
 #define MATRIX_H_
 
+#include <algorithm>
+#include <cassert>
 #include <stdexcept>
+#include <utility>
 #include <cstring>
+#include <iostream>
+
+#include "elementwise.h"
+#include "gemm.h"
+#include "matrix_expression.h"
+#include "matrix_view.h"
 
 namespace made {
 
     namespace math {
         typedef unsigned int uint;
 
+        template <class T = int>
         class Matrix {
         private:
             class Row;
         public:
+            typedef T value_type;
+
             Matrix() = default;
-            Matrix(const uint rows, const uint cols) : cols_(cols), rows_(rows), size_(cols*rows) {//, data_(new int[size_]) {
-                data_ = new int[size_];
+            Matrix(const uint rows, const uint cols) : cols_(cols), rows_(rows), size_(cols*rows) {//, data_(new T[size_]) {
+                data_ = new T[size_];
+            }
+            Matrix(const Matrix& copied);
+            // Evaluates an element-wise expression in one pass, see matrix_expression.h
+            template <class E>
+            Matrix(const MatrixExpression<E>& expression) : Matrix(expression.rows(), expression.cols()) {
+                Assign(expression);
             }
+            Matrix(Matrix&& moved) noexcept;
             ~Matrix();
+            Matrix& operator=(const Matrix& copied);
+            Matrix& operator=(Matrix&& moved) noexcept;
+            template <class E>
+            Matrix& operator=(const MatrixExpression<E>& expression) {
+                Assign(expression);
+                return *this;
+            }
+            // Checked in debug builds only, use at() to always check
             Row operator[](uint index);
-            const uint rows() { return rows_; }
-            const uint cols() { return cols_; }
+            uint rows() const { return rows_; }
+            uint cols() const { return cols_; }
+
+            // Unchecked access for inner loops, asserts in debug builds
+            T& operator()(uint row, uint col) {
+                assert(row < rows_ && col < cols_);
+                return row_data(row)[col];
+            }
+            const T& operator()(uint row, uint col) const {
+                assert(row < rows_ && col < cols_);
+                return row_data(row)[col];
+            }
+            T& at(uint row, uint col);
+            const T& at(uint row, uint col) const;
+            T* data() { return data_; }
+            const T* data() const { return data_; }
+            T* row_data(uint row) { return data_ + static_cast<size_t>(row) * cols_; }
+            const T* row_data(uint row) const { return data_ + static_cast<size_t>(row) * cols_; }
+
+            MatrixRef<T> Ref() const { return MatrixRef<T>(data_, rows_, cols_); }
+            MatrixView<T> View() { return MatrixView<T>(data_, rows_, cols_, cols_); }
+            MatrixView<const T> View() const { return MatrixView<const T>(data_, rows_, cols_, cols_); }
+            MatrixView<T> Submatrix(uint row, uint col, uint rows, uint cols) { return View().Submatrix(row, col, rows, cols); }
+            MatrixView<const T> Submatrix(uint row, uint col, uint rows, uint cols) const { return View().Submatrix(row, col, rows, cols); }
+            MatrixView<T> Transposed() { return View().Transposed(); }
+            MatrixView<const T> Transposed() const { return View().Transposed(); }
             void Clear();
-            Matrix& operator*=(const int multiplier);
+            void Fill(const T& value);
+            // Row-major element i = start + i * step
+            void Iota(T start = T(), T step = T(1));
+            Matrix& operator*=(const T multiplier);
+            Matrix& operator+=(const Matrix& rhs);
+            Matrix& operator-=(const Matrix& rhs);
+            template <class E>
+            Matrix& operator+=(const MatrixExpression<E>& rhs) {
+                Assign(Ref() + rhs);
+                return *this;
+            }
+            template <class E>
+            Matrix& operator-=(const MatrixExpression<E>& rhs) {
+                Assign(Ref() - rhs);
+                return *this;
+            }
             //friend bool operator==(const Matrix& lhs, const  Matrix& rhs);
-            bool operator==(const  Matrix& rhs);
-            bool operator!=(const  Matrix& rhs) { return !(*this == rhs); }
+            bool operator==(const  Matrix& rhs) const;
+            bool operator!=(const  Matrix& rhs) const { return !(*this == rhs); }
+            // Same shape and every pair of elements within eps * max(1, |a|, |b|) of each
+            // other, see elementwise::Close. Floating point matrices only.
+            bool ApproxEqual(const Matrix& rhs, T eps) const;
             void Print();
+
+            // Element-wise arithmetic on lvalues is lazy and returns an expression
+            // (matrix_expression.h) evaluated when assigned to a Matrix. An rvalue Matrix
+            // operand lends its buffer instead, so (a + b) * c - d evaluates "- d" in place
+            // in the product's result.
+            friend BinaryExpression<Plus, MatrixRef<T>, MatrixRef<T>> operator+(const Matrix& lhs, const Matrix& rhs) {
+                return lhs.Ref() + rhs.Ref();
+            }
+            template <class E>
+            friend BinaryExpression<Plus, MatrixRef<T>, E> operator+(const Matrix& lhs, const MatrixExpression<E>& rhs) {
+                return lhs.Ref() + rhs;
+            }
+            template <class E>
+            friend BinaryExpression<Plus, E, MatrixRef<T>> operator+(const MatrixExpression<E>& lhs, const Matrix& rhs) {
+                return lhs + rhs.Ref();
+            }
+            friend Matrix operator+(Matrix&& lhs, const Matrix& rhs) { return std::move(lhs += rhs); }
+            friend Matrix operator+(const Matrix& lhs, Matrix&& rhs) { return std::move(rhs += lhs); }
+            friend Matrix operator+(Matrix&& lhs, Matrix&& rhs) { return std::move(lhs += rhs); }
+            template <class E>
+            friend Matrix operator+(Matrix&& lhs, const MatrixExpression<E>& rhs) { return std::move(lhs += rhs); }
+            template <class E>
+            friend Matrix operator+(const MatrixExpression<E>& lhs, Matrix&& rhs) { return std::move(rhs += lhs); }
+
+            friend BinaryExpression<Minus, MatrixRef<T>, MatrixRef<T>> operator-(const Matrix& lhs, const Matrix& rhs) {
+                return lhs.Ref() - rhs.Ref();
+            }
+            template <class E>
+            friend BinaryExpression<Minus, MatrixRef<T>, E> operator-(const Matrix& lhs, const MatrixExpression<E>& rhs) {
+                return lhs.Ref() - rhs;
+            }
+            template <class E>
+            friend BinaryExpression<Minus, E, MatrixRef<T>> operator-(const MatrixExpression<E>& lhs, const Matrix& rhs) {
+                return lhs - rhs.Ref();
+            }
+            friend Matrix operator-(Matrix&& lhs, const Matrix& rhs) { return std::move(lhs -= rhs); }
+            friend Matrix operator-(const Matrix& lhs, Matrix&& rhs) {
+                rhs.Assign(lhs.Ref() - rhs.Ref());
+                return std::move(rhs);
+            }
+            friend Matrix operator-(Matrix&& lhs, Matrix&& rhs) { return std::move(lhs -= rhs); }
+            template <class E>
+            friend Matrix operator-(Matrix&& lhs, const MatrixExpression<E>& rhs) { return std::move(lhs -= rhs); }
+            template <class E>
+            friend Matrix operator-(const MatrixExpression<E>& lhs, Matrix&& rhs) {
+                rhs.Assign(lhs - rhs.Ref());
+                return std::move(rhs);
+            }
+
+            friend ScaledExpression<MatrixRef<T>> operator*(const Matrix& lhs, const T multiplier) {
+                return lhs.Ref() * multiplier;
+            }
+            friend Matrix operator*(Matrix&& lhs, const T multiplier) { return std::move(lhs *= multiplier); }
+
+            // Compares element by element without evaluating the expression into a Matrix
+            template <class E>
+            friend bool operator==(const Matrix& lhs, const MatrixExpression<E>& rhs) { return lhs.Equals(rhs); }
+            template <class E>
+            friend bool operator==(const MatrixExpression<E>& lhs, const Matrix& rhs) { return rhs.Equals(lhs); }
+            template <class E>
+            friend bool operator!=(const Matrix& lhs, const MatrixExpression<E>& rhs) { return !lhs.Equals(rhs); }
+            template <class E>
+            friend bool operator!=(const MatrixExpression<E>& lhs, const Matrix& rhs) { return !rhs.Equals(lhs); }
+
+            // Cache-blocked product, see gemm.h. Always allocates: C can't overlap A or B
+            // while the kernels run
+            friend Matrix operator*(const Matrix& lhs, const Matrix& rhs) {
+                if (lhs.cols_ != rhs.rows_) {
+                    throw std::invalid_argument("matrix dimensions do not match");
+                }
+                Matrix result(lhs.rows_, rhs.cols_);
+                gemm::Multiply(lhs.rows_, rhs.cols_, lhs.cols_, lhs.data_, lhs.cols_, rhs.data_, rhs.cols_, result.data_, result.cols_);
+                return result;
+            }
         private:
-            int *data_ = nullptr;
+            void CheckSameShape(const Matrix& other) const;
+            template <class E>
+            void Assign(const MatrixExpression<E>& expression);
+            template <class E>
+            bool Equals(const MatrixExpression<E>& expression) const;
+
+            T *data_ = nullptr;
             uint rows_ = 0;
             uint cols_ = 0;
             uint size_ = 0;
         };
 
-        Matrix::~Matrix() {
+        template <class T>
+        Matrix<T>::Matrix(Matrix&& moved) noexcept
+            : data_(moved.data_), rows_(moved.rows_), cols_(moved.cols_), size_(moved.size_) {
+            moved.data_ = nullptr;
+            moved.rows_ = moved.cols_ = moved.size_ = 0;
+        }
+
+        template <class T>
+        Matrix<T>::Matrix(const Matrix& copied)
+            : data_(copied.data_ ? new T[copied.size_] : nullptr), rows_(copied.rows_), cols_(copied.cols_), size_(copied.size_) {
+            std::copy(copied.data_, copied.data_ + size_, data_);
+        }
+
+        template <class T>
+        Matrix<T>& Matrix<T>::operator=(const Matrix& copied) {
+            if (this == &copied) {
+                return *this;
+            }
+            // Same number of elements: the existing buffer is reused
+            if (size_ != copied.size_ || !data_) {
+                T* data = copied.data_ ? new T[copied.size_] : nullptr;
+                delete[]data_;
+                data_ = data;
+            }
+            rows_ = copied.rows_;
+            cols_ = copied.cols_;
+            size_ = copied.size_;
+            std::copy(copied.data_, copied.data_ + size_, data_);
+            return *this;
+        }
+
+        template <class T>
+        Matrix<T>& Matrix<T>::operator=(Matrix&& moved) noexcept {
+            if (this != &moved) {
+                delete[]data_;
+                data_ = moved.data_;
+                rows_ = moved.rows_;
+                cols_ = moved.cols_;
+                size_ = moved.size_;
+                moved.data_ = nullptr;
+                moved.rows_ = moved.cols_ = moved.size_ = 0;
+            }
+            return *this;
+        }
+
+        template <class T>
+        Matrix<T>::~Matrix() {
             delete[]data_;
             data_ = nullptr;
         }
 
-        class Matrix::Row {
+        template <class T>
+        class Matrix<T>::Row {
         public:
-            Row(int *data, uint size) : row_(data), size_(size) {}
-            int &operator[](uint index);
+            Row(T *data, uint size) : row_(data), size_(size) {}
+            T &operator[](uint index);
         private:
-            int *row_ = nullptr;
+            T *row_ = nullptr;
             uint size_ = 0;
         };
 
 #pragma region Matrix
-        void Matrix::Clear() {
-            if (data_) {
-                memset(data_, 0, sizeof(int) * size_);
-            }
+        template <class T>
+        void Matrix<T>::Clear() {
+            Fill(T());
         }
 
-        Matrix& Matrix::operator*=(const int multiplier) {
-            for (int *p = data_, *end = data_ + size_; p < end; ++p) {
+        template <class T>
+        void Matrix<T>::Fill(const T& value) {
+            elementwise::Fill(data_, size_, value);
+        }
+
+        template <class T>
+        void Matrix<T>::Iota(T start, T step) {
+            elementwise::Iota(data_, size_, start, step);
+        }
+
+        template <class T>
+        Matrix<T>& Matrix<T>::operator*=(const T multiplier) {
+            for (T *p = data_, *end = data_ + size_; p < end; ++p) {
                 *p *= multiplier;
             }
             return *this;
         }
 
-        inline bool Matrix::operator==(const Matrix & rhs) {
-            bool result = (size_ == rhs.size_);
-            if (result)
-                result = (rows_ == rhs.rows_);
-            if (result) {
-                //result = memcmp(data_, rhs.data_, size_ * sizeof(uint)); // <-- This lies. https://en.cppreference.com/w/cpp/string/byte/memcmp
-                for (uint i = 0; i < rows_; ++i) {
-                    for (uint j = 0; j < cols_; ++j) {
-                        if (data_[i * cols_ + j] != rhs.data_[i * cols_ + j]) {
-                            return false;
-                        }
-                    }
+        template <class T>
+        Matrix<T>& Matrix<T>::operator+=(const Matrix& rhs) {
+            CheckSameShape(rhs);
+            for (uint i = 0; i < size_; ++i) {
+                data_[i] += rhs.data_[i];
+            }
+            return *this;
+        }
+
+        template <class T>
+        Matrix<T>& Matrix<T>::operator-=(const Matrix& rhs) {
+            CheckSameShape(rhs);
+            for (uint i = 0; i < size_; ++i) {
+                data_[i] -= rhs.data_[i];
+            }
+            return *this;
+        }
+
+        // Reads of element i only ever precede the write of element i, so the expression
+        // may refer to this matrix itself
+        template <class T>
+        template <class E>
+        void Matrix<T>::Assign(const MatrixExpression<E>& expression) {
+            const E& source = expression.self();
+            if (!data_ || rows_ != source.rows() || cols_ != source.cols()) {
+                Matrix result(source.rows(), source.cols());
+                result.Assign(expression);
+                *this = std::move(result);
+                return;
+            }
+            T* data = data_;
+            const size_t size = size_;
+            for (size_t i = 0; i < size; ++i) {
+                data[i] = source[i];
+            }
+        }
+
+        template <class T>
+        template <class E>
+        bool Matrix<T>::Equals(const MatrixExpression<E>& expression) const {
+            const E& source = expression.self();
+            if (rows_ != source.rows() || cols_ != source.cols()) {
+                return false;
+            }
+            for (size_t i = 0; i < size_; ++i) {
+                if (data_[i] != source[i]) {
+                    return false;
                 }
             }
-            return result;
+            return true;
+        }
+
+        template <class T>
+        void Matrix<T>::CheckSameShape(const Matrix& other) const {
+            if (rows_ != other.rows_ || cols_ != other.cols_) {
+                throw std::invalid_argument("matrix dimensions do not match");
+            }
+        }
+
+        template <class T>
+        inline bool Matrix<T>::operator==(const Matrix & rhs) const {
+            // Not memcmp: float +0 == -0 and NaN != NaN
+            return rows_ == rhs.rows_ && cols_ == rhs.cols_ && elementwise::Equal(data_, rhs.data_, size_);
+        }
+
+        template <class T>
+        bool Matrix<T>::ApproxEqual(const Matrix& rhs, T eps) const {
+            return rows_ == rhs.rows_ && cols_ == rhs.cols_ && elementwise::ApproxEqual(data_, rhs.data_, size_, eps);
         }
 
-        Matrix::Row Matrix::operator[](uint index) {
+        template <class T>
+        typename Matrix<T>::Row Matrix<T>::operator[](uint index) {
+#ifndef NDEBUG
             if (index >= rows_) {
                 throw std::out_of_range("");
             }
+#endif
             return Row(&data_[index * cols_], cols_);
         }
 
-        void Matrix::Print() {
+        template <class T>
+        T& Matrix<T>::at(uint row, uint col) {
+            if (row >= rows_ || col >= cols_) {
+                throw std::out_of_range("");
+            }
+            return data_[row * cols_ + col];
+        }
+
+        template <class T>
+        const T& Matrix<T>::at(uint row, uint col) const {
+            if (row >= rows_ || col >= cols_) {
+                throw std::out_of_range("");
+            }
+            return data_[row * cols_ + col];
+        }
+
+        template <class T>
+        void Matrix<T>::Print() {
             std::cout << std::endl;
             for (uint i = 0; i < rows_; ++i) {
                 for (uint j = 0; j < cols_; ++j) {
@@ -99,10 +378,13 @@ namespace made {
 #pragma endregion
 
 #pragma region Row
-        int& Matrix::Row::operator[](uint index) {
+        template <class T>
+        T& Matrix<T>::Row::operator[](uint index) {
+#ifndef NDEBUG
             if (index >= size_) {
                 throw std::out_of_range("");
             }
+#endif
             return row_[index];
         }
 #pragma endregion
@@ -110,4 +392,4 @@ namespace made {
     }
 }
 
-#endif  // !MATRIX_H_
\ No newline at end of file
+#endif  // !MATRIX_H_
@@ -0,0 +1,101 @@
+#pragma once
+#ifndef MATRIX_EXPRESSION_H_
+#define MATRIX_EXPRESSION_H_
+
+#include <cstddef>
+#include <stdexcept>
+
+namespace made {
+
+    namespace math {
+        typedef unsigned int uint;
+
+        // Lazy element-wise arithmetic. a + b * 2 - c builds a tree of small nodes
+        // instead of temporaries; assigning it to a Matrix evaluates every element in
+        // one loop straight into the destination buffer. Nodes hold matrices by pointer
+        // and subexpressions by value, so an expression must not outlive its operands:
+        // assign it to a Matrix rather than keeping it in an `auto` variable.
+        template <class E>
+        class MatrixExpression {
+        public:
+            const E& self() const { return static_cast<const E&>(*this); }
+            uint rows() const { return self().rows(); }
+            uint cols() const { return self().cols(); }
+        };
+
+        // Leaf referring to the elements of a Matrix
+        template <class T>
+        class MatrixRef : public MatrixExpression<MatrixRef<T>> {
+        public:
+            typedef T value_type;
+
+            MatrixRef(const T* data, uint rows, uint cols) : data_(data), rows_(rows), cols_(cols) {}
+            uint rows() const { return rows_; }
+            uint cols() const { return cols_; }
+            T operator[](size_t index) const { return data_[index]; }
+        private:
+            const T* data_;
+            uint rows_;
+            uint cols_;
+        };
+
+        struct Plus {
+            template <class T>
+            static T Apply(T lhs, T rhs) { return lhs + rhs; }
+        };
+
+        struct Minus {
+            template <class T>
+            static T Apply(T lhs, T rhs) { return lhs - rhs; }
+        };
+
+        template <class Op, class L, class R>
+        class BinaryExpression : public MatrixExpression<BinaryExpression<Op, L, R>> {
+        public:
+            typedef typename L::value_type value_type;
+
+            BinaryExpression(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {
+                if (lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols()) {
+                    throw std::invalid_argument("matrix dimensions do not match");
+                }
+            }
+            uint rows() const { return lhs_.rows(); }
+            uint cols() const { return lhs_.cols(); }
+            value_type operator[](size_t index) const { return Op::Apply(lhs_[index], rhs_[index]); }
+        private:
+            const L lhs_;
+            const R rhs_;
+        };
+
+        template <class E>
+        class ScaledExpression : public MatrixExpression<ScaledExpression<E>> {
+        public:
+            typedef typename E::value_type value_type;
+
+            ScaledExpression(const E& expression, value_type multiplier) : expression_(expression), multiplier_(multiplier) {}
+            uint rows() const { return expression_.rows(); }
+            uint cols() const { return expression_.cols(); }
+            value_type operator[](size_t index) const { return expression_[index] * multiplier_; }
+        private:
+            const E expression_;
+            const value_type multiplier_;
+        };
+
+        template <class L, class R>
+        BinaryExpression<Plus, L, R> operator+(const MatrixExpression<L>& lhs, const MatrixExpression<R>& rhs) {
+            return BinaryExpression<Plus, L, R>(lhs.self(), rhs.self());
+        }
+
+        template <class L, class R>
+        BinaryExpression<Minus, L, R> operator-(const MatrixExpression<L>& lhs, const MatrixExpression<R>& rhs) {
+            return BinaryExpression<Minus, L, R>(lhs.self(), rhs.self());
+        }
+
+        template <class E>
+        ScaledExpression<E> operator*(const MatrixExpression<E>& expression, const typename E::value_type multiplier) {
+            return ScaledExpression<E>(expression.self(), multiplier);
+        }
+    }
+}
+
+#endif  // !MATRIX_EXPRESSION_H_
@@ -0,0 +1,301 @@
+#pragma once
+#ifndef MATRIX_IO_H_
+#define MATRIX_IO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "matrix.h"
+
+namespace made {
+
+    namespace math {
+
+        // Binary matrix files: a 64-byte header followed by rows * cols row-major
+        // elements at data_offset (64-aligned, so an mmap'd file is ready for SIMD loads).
+        // Integers are in the byte order of the writer; readers check byte_order.
+        namespace io {
+            enum class DType : std::uint32_t {
+                Int32 = 1,
+                UInt32 = 2,
+                Int64 = 3,
+                Float32 = 4,
+                Float64 = 5,
+            };
+
+            template <class T>
+            struct DTypeOf;
+            template <> struct DTypeOf<std::int32_t> { static constexpr DType value = DType::Int32; };
+            template <> struct DTypeOf<std::uint32_t> { static constexpr DType value = DType::UInt32; };
+            template <> struct DTypeOf<std::int64_t> { static constexpr DType value = DType::Int64; };
+            template <> struct DTypeOf<float> { static constexpr DType value = DType::Float32; };
+            template <> struct DTypeOf<double> { static constexpr DType value = DType::Float64; };
+
+            const char kMagic[8] = { 'M', 'A', 'D', 'E', 'M', 'A', 'T', '\0' };
+            const std::uint32_t kByteOrder = 0x01020304;
+            const std::uint64_t kDataOffset = 64;
+
+            struct FileHeader {
+                char magic[8];
+                std::uint32_t byte_order;
+                std::uint32_t dtype;
+                std::uint64_t rows;
+                std::uint64_t cols;
+                std::uint64_t data_offset;
+                char reserved[24];
+            };
+            static_assert(sizeof(FileHeader) == kDataOffset, "FileHeader must fill the data offset");
+
+            template <class T>
+            FileHeader MakeHeader(uint rows, uint cols) {
+                FileHeader header = {};
+                std::memcpy(header.magic, kMagic, sizeof(kMagic));
+                header.byte_order = kByteOrder;
+                header.dtype = static_cast<std::uint32_t>(DTypeOf<T>::value);
+                header.rows = rows;
+                header.cols = cols;
+                header.data_offset = kDataOffset;
+                return header;
+            }
+
+            // Throws std::runtime_error unless the header describes a T matrix whose data
+            // fits in file_size bytes and whose size fits in uint, as Matrix counts in it
+            template <class T>
+            void CheckHeader(const FileHeader& header, std::uint64_t file_size) {
+                if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+                    throw std::runtime_error("not a matrix file");
+                }
+                if (header.byte_order != kByteOrder) {
+                    throw std::runtime_error("matrix file has a different byte order");
+                }
+                if (header.dtype != static_cast<std::uint32_t>(DTypeOf<T>::value)) {
+                    throw std::runtime_error("matrix file has a different element type");
+                }
+                if (header.rows > std::numeric_limits<uint>::max() || header.cols > std::numeric_limits<uint>::max()
+                    || header.rows * header.cols > std::numeric_limits<uint>::max()
+                    || header.data_offset < sizeof(FileHeader) || header.data_offset % alignof(T) != 0) {
+                    throw std::runtime_error("corrupted matrix file header");
+                }
+                if (file_size < header.data_offset || (file_size - header.data_offset) / sizeof(T) < header.rows * header.cols) {
+                    throw std::runtime_error("matrix file is truncated");
+                }
+            }
+
+            // Read-only memory mapping of a whole file
+            class MappedFile {
+            public:
+                explicit MappedFile(const std::string& path);
+                ~MappedFile();
+                MappedFile(const MappedFile&) = delete;
+                MappedFile& operator=(const MappedFile&) = delete;
+                MappedFile(MappedFile&& moved) noexcept : data_(moved.data_), size_(moved.size_) {
+                    moved.data_ = nullptr;
+                    moved.size_ = 0;
+                }
+
+                const char* data() const { return data_; }
+                std::uint64_t size() const { return size_; }
+            private:
+                const char* data_ = nullptr;
+                std::uint64_t size_ = 0;
+            };
+
+#if defined(_WIN32)
+            inline MappedFile::MappedFile(const std::string& path) {
+                HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (file == INVALID_HANDLE_VALUE) {
+                    throw std::runtime_error("cannot open " + path);
+                }
+                LARGE_INTEGER size;
+                GetFileSizeEx(file, &size);
+                size_ = static_cast<std::uint64_t>(size.QuadPart);
+                if (size_ > 0) {
+                    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                    if (mapping) {
+                        data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                        CloseHandle(mapping);
+                    }
+                }
+                CloseHandle(file);
+                if (size_ > 0 && !data_) {
+                    throw std::runtime_error("cannot map " + path);
+                }
+            }
+
+            inline MappedFile::~MappedFile() {
+                if (data_) {
+                    UnmapViewOfFile(data_);
+                }
+            }
+#else
+            inline MappedFile::MappedFile(const std::string& path) {
+                const int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    throw std::runtime_error("cannot open " + path);
+                }
+                struct stat status;
+                if (::fstat(fd, &status) != 0) {
+                    ::close(fd);
+                    throw std::runtime_error("cannot stat " + path);
+                }
+                size_ = static_cast<std::uint64_t>(status.st_size);
+                if (size_ > 0) {
+                    void* address = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+                    if (address == MAP_FAILED) {
+                        ::close(fd);
+                        throw std::runtime_error("cannot map " + path);
+                    }
+                    data_ = static_cast<const char*>(address);
+                }
+                ::close(fd);
+            }
+
+            inline MappedFile::~MappedFile() {
+                if (data_) {
+                    ::munmap(const_cast<char*>(data_), size_);
+                }
+            }
+#endif
+        }
+
+        // Matrix file opened through mmap: elements are read straight from the page cache,
+        // nothing is copied and only the pages actually touched are loaded
+        template <class T>
+        class MappedMatrix {
+        public:
+            explicit MappedMatrix(const std::string& path) : file_(path) {
+                io::FileHeader header;
+                if (file_.size() < sizeof(header)) {
+                    throw std::runtime_error("matrix file is truncated");
+                }
+                std::memcpy(&header, file_.data(), sizeof(header));
+                io::CheckHeader<T>(header, file_.size());
+                rows_ = static_cast<uint>(header.rows);
+                cols_ = static_cast<uint>(header.cols);
+                data_ = reinterpret_cast<const T*>(file_.data() + header.data_offset);
+            }
+
+            uint rows() const { return rows_; }
+            uint cols() const { return cols_; }
+            const T* data() const { return data_; }
+            const T* row_data(uint row) const { return data_ + static_cast<size_t>(row) * cols_; }
+            const T& operator()(uint row, uint col) const { return row_data(row)[col]; }
+            MatrixView<const T> View() const { return MatrixView<const T>(data_, rows_, cols_, cols_); }
+        private:
+            io::MappedFile file_;
+            const T* data_ = nullptr;
+            uint rows_ = 0;
+            uint cols_ = 0;
+        };
+
+        // Writes a matrix file piece by piece, e.g. row by row as rows are produced,
+        // without holding the whole matrix in memory
+        template <class T>
+        class MatrixWriter {
+        public:
+            MatrixWriter(const std::string& path, uint rows, uint cols);
+            ~MatrixWriter();
+
+            void Write(const T* values, size_t count);
+            void WriteRow(const T* row) { Write(row, cols_); }
+            // Throws std::runtime_error if fewer than rows * cols elements were written
+            // or the data did not reach the disk
+            void Close();
+        private:
+            std::ofstream stream_;
+            uint cols_;
+            std::uint64_t remaining_;
+        };
+
+        template <class T>
+        MatrixWriter<T>::MatrixWriter(const std::string& path, uint rows, uint cols)
+            : stream_(path, std::ios::binary | std::ios::trunc), cols_(cols), remaining_(static_cast<std::uint64_t>(rows) * cols) {
+            if (!stream_) {
+                throw std::runtime_error("cannot create " + path);
+            }
+            const io::FileHeader header = io::MakeHeader<T>(rows, cols);
+            stream_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        template <class T>
+        MatrixWriter<T>::~MatrixWriter() {
+            if (stream_.is_open()) {
+                stream_.close();
+            }
+        }
+
+        template <class T>
+        void MatrixWriter<T>::Write(const T* values, size_t count) {
+            if (count > remaining_) {
+                throw std::out_of_range("more elements than the matrix holds");
+            }
+            stream_.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+            remaining_ -= count;
+            if (!stream_) {
+                throw std::runtime_error("matrix file write failed");
+            }
+        }
+
+        template <class T>
+        void MatrixWriter<T>::Close() {
+            if (remaining_ != 0) {
+                stream_.close();
+                throw std::runtime_error("matrix file is incomplete");
+            }
+            stream_.close();
+            if (stream_.fail()) {
+                throw std::runtime_error("matrix file write failed");
+            }
+        }
+
+        template <class T>
+        void Save(const Matrix<T>& matrix, const std::string& path) {
+            MatrixWriter<T> writer(path, matrix.rows(), matrix.cols());
+            writer.Write(matrix.data(), static_cast<size_t>(matrix.rows()) * matrix.cols());
+            writer.Close();
+        }
+
+        // Reads a whole matrix file into memory
+        template <class T>
+        Matrix<T> Load(const std::string& path) {
+            std::ifstream stream(path, std::ios::binary | std::ios::ate);
+            if (!stream) {
+                throw std::runtime_error("cannot open " + path);
+            }
+            const std::uint64_t file_size = static_cast<std::uint64_t>(stream.tellg());
+            io::FileHeader header;
+            stream.seekg(0);
+            if (file_size < sizeof(header) || !stream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+                throw std::runtime_error("matrix file is truncated");
+            }
+            io::CheckHeader<T>(header, file_size);
+            Matrix<T> matrix(static_cast<uint>(header.rows), static_cast<uint>(header.cols));
+            stream.seekg(static_cast<std::streamoff>(header.data_offset));
+            stream.read(reinterpret_cast<char*>(matrix.data()), static_cast<std::streamsize>(header.rows * header.cols * sizeof(T)));
+            if (!stream) {
+                throw std::runtime_error("matrix file read failed");
+            }
+            return matrix;
+        }
+    }
+}
+
+#endif  // !MATRIX_IO_H_
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef MATRIX_VIEW_H_
+#define MATRIX_VIEW_H_
+
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace made {
+
+    namespace math {
+        typedef unsigned int uint;
+
+        // Non-owning window into matrix elements: element (i, j) lives at
+        // data[i * row_stride + j * col_stride], so submatrices and transposes are
+        // just other strides over the same memory. Element access is unchecked,
+        // debug builds assert on it.
+        template <class T>
+        class MatrixView {
+            template <class U>
+            friend class MatrixView;
+        public:
+            typedef typename std::remove_const<T>::type value_type;
+
+            MatrixView() = default;
+            MatrixView(T* data, uint rows, uint cols, uint row_stride, uint col_stride = 1)
+                : data_(data), rows_(rows), cols_(cols), row_stride_(row_stride), col_stride_(col_stride) {}
+            // MatrixView<T> converts to MatrixView<const T>
+            template <class U, class = typename std::enable_if<std::is_same<const U, T>::value>::type>
+            MatrixView(const MatrixView<U>& other)
+                : data_(other.data_), rows_(other.rows_), cols_(other.cols_), row_stride_(other.row_stride_), col_stride_(other.col_stride_) {}
+
+            uint rows() const { return rows_; }
+            uint cols() const { return cols_; }
+            uint row_stride() const { return row_stride_; }
+            uint col_stride() const { return col_stride_; }
+            T* data() const { return data_; }
+            bool contiguous_rows() const { return col_stride_ == 1; }
+            // First element of a row; the row is a plain array when contiguous_rows()
+            T* row_data(uint row) const { return data_ + static_cast<size_t>(row) * row_stride_; }
+
+            T& operator()(uint row, uint col) const {
+                assert(row < rows_ && col < cols_);
+                // size_t offsets: a wrapping uint index would keep the compiler from vectorizing
+                return data_[static_cast<size_t>(row) * row_stride_ + static_cast<size_t>(col) * col_stride_];
+            }
+            T& at(uint row, uint col) const;
+
+            MatrixView Submatrix(uint row, uint col, uint rows, uint cols) const;
+            MatrixView Transposed() const { return MatrixView(data_, cols_, rows_, col_stride_, row_stride_); }
+        private:
+            T* data_ = nullptr;
+            uint rows_ = 0;
+            uint cols_ = 0;
+            uint row_stride_ = 0;
+            uint col_stride_ = 1;
+        };
+
+        template <class T>
+        T& MatrixView<T>::at(uint row, uint col) const {
+            if (row >= rows_ || col >= cols_) {
+                throw std::out_of_range("");
+            }
+            return (*this)(row, col);
+        }
+
+        template <class T>
+        MatrixView<T> MatrixView<T>::Submatrix(uint row, uint col, uint rows, uint cols) const {
+            if (row > rows_ || rows > rows_ - row || col > cols_ || cols > cols_ - col) {
+                throw std::out_of_range("submatrix is out of range");
+            }
+            return MatrixView(data_ + static_cast<size_t>(row) * row_stride_ + static_cast<size_t>(col) * col_stride_, rows, cols, row_stride_, col_stride_);
+        }
+    }
+}
+
+#endif  // !MATRIX_VIEW_H_
@@ -0,0 +1,190 @@
+#pragma once
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "layout.h"
+#include "matrix.h"
+#include "thread_pool.h"
+
+namespace made {
+
+    namespace math {
+
+        // Multi-threaded Matrix kernels on a ThreadPool, split into row or element blocks.
+        // Reductions use blocks of a fixed size, so floating point results are the same
+        // for any number of threads.
+        namespace parallel {
+            const uint kElementGrain = 1 << 16;
+            const uint kRowGrain = 64;
+
+            // Block size giving every thread a few blocks to balance load, but never fewer
+            // than `minimum` indices; a multiple of `multiple`
+            inline uint Grain(const ThreadPool& pool, uint count, uint minimum, uint multiple) {
+                const uint blocks = pool.size() * 4;
+                uint grain = std::max(minimum, (count + blocks - 1) / blocks);
+                return (grain + multiple - 1) / multiple * multiple;
+            }
+
+            // Reduces every kElementGrain block with `block(begin, end)` into its own slot,
+            // then folds the slots in order with `combine`
+            template <class R, class Block, class Combine>
+            R Reduce(ThreadPool& pool, uint count, R init, Block block, Combine combine) {
+                std::vector<R> partials((count + kElementGrain - 1) / kElementGrain, init);
+                pool.ParallelFor(count, kElementGrain, [&](uint begin, uint end) {
+                    partials[begin / kElementGrain] = block(begin, end);
+                });
+                R result = init;
+                for (const R& partial : partials) {
+                    result = combine(result, partial);
+                }
+                return result;
+            }
+
+            // Row blocks of C = A * B, each multiplied by the cache-blocked kernel of gemm.h
+            template <class T>
+            Matrix<T> Multiply(ThreadPool& pool, const Matrix<T>& lhs, const Matrix<T>& rhs) {
+                if (lhs.cols() != rhs.rows()) {
+                    throw std::invalid_argument("matrix dimensions do not match");
+                }
+                const uint m = lhs.rows(), n = rhs.cols(), k = lhs.cols();
+                Matrix<T> result(m, n);
+                const uint grain = Grain(pool, m, gemm::Blocking<T>::MR * 4, gemm::Blocking<T>::MR);
+                pool.ParallelFor(m, grain, [&](uint begin, uint end) {
+                    gemm::Multiply(end - begin, n, k, lhs.row_data(begin), k, rhs.data(), n, result.row_data(begin), n);
+                });
+                return result;
+            }
+
+            // destination = expression, evaluated by element blocks
+            template <class T, class E>
+            void Assign(ThreadPool& pool, Matrix<T>& destination, const MatrixExpression<E>& expression) {
+                const E& source = expression.self();
+                if (destination.rows() != source.rows() || destination.cols() != source.cols() || !destination.data()) {
+                    destination = Matrix<T>(source.rows(), source.cols());
+                }
+                T* data = destination.data();
+                pool.ParallelFor(source.rows() * source.cols(), kElementGrain, [&](uint begin, uint end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        data[i] = source[i];
+                    }
+                });
+            }
+
+            template <class E>
+            Matrix<typename E::value_type> Evaluate(ThreadPool& pool, const MatrixExpression<E>& expression) {
+                Matrix<typename E::value_type> result(expression.rows(), expression.cols());
+                Assign(pool, result, expression);
+                return result;
+            }
+
+            // Row blocks of the source per job, each transposed by the tiled kernel of layout.h
+            template <class T>
+            Matrix<T> Transpose(ThreadPool& pool, const Matrix<T>& matrix) {
+                const uint rows = matrix.rows(), cols = matrix.cols();
+                Matrix<T> result(cols, rows);
+                pool.ParallelFor(rows, Grain(pool, rows, layout::kTile, layout::kTile), [&](uint begin, uint end) {
+                    layout::Transpose(matrix.row_data(begin), end - begin, cols, cols, result.data() + begin, rows);
+                });
+                return result;
+            }
+
+            template <class T>
+            T Sum(ThreadPool& pool, const Matrix<T>& matrix) {
+                const T* data = matrix.data();
+                return Reduce(pool, matrix.rows() * matrix.cols(), T(), [data](uint begin, uint end) {
+                    T sum = T();
+                    for (size_t i = begin; i < end; ++i) {
+                        sum += data[i];
+                    }
+                    return sum;
+                }, [](T lhs, T rhs) { return lhs + rhs; });
+            }
+
+            template <class T>
+            T Min(ThreadPool& pool, const Matrix<T>& matrix) {
+                if (matrix.rows() == 0 || matrix.cols() == 0) {
+                    throw std::invalid_argument("empty matrix");
+                }
+                const T* data = matrix.data();
+                return Reduce(pool, matrix.rows() * matrix.cols(), data[0], [data](uint begin, uint end) {
+                    return *std::min_element(data + begin, data + end);
+                }, [](T lhs, T rhs) { return std::min(lhs, rhs); });
+            }
+
+            template <class T>
+            T Max(ThreadPool& pool, const Matrix<T>& matrix) {
+                if (matrix.rows() == 0 || matrix.cols() == 0) {
+                    throw std::invalid_argument("empty matrix");
+                }
+                const T* data = matrix.data();
+                return Reduce(pool, matrix.rows() * matrix.cols(), data[0], [data](uint begin, uint end) {
+                    return *std::max_element(data + begin, data + end);
+                }, [](T lhs, T rhs) { return std::max(lhs, rhs); });
+            }
+
+            // sqrt of the sum of squared elements
+            template <class T>
+            double FrobeniusNorm(ThreadPool& pool, const Matrix<T>& matrix) {
+                const T* data = matrix.data();
+                return std::sqrt(Reduce(pool, matrix.rows() * matrix.cols(), 0.0, [data](uint begin, uint end) {
+                    double sum = 0;
+                    for (size_t i = begin; i < end; ++i) {
+                        const double value = static_cast<double>(data[i]);
+                        sum += value * value;
+                    }
+                    return sum;
+                }, [](double lhs, double rhs) { return lhs + rhs; }));
+            }
+
+            // Largest absolute row sum
+            template <class T>
+            double NormInf(ThreadPool& pool, const Matrix<T>& matrix) {
+                const uint rows = matrix.rows(), cols = matrix.cols();
+                std::vector<double> row_sums(rows);
+                pool.ParallelFor(rows, kRowGrain, [&](uint begin, uint end) {
+                    for (uint i = begin; i < end; ++i) {
+                        const T* row = matrix.row_data(i);
+                        double sum = 0;
+                        for (uint j = 0; j < cols; ++j) {
+                            sum += std::abs(static_cast<double>(row[j]));
+                        }
+                        row_sums[i] = sum;
+                    }
+                });
+                return rows ? *std::max_element(row_sums.begin(), row_sums.end()) : 0.0;
+            }
+
+            // Largest absolute column sum; every job sums a block of rows into its own
+            // column vector
+            template <class T>
+            double Norm1(ThreadPool& pool, const Matrix<T>& matrix) {
+                const uint rows = matrix.rows(), cols = matrix.cols();
+                const uint grain = kRowGrain;
+                std::vector<std::vector<double>> partials(rows ? (rows + grain - 1) / grain : 0, std::vector<double>(cols));
+                pool.ParallelFor(rows, grain, [&](uint begin, uint end) {
+                    std::vector<double>& sums = partials[begin / grain];
+                    for (uint i = begin; i < end; ++i) {
+                        const T* row = matrix.row_data(i);
+                        for (uint j = 0; j < cols; ++j) {
+                            sums[j] += std::abs(static_cast<double>(row[j]));
+                        }
+                    }
+                });
+                std::vector<double> column_sums(cols);
+                for (const auto& sums : partials) {
+                    for (uint j = 0; j < cols; ++j) {
+                        column_sums[j] += sums[j];
+                    }
+                }
+                return cols ? *std::max_element(column_sums.begin(), column_sums.end()) : 0.0;
+            }
+        }
+    }
+}
+
+#endif  // !PARALLEL_H_
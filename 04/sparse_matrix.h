@@ -0,0 +1,358 @@
+#pragma once
+#ifndef SPARSE_MATRIX_H_
+#define SPARSE_MATRIX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "matrix.h"
+#include "thread_pool.h"
+
+namespace made {
+
+    namespace math {
+
+        // Coordinate (COO) entry
+        template <class T>
+        struct Triplet {
+            uint row;
+            uint col;
+            T value;
+        };
+
+        template <class T>
+        class CscMatrix;
+
+        // Compressed sparse rows: the nonzeros of row i are values_[offsets_[i] .. offsets_[i + 1])
+        // with their columns in indices_, sorted by column. Products go row by row, so the
+        // rows of the result can be computed in parallel.
+        template <class T = int>
+        class CsrMatrix {
+        public:
+            typedef T value_type;
+
+            CsrMatrix() = default;
+            // Duplicate coordinates are summed, out-of-range ones throw std::out_of_range
+            CsrMatrix(uint rows, uint cols, std::vector<Triplet<T>> triplets);
+            // Keeps the elements that are not equal to T()
+            explicit CsrMatrix(const Matrix<T>& dense);
+            explicit CsrMatrix(const CscMatrix<T>& csc);
+
+            uint rows() const { return rows_; }
+            uint cols() const { return cols_; }
+            size_t nonzeros() const { return values_.size(); }
+            const std::vector<size_t>& offsets() const { return offsets_; }
+            const std::vector<uint>& indices() const { return indices_; }
+            const std::vector<T>& values() const { return values_; }
+
+            Matrix<T> ToDense() const;
+
+            // y[begin .. end) = rows [begin, end) of A * x
+            void MultiplyRows(uint begin, uint end, const T* x, T* y) const;
+            // The same rows of A * dense, written into result
+            void MultiplyRows(uint begin, uint end, const Matrix<T>& dense, Matrix<T>& result) const;
+
+            std::vector<T> operator*(const std::vector<T>& x) const;
+            Matrix<T> operator*(const Matrix<T>& dense) const;
+        private:
+            friend class CscMatrix<T>;
+
+            uint rows_ = 0;
+            uint cols_ = 0;
+            std::vector<size_t> offsets_ = std::vector<size_t>(1);
+            std::vector<uint> indices_;
+            std::vector<T> values_;
+        };
+
+        // Compressed sparse columns: the nonzeros of column j are values_[offsets_[j] .. offsets_[j + 1])
+        // with their rows in indices_, sorted by row. Products scatter column by column.
+        template <class T = int>
+        class CscMatrix {
+        public:
+            typedef T value_type;
+
+            CscMatrix() = default;
+            CscMatrix(uint rows, uint cols, std::vector<Triplet<T>> triplets);
+            explicit CscMatrix(const Matrix<T>& dense);
+            explicit CscMatrix(const CsrMatrix<T>& csr);
+
+            uint rows() const { return rows_; }
+            uint cols() const { return cols_; }
+            size_t nonzeros() const { return values_.size(); }
+            const std::vector<size_t>& offsets() const { return offsets_; }
+            const std::vector<uint>& indices() const { return indices_; }
+            const std::vector<T>& values() const { return values_; }
+
+            Matrix<T> ToDense() const;
+
+            std::vector<T> operator*(const std::vector<T>& x) const;
+            Matrix<T> operator*(const Matrix<T>& dense) const;
+        private:
+            friend class CsrMatrix<T>;
+
+            uint rows_ = 0;
+            uint cols_ = 0;
+            std::vector<size_t> offsets_ = std::vector<size_t>(1);
+            std::vector<uint> indices_;
+            std::vector<T> values_;
+        };
+
+        namespace sparse {
+            // Compresses triplets into offsets / indices / values along the major
+            // dimension: sorts by (major, minor) and sums duplicates
+            template <class T, class Major, class Minor>
+            void Compress(uint majors, std::vector<Triplet<T>>& triplets, Major major, Minor minor,
+                std::vector<size_t>& offsets, std::vector<uint>& indices, std::vector<T>& values) {
+                std::sort(triplets.begin(), triplets.end(), [&](const Triplet<T>& lhs, const Triplet<T>& rhs) {
+                    return major(lhs) != major(rhs) ? major(lhs) < major(rhs) : minor(lhs) < minor(rhs);
+                });
+                offsets.assign(static_cast<size_t>(majors) + 1, 0);
+                indices.clear();
+                values.clear();
+                for (size_t i = 0; i < triplets.size(); ++i) {
+                    const Triplet<T>& triplet = triplets[i];
+                    if (i > 0 && major(triplet) == major(triplets[i - 1]) && minor(triplet) == minor(triplets[i - 1])) {
+                        values.back() += triplet.value;
+                        continue;
+                    }
+                    ++offsets[major(triplet) + 1];
+                    indices.push_back(minor(triplet));
+                    values.push_back(triplet.value);
+                }
+                for (uint i = 0; i < majors; ++i) {
+                    offsets[i + 1] += offsets[i];
+                }
+            }
+
+            // Re-compresses along the other dimension with a counting sort (CSR <-> CSC)
+            template <class T>
+            void Transpose(uint majors, uint minors, const std::vector<size_t>& offsets, const std::vector<uint>& indices,
+                const std::vector<T>& values, std::vector<size_t>& out_offsets, std::vector<uint>& out_indices, std::vector<T>& out_values) {
+                out_offsets.assign(static_cast<size_t>(minors) + 1, 0);
+                out_indices.resize(indices.size());
+                out_values.resize(values.size());
+                for (uint index : indices) {
+                    ++out_offsets[index + 1];
+                }
+                for (uint i = 0; i < minors; ++i) {
+                    out_offsets[i + 1] += out_offsets[i];
+                }
+                std::vector<size_t> cursor(out_offsets.begin(), out_offsets.end() - 1);
+                for (uint major = 0; major < majors; ++major) {
+                    for (size_t k = offsets[major]; k < offsets[major + 1]; ++k) {
+                        const size_t position = cursor[indices[k]]++;
+                        out_indices[position] = major;
+                        out_values[position] = values[k];
+                    }
+                }
+            }
+
+            template <class T>
+            void CheckTriplets(uint rows, uint cols, const std::vector<Triplet<T>>& triplets) {
+                for (const Triplet<T>& triplet : triplets) {
+                    if (triplet.row >= rows || triplet.col >= cols) {
+                        throw std::out_of_range("triplet is out of range");
+                    }
+                }
+            }
+        }
+
+#pragma region CsrMatrix
+        template <class T>
+        CsrMatrix<T>::CsrMatrix(uint rows, uint cols, std::vector<Triplet<T>> triplets) : rows_(rows), cols_(cols) {
+            sparse::CheckTriplets(rows, cols, triplets);
+            sparse::Compress(rows, triplets, [](const Triplet<T>& t) { return t.row; }, [](const Triplet<T>& t) { return t.col; },
+                offsets_, indices_, values_);
+        }
+
+        template <class T>
+        CsrMatrix<T>::CsrMatrix(const Matrix<T>& dense) : rows_(dense.rows()), cols_(dense.cols()) {
+            offsets_.assign(static_cast<size_t>(rows_) + 1, 0);
+            for (uint i = 0; i < rows_; ++i) {
+                const T* row = dense.row_data(i);
+                for (uint j = 0; j < cols_; ++j) {
+                    if (row[j] != T()) {
+                        indices_.push_back(j);
+                        values_.push_back(row[j]);
+                    }
+                }
+                offsets_[i + 1] = values_.size();
+            }
+        }
+
+        template <class T>
+        CsrMatrix<T>::CsrMatrix(const CscMatrix<T>& csc) : rows_(csc.rows_), cols_(csc.cols_) {
+            sparse::Transpose(csc.cols_, csc.rows_, csc.offsets_, csc.indices_, csc.values_, offsets_, indices_, values_);
+        }
+
+        template <class T>
+        Matrix<T> CsrMatrix<T>::ToDense() const {
+            Matrix<T> dense(rows_, cols_);
+            dense.Clear();
+            for (uint i = 0; i < rows_; ++i) {
+                T* row = dense.row_data(i);
+                for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+                    row[indices_[k]] = values_[k];
+                }
+            }
+            return dense;
+        }
+
+        template <class T>
+        void CsrMatrix<T>::MultiplyRows(uint begin, uint end, const T* x, T* y) const {
+            const size_t* offsets = offsets_.data();
+            const uint* indices = indices_.data();
+            const T* values = values_.data();
+            for (uint i = begin; i < end; ++i) {
+                // Four independent sums hide the add latency on long rows
+                T sum0 = T(), sum1 = T(), sum2 = T(), sum3 = T();
+                size_t k = offsets[i];
+                const size_t row_end = offsets[i + 1];
+                for (; k + 4 <= row_end; k += 4) {
+                    sum0 += values[k] * x[indices[k]];
+                    sum1 += values[k + 1] * x[indices[k + 1]];
+                    sum2 += values[k + 2] * x[indices[k + 2]];
+                    sum3 += values[k + 3] * x[indices[k + 3]];
+                }
+                for (; k < row_end; ++k) {
+                    sum0 += values[k] * x[indices[k]];
+                }
+                y[i] = (sum0 + sum1) + (sum2 + sum3);
+            }
+        }
+
+        template <class T>
+        void CsrMatrix<T>::MultiplyRows(uint begin, uint end, const Matrix<T>& dense, Matrix<T>& result) const {
+            const uint n = dense.cols();
+            for (uint i = begin; i < end; ++i) {
+                T* out = result.row_data(i);
+                std::fill(out, out + n, T());
+                for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+                    const T value = values_[k];
+                    const T* in = dense.row_data(indices_[k]);
+                    for (uint j = 0; j < n; ++j) {
+                        out[j] += value * in[j];
+                    }
+                }
+            }
+        }
+
+        template <class T>
+        std::vector<T> CsrMatrix<T>::operator*(const std::vector<T>& x) const {
+            if (x.size() != cols_) {
+                throw std::invalid_argument("matrix dimensions do not match");
+            }
+            std::vector<T> y(rows_);
+            MultiplyRows(0, rows_, x.data(), y.data());
+            return y;
+        }
+
+        template <class T>
+        Matrix<T> CsrMatrix<T>::operator*(const Matrix<T>& dense) const {
+            if (dense.rows() != cols_) {
+                throw std::invalid_argument("matrix dimensions do not match");
+            }
+            Matrix<T> result(rows_, dense.cols());
+            MultiplyRows(0, rows_, dense, result);
+            return result;
+        }
+#pragma endregion
+
+#pragma region CscMatrix
+        template <class T>
+        CscMatrix<T>::CscMatrix(uint rows, uint cols, std::vector<Triplet<T>> triplets) : rows_(rows), cols_(cols) {
+            sparse::CheckTriplets(rows, cols, triplets);
+            sparse::Compress(cols, triplets, [](const Triplet<T>& t) { return t.col; }, [](const Triplet<T>& t) { return t.row; },
+                offsets_, indices_, values_);
+        }
+
+        template <class T>
+        CscMatrix<T>::CscMatrix(const Matrix<T>& dense) : CscMatrix(CsrMatrix<T>(dense)) {}
+
+        template <class T>
+        CscMatrix<T>::CscMatrix(const CsrMatrix<T>& csr) : rows_(csr.rows_), cols_(csr.cols_) {
+            sparse::Transpose(csr.rows_, csr.cols_, csr.offsets_, csr.indices_, csr.values_, offsets_, indices_, values_);
+        }
+
+        template <class T>
+        Matrix<T> CscMatrix<T>::ToDense() const {
+            Matrix<T> dense(rows_, cols_);
+            dense.Clear();
+            for (uint j = 0; j < cols_; ++j) {
+                for (size_t k = offsets_[j]; k < offsets_[j + 1]; ++k) {
+                    dense(indices_[k], j) = values_[k];
+                }
+            }
+            return dense;
+        }
+
+        template <class T>
+        std::vector<T> CscMatrix<T>::operator*(const std::vector<T>& x) const {
+            if (x.size() != cols_) {
+                throw std::invalid_argument("matrix dimensions do not match");
+            }
+            std::vector<T> y(rows_);
+            for (uint j = 0; j < cols_; ++j) {
+                const T value = x[j];
+                for (size_t k = offsets_[j]; k < offsets_[j + 1]; ++k) {
+                    y[indices_[k]] += values_[k] * value;
+                }
+            }
+            return y;
+        }
+
+        template <class T>
+        Matrix<T> CscMatrix<T>::operator*(const Matrix<T>& dense) const {
+            if (dense.rows() != cols_) {
+                throw std::invalid_argument("matrix dimensions do not match");
+            }
+            const uint n = dense.cols();
+            Matrix<T> result(rows_, n);
+            result.Clear();
+            for (uint j = 0; j < cols_; ++j) {
+                const T* in = dense.row_data(j);
+                for (size_t k = offsets_[j]; k < offsets_[j + 1]; ++k) {
+                    const T value = values_[k];
+                    T* out = result.row_data(indices_[k]);
+                    for (uint c = 0; c < n; ++c) {
+                        out[c] += value * in[c];
+                    }
+                }
+            }
+            return result;
+        }
+#pragma endregion
+
+        namespace parallel {
+            // Row blocks of y = A * x; blocks are sized by row count, so rows with very
+            // different nonzero counts balance through the pool's shared chunk counter
+            template <class T>
+            std::vector<T> Multiply(ThreadPool& pool, const CsrMatrix<T>& sparse, const std::vector<T>& x) {
+                if (x.size() != sparse.cols()) {
+                    throw std::invalid_argument("matrix dimensions do not match");
+                }
+                std::vector<T> y(sparse.rows());
+                pool.ParallelFor(sparse.rows(), 256, [&](uint begin, uint end) {
+                    sparse.MultiplyRows(begin, end, x.data(), y.data());
+                });
+                return y;
+            }
+
+            template <class T>
+            Matrix<T> Multiply(ThreadPool& pool, const CsrMatrix<T>& sparse, const Matrix<T>& dense) {
+                if (dense.rows() != sparse.cols()) {
+                    throw std::invalid_argument("matrix dimensions do not match");
+                }
+                Matrix<T> result(sparse.rows(), dense.cols());
+                pool.ParallelFor(sparse.rows(), 16, [&](uint begin, uint end) {
+                    sparse.MultiplyRows(begin, end, dense, result);
+                });
+                return result;
+            }
+        }
+    }
+}
+
+#endif  // !SPARSE_MATRIX_H_
@@ -1,8 +1,19 @@
 #include <vector>
+#include <array>
 #include <iostream>
 #include <string>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <filesystem>
 
 #include "matrix.h"
+#include "fixed_matrix.h"
+#include "layout.h"
+#include "matrix_io.h"
+#include "parallel.h"
+#include "sparse_matrix.h"
 
 namespace made {
 
@@ -126,6 +137,704 @@ namespace made {
                 matrix1[3][7] = matrix2[3][7] * 2 + 8;
                 return matrix1 != matrix2;
             }
+
+            bool check_product() {
+                std::cout << "Checking product 2x3 * 3x2";
+                Matrix lhs(2, 3);
+                Matrix rhs(3, 2);
+                for (uint i = 0; i < 2; ++i) {
+                    for (uint j = 0; j < 3; ++j) {
+                        lhs[i][j] = i * 3 + j + 1;
+                        rhs[j][i] = j * 2 + i + 7;
+                    }
+                }
+                Matrix product = lhs * rhs;
+                return product.rows() == 2 && product.cols() == 2
+                    && product[0][0] == 58 && product[0][1] == 64
+                    && product[1][0] == 139 && product[1][1] == 154;
+            }
+
+            bool check_product_blocked() {
+                std::cout << "Checking blocked product 131x257 * 257x70 against naive loop";
+                const uint m = 131, k = 257, n = 70;
+                Matrix lhs(m, k);
+                Matrix rhs(k, n);
+                for (uint i = 0; i < m; ++i)
+                    for (uint p = 0; p < k; ++p)
+                        lhs[i][p] = static_cast<int>((i * 7 + p * 3) % 11) - 5;
+                for (uint p = 0; p < k; ++p)
+                    for (uint j = 0; j < n; ++j)
+                        rhs[p][j] = static_cast<int>((p * 5 + j) % 13) - 6;
+                Matrix product = lhs * rhs;
+                for (uint i = 0; i < m; ++i) {
+                    for (uint j = 0; j < n; ++j) {
+                        int expected = 0;
+                        for (uint p = 0; p < k; ++p)
+                            expected += lhs[i][p] * rhs[p][j];
+                        if (product[i][j] != expected)
+                            return false;
+                    }
+                }
+                return true;
+            }
+
+            bool check_product_dimension_mismatch() {
+                std::cout << "Checking product of mismatched dimensions";
+                Matrix lhs(4, 8);
+                Matrix rhs(4, 8);
+                try {
+                    Matrix product = lhs * rhs;
+                }
+                catch (std::invalid_argument _) {
+                    return true;
+                }
+                return false;
+            }
+
+            bool check_product_of_doubles() {
+                std::cout << "Checking product of double matrices 2x3 * 3x2";
+                Matrix<double> lhs(2, 3);
+                Matrix<double> rhs(3, 2);
+                for (uint i = 0; i < 2; ++i) {
+                    for (uint j = 0; j < 3; ++j) {
+                        lhs[i][j] = (i * 3 + j + 1) * 0.5;
+                        rhs[j][i] = j * 2 + i + 7;
+                    }
+                }
+                Matrix<double> product = lhs * rhs;
+                return product[0][0] == 29.0 && product[0][1] == 32.0
+                    && product[1][0] == 69.5 && product[1][1] == 77.0;
+            }
+
+            bool check_product_of_floats_blocked() {
+                std::cout << "Checking blocked float product 67x45 * 45x33 against naive loop";
+                const uint m = 67, k = 45, n = 33;
+                Matrix<float> lhs(m, k);
+                Matrix<float> rhs(k, n);
+                for (uint i = 0; i < m; ++i)
+                    for (uint p = 0; p < k; ++p)
+                        lhs[i][p] = static_cast<float>((i * 7 + p * 3) % 11) - 5;
+                for (uint p = 0; p < k; ++p)
+                    for (uint j = 0; j < n; ++j)
+                        rhs[p][j] = static_cast<float>((p * 5 + j) % 13) - 6;
+                Matrix<float> product = lhs * rhs;
+                for (uint i = 0; i < m; ++i) {
+                    for (uint j = 0; j < n; ++j) {
+                        float expected = 0;
+                        for (uint p = 0; p < k; ++p)
+                            expected += lhs[i][p] * rhs[p][j];
+                        if (product[i][j] != expected)
+                            return false;
+                    }
+                }
+                return true;
+            }
+
+            bool check_fixed_matrix_product() {
+                std::cout << "Checking fixed matrix product 2x3 * 3x2";
+                constexpr FixedMatrix<int, 2, 3> lhs = { 1, 2, 3, 4, 5, 6 };
+                constexpr FixedMatrix<int, 3, 2> rhs = { 7, 8, 9, 10, 11, 12 };
+                constexpr FixedMatrix<int, 2, 2> product = lhs * rhs;
+                static_assert(product(0, 0) == 58 && product(1, 1) == 154, "product is not constexpr");
+                return product == FixedMatrix<int, 2, 2>{ 58, 64, 139, 154 };
+            }
+
+            bool check_fixed_matrix_identity() {
+                std::cout << "Checking fixed matrix identity and transpose";
+                Matrix4f transform = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+                if (transform * Matrix4f::Identity() != transform)
+                    return false;
+                FixedMatrix<float, 4, 4> transposed = transform.Transposed();
+                for (uint i = 0; i < 4; ++i)
+                    for (uint j = 0; j < 4; ++j)
+                        if (transposed(i, j) != transform(j, i))
+                            return false;
+                transform *= 2;
+                return transform - transposed.Transposed() == transposed.Transposed() && transform(3, 3) == 32;
+            }
+
+            bool check_unchecked_access() {
+                std::cout << "Checking operator() and row pointers";
+                Matrix<int> matrix(3, 5);
+                for (uint i = 0; i < 3; ++i)
+                    for (uint j = 0; j < 5; ++j)
+                        matrix(i, j) = i * 10 + j;
+                const Matrix<int>& constant = matrix;
+                const int* row = constant.row_data(2);
+                return matrix[1][4] == 14 && constant(2, 3) == 23 && row[4] == 24
+                    && matrix.data() + 5 == matrix.row_data(1);
+            }
+
+            bool check_checked_access() {
+                std::cout << "Checking at() out of range";
+                Matrix<int> matrix(3, 5);
+                matrix.at(2, 4) = 1;
+                try {
+                    matrix.at(2, 5) = 1;
+                }
+                catch (std::out_of_range _) {
+                    return matrix(2, 4) == 1;
+                }
+                return false;
+            }
+
+            bool check_submatrix_view() {
+                std::cout << "Checking submatrix view";
+                Matrix<int> matrix(4, 6);
+                for (uint i = 0; i < 4; ++i)
+                    for (uint j = 0; j < 6; ++j)
+                        matrix(i, j) = i * 10 + j;
+                MatrixView<int> view = matrix.Submatrix(1, 2, 2, 3);
+                if (view.rows() != 2 || view.cols() != 3 || view(0, 0) != 12 || view(1, 2) != 24)
+                    return false;
+                view(1, 1) = -1;
+                MatrixView<int> inner = view.Submatrix(1, 1, 1, 2);
+                if (matrix(2, 3) != -1 || inner(0, 0) != -1 || inner(0, 1) != 24)
+                    return false;
+                try {
+                    view.Submatrix(1, 1, 2, 1);
+                }
+                catch (std::out_of_range _) {
+                    return true;
+                }
+                return false;
+            }
+
+            bool check_transposed_view() {
+                std::cout << "Checking transposed view";
+                Matrix<int> matrix(2, 3);
+                for (uint i = 0; i < 2; ++i)
+                    for (uint j = 0; j < 3; ++j)
+                        matrix(i, j) = i * 10 + j;
+                const Matrix<int>& constant = matrix;
+                MatrixView<const int> transposed = constant.Transposed();
+                if (transposed.rows() != 3 || transposed.cols() != 2 || transposed.contiguous_rows())
+                    return false;
+                for (uint i = 0; i < 3; ++i)
+                    for (uint j = 0; j < 2; ++j)
+                        if (transposed(i, j) != matrix(j, i))
+                            return false;
+                MatrixView<const int> column = transposed.Submatrix(0, 1, 3, 1).Transposed();
+                return column(0, 2) == 12 && column.contiguous_rows();
+            }
+
+            bool check_view_offsets_past_uint() {
+                std::cout << "Checking view offsets past the uint range";
+                // Row 2 starts 2^32 + 2 elements in. Only addresses are compared, nothing
+                // past the buffer is read.
+                static char buffer[4];
+                MatrixView<char> view(buffer, 3, 2, 0x80000001u);
+                char* const expected = &view(2, 1);
+                return &view.at(2, 1) == expected && view.Submatrix(2, 1, 1, 1).data() == expected
+                    && &view.Transposed().at(1, 2) == expected;
+            }
+
+            Matrix<int> make_matrix(uint rows, uint cols, int seed) {
+                Matrix<int> matrix(rows, cols);
+                for (uint i = 0; i < rows; ++i)
+                    for (uint j = 0; j < cols; ++j)
+                        matrix(i, j) = static_cast<int>(i * cols + j) * seed;
+                return matrix;
+            }
+
+            bool check_copy() {
+                std::cout << "Checking copy construction and assignment";
+                Matrix<int> original = make_matrix(3, 4, 1);
+                Matrix<int> copy(original);
+                copy(0, 0) = 100;
+                Matrix<int> assigned(3, 4);
+                const int* buffer = assigned.data();
+                assigned = original;
+                Matrix<int> resized(1, 1);
+                resized = original;
+                return original(0, 0) == 0 && copy(0, 0) == 100 && copy(2, 3) == 11
+                    && assigned == original && assigned.data() == buffer && resized == original;
+            }
+
+            bool check_move() {
+                std::cout << "Checking move construction and assignment";
+                Matrix<int> original = make_matrix(3, 4, 1);
+                const int* buffer = original.data();
+                Matrix<int> moved(std::move(original));
+                Matrix<int> assigned(2, 2);
+                assigned = std::move(moved);
+                return original.data() == nullptr && moved.data() == nullptr && moved.rows() == 0
+                    && assigned.data() == buffer && assigned.rows() == 3 && assigned(2, 3) == 11;
+            }
+
+            bool check_addition_and_subtraction() {
+                std::cout << "Checking addition and subtraction";
+                Matrix<int> a = make_matrix(3, 4, 1);
+                Matrix<int> b = make_matrix(3, 4, 2);
+                Matrix<int> sum = a + b;
+                Matrix<int> difference = a - b;
+                Matrix<int> reversed = a - (b * 1);
+                for (uint i = 0; i < 3; ++i)
+                    for (uint j = 0; j < 4; ++j) {
+                        const int value = static_cast<int>(i * 4 + j);
+                        if (sum(i, j) != 3 * value || difference(i, j) != -value || reversed(i, j) != -value)
+                            return false;
+                    }
+                return a * 3 == sum;
+            }
+
+            bool check_rvalue_buffer_reuse() {
+                std::cout << "Checking rvalue operands lend their buffers";
+                Matrix<int> a = make_matrix(3, 4, 1);
+                Matrix<int> b = make_matrix(3, 4, 2);
+                Matrix<int> temporary = a + b;
+                const int* buffer = temporary.data();
+                Matrix<int> chained = std::move(temporary) * 2 - a + b;
+                if (chained.data() != buffer)
+                    return false;
+                temporary = a + b;
+                buffer = temporary.data();
+                Matrix<int> right = b - std::move(temporary);
+                return right.data() == buffer && right == a * -1;
+            }
+
+            bool check_addition_dimension_mismatch() {
+                std::cout << "Checking addition of mismatched dimensions";
+                Matrix<int> lhs(4, 8);
+                Matrix<int> rhs(8, 4);
+                try {
+                    Matrix<int> sum = lhs + rhs;
+                }
+                catch (std::invalid_argument _) {
+                    return true;
+                }
+                return false;
+            }
+
+            bool check_fused_expression() {
+                std::cout << "Checking fused element-wise expression";
+                Matrix<int> a = make_matrix(3, 4, 1);
+                Matrix<int> b = make_matrix(3, 4, 2);
+                Matrix<int> c = make_matrix(3, 4, 3);
+                Matrix<int> result = a + b * 2 - c;
+                for (uint i = 0; i < 3; ++i)
+                    for (uint j = 0; j < 4; ++j)
+                        if (result(i, j) != 2 * static_cast<int>(i * 4 + j))
+                            return false;
+                return result == a * 2 && a * 2 == result && result != a;
+            }
+
+            bool check_expression_assignment_in_place() {
+                std::cout << "Checking expression assignment into an existing matrix";
+                Matrix<int> a = make_matrix(3, 4, 1);
+                Matrix<int> b = make_matrix(3, 4, 2);
+                Matrix<int> result(3, 4);
+                const int* buffer = result.data();
+                result = (a + b) * 2;
+                if (result.data() != buffer || result(2, 3) != 66)
+                    return false;
+                result += a - b;
+                if (result.data() != buffer || result(2, 3) != 55)
+                    return false;
+                Matrix<int> resized(1, 1);
+                resized = a + b;
+                return resized.rows() == 3 && resized.cols() == 4 && resized(2, 3) == 33;
+            }
+
+            bool check_expression_aliasing_destination() {
+                std::cout << "Checking expression reading its own destination";
+                Matrix<int> a = make_matrix(3, 4, 1);
+                Matrix<int> b = make_matrix(3, 4, 2);
+                a = b - a * 3 + a;
+                return a == make_matrix(3, 4, 0);
+            }
+
+            bool check_expression_dimension_mismatch() {
+                std::cout << "Checking expression of mismatched dimensions";
+                Matrix<int> a(3, 4);
+                Matrix<int> b(3, 4);
+                Matrix<int> c(4, 3);
+                try {
+                    Matrix<int> result = a + b * 2 - c;
+                }
+                catch (std::invalid_argument _) {
+                    return true;
+                }
+                return false;
+            }
+
+            bool check_thread_pool_covers_range() {
+                std::cout << "Checking ThreadPool::ParallelFor covers the range once";
+                ThreadPool pool(3);
+                std::vector<int> hits(1000);
+                pool.ParallelFor(1000, 7, [&](uint begin, uint end) {
+                    for (uint i = begin; i < end; ++i)
+                        ++hits[i];
+                });
+                for (int hit : hits)
+                    if (hit != 1)
+                        return false;
+                try {
+                    pool.ParallelFor(100, 1, [](uint begin, uint) {
+                        if (begin == 42)
+                            throw std::runtime_error("job failed");
+                    });
+                }
+                catch (std::runtime_error _) {
+                    return true;
+                }
+                return false;
+            }
+
+            bool check_parallel_product() {
+                std::cout << "Checking parallel product 300x70 * 70x90 against serial";
+                ThreadPool pool(3);
+                Matrix<int> lhs(300, 70), rhs(70, 90);
+                for (uint i = 0; i < 300; ++i)
+                    for (uint p = 0; p < 70; ++p)
+                        lhs(i, p) = static_cast<int>((i * 7 + p * 3) % 11) - 5;
+                for (uint p = 0; p < 70; ++p)
+                    for (uint j = 0; j < 90; ++j)
+                        rhs(p, j) = static_cast<int>((p * 5 + j) % 13) - 6;
+                return parallel::Multiply(pool, lhs, rhs) == lhs * rhs;
+            }
+
+            bool check_parallel_elementwise_and_transpose() {
+                std::cout << "Checking parallel expression evaluation and transpose";
+                ThreadPool pool(3);
+                Matrix<int> a = make_matrix(300, 500, 1);
+                Matrix<int> b = make_matrix(300, 500, 2);
+                Matrix<int> result(1, 1);
+                parallel::Assign(pool, result, a + b * 2);
+                if (result != a * 5 || parallel::Evaluate(pool, a - b) != a * -1)
+                    return false;
+                Matrix<int> transposed = parallel::Transpose(pool, a);
+                if (transposed.rows() != 500 || transposed.cols() != 300)
+                    return false;
+                for (uint i = 0; i < 300; ++i)
+                    for (uint j = 0; j < 500; ++j)
+                        if (transposed(j, i) != a(i, j))
+                            return false;
+                return true;
+            }
+
+            bool check_parallel_reductions() {
+                std::cout << "Checking parallel sum, min, max and norms";
+                ThreadPool pool(3);
+                Matrix<int> matrix(400, 300);
+                for (uint i = 0; i < 400; ++i)
+                    for (uint j = 0; j < 300; ++j)
+                        matrix(i, j) = static_cast<int>((i * 31 + j * 17) % 19) - 9;
+                matrix(123, 45) = -50;
+                matrix(321, 7) = 60;
+                long long sum = 0, squares = 0;
+                for (uint i = 0; i < 400; ++i)
+                    for (uint j = 0; j < 300; ++j) {
+                        sum += matrix(i, j);
+                        squares += matrix(i, j) * matrix(i, j);
+                    }
+                Matrix<int> ones(3, 2);
+                ones.Clear();
+                ones(0, 0) = 1; ones(0, 1) = -2; ones(1, 0) = 3; ones(2, 1) = 4;
+                return parallel::Sum(pool, matrix) == sum
+                    && parallel::Min(pool, matrix) == -50 && parallel::Max(pool, matrix) == 60
+                    && std::abs(parallel::FrobeniusNorm(pool, matrix) - std::sqrt(static_cast<double>(squares))) < 1e-9
+                    && parallel::NormInf(pool, ones) == 4 && parallel::Norm1(pool, ones) == 6;
+            }
+
+            bool check_sparse_from_triplets() {
+                std::cout << "Checking CSR/CSC construction from triplets";
+                std::vector<Triplet<int>> triplets = { { 2, 1, 5 }, { 0, 3, 1 }, { 2, 1, 2 }, { 1, 0, -4 }, { 0, 0, 9 } };
+                CsrMatrix<int> csr(3, 4, triplets);
+                CscMatrix<int> csc(3, 4, triplets);
+                if (csr.nonzeros() != 4 || csc.nonzeros() != 4)
+                    return false;
+                if (csr.offsets() != std::vector<size_t>{ 0, 2, 3, 4 } || csr.indices() != std::vector<uint>{ 0, 3, 0, 1 }
+                    || csr.values() != std::vector<int>{ 9, 1, -4, 7 })
+                    return false;
+                Matrix<int> dense = csr.ToDense();
+                return dense(2, 1) == 7 && dense(0, 3) == 1 && dense(1, 1) == 0 && dense == csc.ToDense();
+            }
+
+            bool check_sparse_triplet_out_of_range() {
+                std::cout << "Checking sparse triplet out of range";
+                try {
+                    CsrMatrix<int> csr(3, 4, { { 3, 0, 1 } });
+                }
+                catch (std::out_of_range _) {
+                    return true;
+                }
+                return false;
+            }
+
+            bool check_sparse_dense_round_trip() {
+                std::cout << "Checking dense -> CSR -> CSC -> CSR -> dense";
+                Matrix<int> dense(37, 53);
+                for (uint i = 0; i < 37; ++i)
+                    for (uint j = 0; j < 53; ++j)
+                        dense(i, j) = (i * 7 + j * 13) % 10 == 0 ? static_cast<int>(i + j) - 30 : 0;
+                CsrMatrix<int> csr(dense);
+                CscMatrix<int> csc(csr);
+                return CsrMatrix<int>(csc).ToDense() == dense && csc.ToDense() == dense
+                    && CscMatrix<int>(dense).values() == csc.values() && csr.ToDense() == dense;
+            }
+
+            bool check_sparse_products() {
+                std::cout << "Checking sparse x vector and sparse x dense products";
+                ThreadPool pool(3);
+                Matrix<int> dense(700, 90);
+                for (uint i = 0; i < 700; ++i)
+                    for (uint j = 0; j < 90; ++j)
+                        dense(i, j) = (i * 3 + j * 11) % 17 == 0 ? static_cast<int>(i % 7) - 3 : 0;
+                Matrix<int> rhs = make_matrix(90, 20, 1);
+                std::vector<int> x(90);
+                for (uint j = 0; j < 90; ++j)
+                    x[j] = static_cast<int>(j % 5) - 2;
+                std::vector<int> expected(700);
+                for (uint i = 0; i < 700; ++i)
+                    for (uint j = 0; j < 90; ++j)
+                        expected[i] += dense(i, j) * x[j];
+                CsrMatrix<int> csr(dense);
+                CscMatrix<int> csc(dense);
+                Matrix<int> product = dense * rhs;
+                return csr * x == expected && csc * x == expected && parallel::Multiply(pool, csr, x) == expected
+                    && csr * rhs == product && csc * rhs == product && parallel::Multiply(pool, csr, rhs) == product;
+            }
+
+            template <class T>
+            bool check_transpose_of(uint rows, uint cols) {
+                Matrix<T> matrix(rows, cols);
+                for (uint i = 0; i < rows; ++i)
+                    for (uint j = 0; j < cols; ++j)
+                        matrix(i, j) = static_cast<T>(i * 1000 + j);
+                Matrix<T> transposed = Transpose(matrix);
+                if (transposed.rows() != cols || transposed.cols() != rows)
+                    return false;
+                for (uint i = 0; i < rows; ++i)
+                    for (uint j = 0; j < cols; ++j)
+                        if (transposed(j, i) != matrix(i, j))
+                            return false;
+                return true;
+            }
+
+            bool check_blocked_transpose() {
+                std::cout << "Checking blocked transpose of int, float and double matrices";
+                return check_transpose_of<int>(131, 75) && check_transpose_of<float>(64, 200)
+                    && check_transpose_of<double>(17, 9) && check_transpose_of<int>(1, 1);
+            }
+
+            bool check_transpose_in_place() {
+                std::cout << "Checking in-place square transpose";
+                for (uint n : { 1u, 7u, 8u, 67u, 130u }) {
+                    Matrix<int> matrix = make_matrix(n, n, 1);
+                    Matrix<int> expected = Transpose(matrix);
+                    TransposeInPlace(matrix);
+                    if (matrix != expected)
+                        return false;
+                }
+                Matrix<int> rectangle(3, 4);
+                try {
+                    TransposeInPlace(rectangle);
+                }
+                catch (std::invalid_argument _) {
+                    return true;
+                }
+                return false;
+            }
+
+            bool check_column_major() {
+                std::cout << "Checking column-major storage";
+                Matrix<float> matrix(19, 45);
+                for (uint i = 0; i < 19; ++i)
+                    for (uint j = 0; j < 45; ++j)
+                        matrix(i, j) = static_cast<float>(i * 100 + j);
+                ColumnMajorMatrix<float> columns(matrix);
+                MatrixView<const float> view = static_cast<const ColumnMajorMatrix<float>&>(columns).View();
+                if (columns(3, 40) != 340 || columns.col_data(40)[3] != 340 || view(18, 44) != 1844)
+                    return false;
+                return columns.ToRowMajor() == matrix;
+            }
+
+            std::string temp_path(const std::string& name) {
+                return (std::filesystem::temp_directory_path() / name).string();
+            }
+
+            bool check_binary_round_trip() {
+                std::cout << "Checking binary save and load";
+                const std::string path = temp_path("made-matrix-round-trip.bin");
+                Matrix<int> matrix = make_matrix(37, 21, 3);
+                Save(matrix, path);
+                Matrix<int> loaded = Load<int>(path);
+                std::remove(path.c_str());
+                return loaded == matrix;
+            }
+
+            bool check_mapped_matrix() {
+                std::cout << "Checking memory-mapped matrix";
+                const std::string path = temp_path("made-matrix-mapped.bin");
+                Matrix<double> matrix(13, 29);
+                for (uint i = 0; i < 13; ++i)
+                    for (uint j = 0; j < 29; ++j)
+                        matrix(i, j) = i + j / 100.0;
+                Save(matrix, path);
+                bool result;
+                {
+                    MappedMatrix<double> mapped(path);
+                    MatrixView<const double> view = mapped.View();
+                    result = mapped.rows() == 13 && mapped.cols() == 29
+                        && reinterpret_cast<std::uintptr_t>(mapped.data()) % 64 == 0
+                        && mapped(12, 28) == matrix(12, 28) && view(7, 3) == matrix(7, 3)
+                        && view.Transposed()(3, 7) == matrix(7, 3);
+                }
+                std::remove(path.c_str());
+                return result;
+            }
+
+            bool check_streaming_writer() {
+                std::cout << "Checking streaming matrix writer";
+                const std::string path = temp_path("made-matrix-writer.bin");
+                Matrix<float> expected(5, 7);
+                {
+                    MatrixWriter<float> writer(path, 5, 7);
+                    std::vector<float> row(7);
+                    for (uint i = 0; i < 5; ++i) {
+                        for (uint j = 0; j < 7; ++j) {
+                            row[j] = static_cast<float>(i * 7 + j);
+                            expected(i, j) = row[j];
+                        }
+                        writer.WriteRow(row.data());
+                    }
+                    writer.Close();
+                }
+                bool result = Load<float>(path) == expected;
+                try {
+                    MatrixWriter<float> writer(path, 5, 7);
+                    writer.WriteRow(expected.row_data(0));
+                    writer.Close();
+                    result = false;
+                }
+                catch (std::runtime_error _) {
+                }
+                std::remove(path.c_str());
+                return result;
+            }
+
+            bool check_invalid_matrix_file() {
+                std::cout << "Checking invalid matrix files";
+                const std::string path = temp_path("made-matrix-invalid.bin");
+                Save(make_matrix(4, 4, 1), path);
+                uint failures = 0;
+                try {
+                    Load<float>(path);
+                }
+                catch (std::runtime_error _) {
+                    ++failures;
+                }
+                std::filesystem::resize_file(path, 64 + 15 * sizeof(int));
+                try {
+                    MappedMatrix<int> mapped(path);
+                }
+                catch (std::runtime_error _) {
+                    ++failures;
+                }
+                std::remove(path.c_str());
+                try {
+                    Load<int>(path);
+                }
+                catch (std::runtime_error _) {
+                    ++failures;
+                }
+                // Either side fits in uint, the element count does not
+                try {
+                    io::CheckHeader<int>(io::MakeHeader<int>(65536, 65536), std::numeric_limits<std::uint64_t>::max());
+                }
+                catch (std::runtime_error _) {
+                    ++failures;
+                }
+                return failures == 4;
+            }
+
+            bool check_unequality_empty_shapes() {
+                std::cout << "Checking unequality of empty matrices of different shape";
+                return Matrix(0, 3) != Matrix(0, 5) && Matrix(3, 0) != Matrix(0, 3) && Matrix(0, 3) == Matrix(0, 3);
+            }
+
+            bool check_equality_blocks() {
+                std::cout << "Checking equality across comparison blocks";
+                for (uint cols : { 1u, 31u, 32u, 33u, 100u }) {
+                    Matrix<float> lhs(7, cols), rhs(7, cols);
+                    lhs.Iota(1.0f, 0.5f);
+                    rhs = lhs;
+                    if (lhs != rhs)
+                        return false;
+                    for (uint position : { 0u, 7 * cols / 2, 7 * cols - 1 }) {
+                        rhs.data()[position] += 1.0f;
+                        if (lhs == rhs)
+                            return false;
+                        rhs.data()[position] -= 1.0f;
+                    }
+                }
+                Matrix<double> zeros(2, 40), negative_zeros(2, 40), nans(2, 40);
+                zeros.Fill(0.0);
+                negative_zeros.Fill(-0.0);
+                nans.Fill(std::nan(""));
+                return zeros == negative_zeros && nans != nans;
+            }
+
+            bool check_fill_and_iota() {
+                std::cout << "Checking Fill and Iota";
+                Matrix<int> ints(9, 13);
+                ints.Fill(-7);
+                for (uint i = 0; i < 9; ++i)
+                    for (uint j = 0; j < 13; ++j)
+                        if (ints(i, j) != -7)
+                            return false;
+                ints.Iota(5, 3);
+                for (uint i = 0; i < 9; ++i)
+                    for (uint j = 0; j < 13; ++j)
+                        if (ints(i, j) != static_cast<int>(5 + (i * 13 + j) * 3))
+                            return false;
+                Matrix<double> doubles(3, 11);
+                doubles.Iota();
+                Matrix<float> floats(3, 11);
+                floats.Iota(-1.0f, 0.25f);
+                return doubles(2, 10) == 32.0 && floats(2, 10) == 7.0f && floats(0, 0) == -1.0f;
+            }
+
+            bool check_fill_streaming_misaligned() {
+                std::cout << "Checking streaming Fill of 32-byte elements off a 32-byte boundary";
+                typedef std::array<double, 4> Quad;
+                const size_t size = elementwise::kStreamBytes / sizeof(Quad) + 5;
+                std::vector<Quad> storage(size + 2, Quad{ 1, 1, 1, 1 });
+                const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(storage.data());
+                Quad* data = reinterpret_cast<Quad*>(reinterpret_cast<char*>(storage.data()) + (48 - address % 32) % 32);
+                const Quad value{ 2, 3, 4, 5 };
+                elementwise::Fill(data, size, value);
+                for (size_t i = 0; i < size; ++i)
+                    if (data[i] != value)
+                        return false;
+                const Quad& guard = data[size];
+                if (guard[0] != 1 || guard[3] != 1)
+                    return false;
+                Matrix<Quad> quads(1024, 1024);
+                quads.Clear();
+                return quads(1023, 1023) == Quad{} && quads(0, 0) == Quad{};
+            }
+
+            bool check_approx_equality() {
+                std::cout << "Checking approximate equality";
+                Matrix<double> lhs(5, 50);
+                lhs.Iota(-100.0, 0.75);
+                Matrix<double> rhs = lhs;
+                for (uint i = 0; i < 250; ++i)
+                    rhs.data()[i] *= 1 + 1e-12;
+                if (lhs == rhs || !lhs.ApproxEqual(rhs, 1e-9) || lhs.ApproxEqual(rhs, 1e-14))
+                    return false;
+                rhs = lhs;
+                rhs(4, 49) += 1e-3;
+                if (lhs.ApproxEqual(rhs, 1e-9) || !lhs.ApproxEqual(rhs, 1e-4))
+                    return false;
+                Matrix<float> infinities(2, 40), nans(2, 40);
+                infinities.Fill(INFINITY);
+                nans.Fill(NAN);
+                return infinities.ApproxEqual(infinities, 0.0f) && !nans.ApproxEqual(nans, 1.0f)
+                    && !lhs.ApproxEqual(Matrix<double>(50, 5), 1.0);
+            }
         }
 
         std::vector<TestFunc> GetTests() {
@@ -142,6 +851,47 @@ namespace made {
                 check_unequality_size,
                 check_unequality_dimension,
                 check_unequality_by_values,
+                check_product,
+                check_product_blocked,
+                check_product_dimension_mismatch,
+                check_product_of_doubles,
+                check_product_of_floats_blocked,
+                check_fixed_matrix_product,
+                check_fixed_matrix_identity,
+                check_unchecked_access,
+                check_checked_access,
+                check_submatrix_view,
+                check_transposed_view,
+                check_view_offsets_past_uint,
+                check_copy,
+                check_move,
+                check_addition_and_subtraction,
+                check_rvalue_buffer_reuse,
+                check_addition_dimension_mismatch,
+                check_fused_expression,
+                check_expression_assignment_in_place,
+                check_expression_aliasing_destination,
+                check_expression_dimension_mismatch,
+                check_thread_pool_covers_range,
+                check_parallel_product,
+                check_parallel_elementwise_and_transpose,
+                check_parallel_reductions,
+                check_sparse_from_triplets,
+                check_sparse_triplet_out_of_range,
+                check_sparse_dense_round_trip,
+                check_sparse_products,
+                check_blocked_transpose,
+                check_transpose_in_place,
+                check_column_major,
+                check_binary_round_trip,
+                check_mapped_matrix,
+                check_streaming_writer,
+                check_invalid_matrix_file,
+                check_unequality_empty_shapes,
+                check_equality_blocks,
+                check_fill_and_iota,
+                check_fill_streaming_misaligned,
+                check_approx_equality,
             };
         }
 
@@ -187,4 +937,4 @@ namespace made {
 
 int main() {
     made::test::RunTests(made::test::GetTests);
-}
\ No newline at end of file
+}
\ No newline at end of file
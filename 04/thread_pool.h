@@ -0,0 +1,98 @@
+#pragma once
+#ifndef MATH_THREAD_POOL_H_
+#define MATH_THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../09/thread_pool.hpp"
+
+namespace made {
+
+    namespace math {
+        typedef unsigned int uint;
+
+        // Fork-join front end of made::multithreading::ThreadPool for data-parallel
+        // kernels. ParallelFor() hands out chunks of an index range through an atomic
+        // counter; it queues one draining task per worker, drains on the calling thread
+        // too, and returns once every chunk is done. A pool of 0 workers runs everything
+        // on the calling thread. ParallelFor() calls must not be nested inside each other.
+        class ThreadPool {
+        public:
+            explicit ThreadPool(uint workers = DefaultWorkers())
+                : workers_(workers ? new multithreading::ThreadPool(workers) : nullptr) {}
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            // One worker per hardware thread besides the caller
+            static uint DefaultWorkers() {
+                const uint threads = std::thread::hardware_concurrency();
+                return threads > 1 ? threads - 1 : 0;
+            }
+            // Threads taking part in ParallelFor(), the caller included
+            uint size() const { return workers_ ? static_cast<uint>(workers_->size()) + 1 : 1; }
+
+            // Calls func(begin, end) for consecutive ranges of at most `grain` indices
+            // covering [0, count). The first exception thrown by func is rethrown here.
+            template <class Func>
+            void ParallelFor(uint count, uint grain, Func&& func);
+        private:
+            std::unique_ptr<multithreading::ThreadPool> workers_;
+        };
+
+        template <class Func>
+        void ThreadPool::ParallelFor(uint count, uint grain, Func&& func) {
+            if (count == 0) {
+                return;
+            }
+            if (grain == 0) {
+                grain = 1;
+            }
+            const uint jobs = (count - 1) / grain + 1;
+            if (jobs == 1 || !workers_) {
+                func(0u, count);
+                return;
+            }
+            std::atomic<uint> next_job(0);
+            std::mutex error_mutex;
+            std::exception_ptr error;
+            auto drain = [&]() {
+                for (uint index = next_job++; index < jobs; index = next_job++) {
+                    const uint begin = index * grain;
+                    try {
+                        func(begin, count - begin < grain ? count : begin + grain);
+                    }
+                    catch (...) {
+                        std::lock_guard<std::mutex> lock(error_mutex);
+                        if (!error) {
+                            error = std::current_exception();
+                        }
+                    }
+                }
+            };
+            // Helpers that start after the caller took the last chunk find nothing to do;
+            // all of them are waited for, since they refer to this frame
+            std::vector<std::future<void>> helpers;
+            const uint helpers_count = std::min(size() - 1, jobs - 1);
+            helpers.reserve(helpers_count);
+            for (uint i = 0; i < helpers_count; ++i) {
+                helpers.push_back(workers_->exec(drain));
+            }
+            drain();
+            for (auto& helper : helpers) {
+                helper.wait();
+            }
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+}
+
+#endif  // !MATH_THREAD_POOL_H_
@@ -0,0 +1,736 @@
+#pragma once
+#ifndef ARCHIVE_H_
+#define ARCHIVE_H_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace made {
+
+    namespace serializer {
+        enum class Error
+        {
+            NoError,
+            CorruptedArchive,
+            SchemaMismatch,     // a tagged field was written with another wire kind
+            IoError,            // the underlying stream failed
+            EndOfArchive        // no records left to read
+        };
+
+        namespace traits {
+            template <class T, class Archive>
+            concept SerializableWith = requires(T& value, Archive& archive) {
+                { value.serialize(archive) } -> std::same_as<Error>;
+            };
+
+            template <class T>
+            struct IsStdArray : std::false_type {};
+            template <class T, size_t N>
+            struct IsStdArray<std::array<T, N>> : std::true_type {};
+
+            template <class T>
+            struct IsOptional : std::false_type {};
+            template <class T>
+            struct IsOptional<std::optional<T>> : std::true_type {};
+
+            template <class T>
+            struct IsPair : std::false_type {};
+            template <class T, class U>
+            struct IsPair<std::pair<T, U>> : std::true_type {};
+
+            // std::vector, made::stl::Vector and the like
+            template <class T>
+            concept ResizableContiguous = requires(T& value, size_t size) {
+                typename T::value_type;
+                { value.data() } -> std::same_as<typename T::value_type*>;
+                value.size();
+                value.resize(size);
+            };
+
+            // std::map, std::unordered_map and the like
+            template <class T>
+            concept Map = requires(T& value, typename T::key_type key, typename T::mapped_type mapped) {
+                value.emplace(std::move(key), std::move(mapped));
+                value.clear();
+                value.size();
+            };
+
+            // Arithmetic arrays a binary archive stores as one block of fixed-width values
+            template <class T>
+            constexpr bool BulkElement = std::is_arithmetic<T>::value && !std::is_same<T, bool>::value;
+
+            template <class T>
+            constexpr bool AlwaysFalse = false;
+        }
+
+        // Arithmetic values as little-endian bytes whatever the host order; bool as 0/1
+        namespace bytes {
+            template <class T>
+            void store(std::byte* out, T value) {
+                static_assert(std::is_arithmetic<T>::value, "only arithmetic values have a byte order");
+                if constexpr (std::is_same<T, bool>::value) {
+                    *out = std::byte(value ? 1 : 0);
+                }
+                else if constexpr (std::endian::native == std::endian::little) {
+                    std::memcpy(out, &value, sizeof(T));
+                }
+                else {
+                    unsigned char raw[sizeof(T)];
+                    std::memcpy(raw, &value, sizeof(T));
+                    std::reverse_copy(raw, raw + sizeof(T), reinterpret_cast<unsigned char*>(out));
+                }
+            }
+
+            template <class T>
+            T load(const std::byte* in) {
+                static_assert(std::is_arithmetic<T>::value, "only arithmetic values have a byte order");
+                if constexpr (std::is_same<T, bool>::value) {
+                    return *in != std::byte(0);
+                }
+                else {
+                    T value;
+                    if constexpr (std::endian::native == std::endian::little) {
+                        std::memcpy(&value, in, sizeof(T));
+                    }
+                    else {
+                        unsigned char raw[sizeof(T)];
+                        std::reverse_copy(reinterpret_cast<const unsigned char*>(in), reinterpret_cast<const unsigned char*>(in) + sizeof(T), raw);
+                        std::memcpy(&value, raw, sizeof(T));
+                    }
+                    return value;
+                }
+            }
+        }
+
+        // An array of unsigned integers written as its size and one varint per element
+        // rather than as fixed-width values: serialize() hands the archive
+        // varints(member). Smaller for mostly small numbers, and SpanDeserializer reads
+        // it back in bulk with varint::decode_many(). Text archives write it as any
+        // other sequence.
+        template <class Container>
+        struct Varints {
+            static_assert(std::is_unsigned<typename Container::value_type>::value && !std::is_same<typename Container::value_type, bool>::value,
+                "varints() takes a container of unsigned integers");
+
+            Container& values;
+        };
+
+        template <class Container>
+        Varints<Container> varints(Container& values) {
+            return { values };
+        }
+
+        // Tagged fields make a record versionable: serialize() hands the archive every
+        // field as tagged<Id>(member) or tagged<Id>(member, default) instead of the bare
+        // members. Such a record is written as its field count followed, per field, by a
+        // key (Id << 3 | wire kind), the payload length and the payload in the archive's
+        // own format. Readers match fields by Id in any order, skip the ones they do not
+        // know and set missing ones to their default (or leave them as constructed), so
+        // fields can be added and removed between versions as long as an Id is never
+        // reused. A known Id with another wire kind is Error::SchemaMismatch. Widening an
+        // integer keeps its kind and stays readable.
+        enum class WireKind : uint8_t { Bool, Unsigned, Signed, Floating, String, Sequence, Record, Other };
+
+        template <class T>
+        constexpr WireKind wire_kind() {
+            if constexpr (std::is_same<T, bool>::value) {
+                return WireKind::Bool;
+            }
+            else if constexpr (std::is_enum<T>::value) {
+                return wire_kind<std::underlying_type_t<T>>();
+            }
+            else if constexpr (std::is_integral<T>::value) {
+                return std::is_signed<T>::value ? WireKind::Signed : WireKind::Unsigned;
+            }
+            else if constexpr (std::is_floating_point<T>::value) {
+                return WireKind::Floating;
+            }
+            else if constexpr (std::is_same<T, std::string>::value) {
+                return WireKind::String;
+            }
+            else if constexpr (traits::IsStdArray<T>::value || traits::ResizableContiguous<T>) {
+                return WireKind::Sequence;
+            }
+            else if constexpr (traits::IsOptional<T>::value || traits::IsPair<T>::value || traits::Map<T>) {
+                return WireKind::Other;
+            }
+            else {
+                return WireKind::Record;
+            }
+        }
+
+        struct FieldDescriptor {
+            uint32_t id;
+            WireKind kind;
+            bool has_default;
+        };
+
+        struct NoDefault {};
+
+        template <uint32_t Id, class T, class Default = NoDefault>
+        struct Tagged {
+            static constexpr FieldDescriptor descriptor{ Id, wire_kind<T>(), !std::is_same<Default, NoDefault>::value };
+
+            T& value;
+            Default fallback;
+
+            void set_default() {
+                if constexpr (descriptor.has_default) {
+                    value = fallback;
+                }
+            }
+        };
+
+        template <uint32_t Id, class T>
+        Tagged<Id, T> tagged(T& value) {
+            return { value, {} };
+        }
+
+        template <uint32_t Id, class T, class Default>
+        Tagged<Id, T, Default> tagged(T& value, Default fallback) {
+            return { value, std::move(fallback) };
+        }
+
+        namespace traits {
+            template <class T>
+            struct IsTagged : std::false_type {};
+            template <uint32_t Id, class T, class Default>
+            struct IsTagged<Tagged<Id, T, Default>> : std::true_type {};
+
+            template <class T>
+            struct IsVarints : std::false_type {};
+            template <class Container>
+            struct IsVarints<Varints<Container>> : std::true_type {};
+
+            template <class... ArgsT>
+            constexpr bool AnyTagged = (IsTagged<std::remove_cvref_t<ArgsT>>::value || ...);
+            template <class... ArgsT>
+            constexpr bool AllTagged = (IsTagged<std::remove_cvref_t<ArgsT>>::value && ...);
+        }
+
+        namespace schema {
+            constexpr uint64_t key(const FieldDescriptor& field) {
+                return static_cast<uint64_t>(field.id) << 3 | static_cast<uint64_t>(field.kind);
+            }
+
+            // Descriptors of a record's fields, known at compile time
+            template <class... Fields>
+            constexpr std::array<FieldDescriptor, sizeof...(Fields)> fields() {
+                return { std::remove_cvref_t<Fields>::descriptor... };
+            }
+
+            template <size_t N>
+            constexpr bool unique_ids(const std::array<FieldDescriptor, N>& fields) {
+                for (size_t i = 0; i < N; ++i) {
+                    for (size_t j = i + 1; j < N; ++j) {
+                        if (fields[i].id == fields[j].id) {
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            }
+
+            // Takes the place of an archive to collect the descriptors of T's fields
+            class Collector
+            {
+            public:
+                std::vector<FieldDescriptor> descriptors;
+
+                template <class... ArgsT>
+                Error operator()(ArgsT&&...) {
+                    if constexpr (traits::AnyTagged<ArgsT...>) {
+                        constexpr auto record = fields<ArgsT...>();
+                        descriptors.assign(record.begin(), record.end());
+                    }
+                    return Error::NoError;
+                }
+            };
+
+            // Empty for records without tagged fields
+            template <class T>
+            std::vector<FieldDescriptor> of() {
+                T sample{};
+                Collector collector;
+                sample.serialize(collector);
+                return collector.descriptors;
+            }
+        }
+
+        // Type dispatch shared by the archives. Derived archives only implement the
+        // primitives; process() turns every supported type into calls to them:
+        //   separate()                   between the parts of a composite value
+        //   write_bool(bool)
+        //   write_unsigned(uint64_t)     unsigned integers, sizes
+        //   write_signed(int64_t)
+        //   write_float(float|double)
+        //   write_bytes(data, size)      string characters and bulk arrays
+        //   BulkCopy                     arithmetic arrays go through write_bytes as
+        //                                little-endian fixed-width values
+        //   Sizer                        a writer counting the bytes Derived would write,
+        //                                for the payload lengths of tagged fields
+        // Strings, vectors and maps are a size followed by their elements; std::array
+        // has no size, std::optional is a presence flag and the value, if any.
+        // operator() of the archives goes through process_fields(), which picks the
+        // tagged record format at compile time, so untagged records pay nothing for it.
+        template <class Derived>
+        class ArchiveWriter
+        {
+        protected:
+            template <class... ArgsT>
+            Error process_fields(ArgsT&... args) {
+                if constexpr (traits::AnyTagged<ArgsT...>) {
+                    static_assert(traits::AllTagged<ArgsT...>, "tag every field of a record or none");
+                    static_assert(schema::unique_ids(schema::fields<ArgsT...>()), "field ids of a record must be unique");
+                    Error error = static_cast<Derived&>(*this).write_unsigned(sizeof...(ArgsT));
+                    ((error = error == Error::NoError ? process_tagged(args) : error), ...);
+                    return error;
+                }
+                else {
+                    return static_cast<Derived&>(*this).process(args...);
+                }
+            }
+
+            template <class T>
+            Error process(T& value) {
+                Derived& archive = static_cast<Derived&>(*this);
+                using Type = std::remove_cv_t<T>;
+                if constexpr (std::is_same<Type, bool>::value) {
+                    return archive.write_bool(value);
+                }
+                else if constexpr (std::is_integral<Type>::value && std::is_signed<Type>::value) {
+                    return archive.write_signed(static_cast<int64_t>(value));
+                }
+                else if constexpr (std::is_integral<Type>::value) {
+                    return archive.write_unsigned(static_cast<uint64_t>(value));
+                }
+                else if constexpr (std::is_floating_point<Type>::value) {
+                    static_assert(sizeof(Type) <= sizeof(double), "long double is not portable");
+                    return archive.write_float(value);
+                }
+                else if constexpr (std::is_enum<Type>::value) {
+                    std::underlying_type_t<Type> underlying = static_cast<std::underlying_type_t<Type>>(value);
+                    return process(underlying);
+                }
+                else if constexpr (traits::SerializableWith<Type, Derived>) {
+                    return value.serialize(archive);
+                }
+                else if constexpr (std::is_same<Type, std::string>::value) {
+                    Error error = archive.write_unsigned(value.size());
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                    archive.separate();
+                    return archive.write_bytes(value.data(), value.size());
+                }
+                else if constexpr (traits::IsStdArray<Type>::value) {
+                    return process_elements(value.data(), value.size(), false);
+                }
+                else if constexpr (traits::ResizableContiguous<Type>) {
+                    Error error = archive.write_unsigned(value.size());
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                    return process_elements(value.data(), value.size(), true);
+                }
+                else if constexpr (traits::IsVarints<Type>::value) {
+                    Error error = archive.write_unsigned(value.values.size());
+                    for (size_t i = 0; i < value.values.size() && error == Error::NoError; ++i) {
+                        archive.separate();
+                        error = archive.write_unsigned(static_cast<uint64_t>(value.values[i]));
+                    }
+                    return error;
+                }
+                else if constexpr (traits::IsOptional<Type>::value) {
+                    Error error = archive.write_bool(value.has_value());
+                    if (error != Error::NoError || !value) {
+                        return error;
+                    }
+                    archive.separate();
+                    return process(*value);
+                }
+                else if constexpr (traits::Map<Type>) {
+                    Error error = archive.write_unsigned(value.size());
+                    for (auto& entry : value) {
+                        if (error != Error::NoError) {
+                            return error;
+                        }
+                        typename Type::key_type key = entry.first;
+                        archive.separate();
+                        error = process(key);
+                        if (error == Error::NoError) {
+                            archive.separate();
+                            error = process(entry.second);
+                        }
+                    }
+                    return error;
+                }
+                else if constexpr (traits::IsPair<Type>::value) {
+                    Error error = process(value.first);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                    archive.separate();
+                    return process(value.second);
+                }
+                else {
+                    static_assert(traits::AlwaysFalse<T>, "type has no serialize() and is not a supported standard type");
+                    return Error::CorruptedArchive;
+                }
+            }
+
+        private:
+            template <uint32_t Id, class T, class Default>
+            Error process_tagged(Tagged<Id, T, Default>& field) {
+                Derived& archive = static_cast<Derived&>(*this);
+                typename Derived::Sizer sizer;
+                const uint64_t size = sizer.measure(field.value);
+                archive.separate();
+                Error error = archive.write_unsigned(schema::key(field.descriptor));
+                if (error == Error::NoError) {
+                    archive.separate();
+                    error = archive.write_unsigned(size);
+                }
+                if (error != Error::NoError) {
+                    return error;
+                }
+                archive.separate();
+                return process(field.value);
+            }
+
+            template <class T>
+            Error process_elements(T* data, size_t count, bool leading_separator) {
+                Derived& archive = static_cast<Derived&>(*this);
+                if constexpr (Derived::BulkCopy && traits::BulkElement<std::remove_cv_t<T>>) {
+                    if constexpr (std::endian::native == std::endian::little) {
+                        return archive.write_bytes(data, count * sizeof(T));
+                    }
+                    else {
+                        std::byte raw[sizeof(T)];
+                        Error error = Error::NoError;
+                        for (size_t i = 0; i < count && error == Error::NoError; ++i) {
+                            bytes::store(raw, data[i]);
+                            error = archive.write_bytes(raw, sizeof(T));
+                        }
+                        return error;
+                    }
+                }
+                else {
+                    for (size_t i = 0; i < count; ++i) {
+                        if (leading_separator || i > 0) {
+                            archive.separate();
+                        }
+                        Error error = process(data[i]);
+                        if (error != Error::NoError) {
+                            return error;
+                        }
+                    }
+                    return Error::NoError;
+                }
+            }
+        };
+
+        // Reading counterpart of ArchiveWriter. Derived archives implement
+        //   read_bool(bool&), read_unsigned(uint64_t&), read_signed(int64_t&),
+        //   read_float(float&|double&), read_bytes(data, size), BulkCopy
+        //   read_more(data, size)        the next `size` bytes of the byte string that
+        //                                read_bytes() started
+        //   read_unsigned(values, count) `count` unsigned values in a row, for varints()
+        //   available()                  upper bound of the bytes left, so corrupted
+        //                                sizes fail before anything is allocated; the
+        //                                maximum for streams, whose containers then
+        //                                grow GrowBytes at a time as the input arrives
+        //   read_field(value, length)    reads value from the next `length` bytes, which
+        //                                it must use up
+        //   skip(length)                 passes over the payload of an unknown field
+        // Integers out of the range of the target type are CorruptedArchive.
+        template <class Derived>
+        class ArchiveReader
+        {
+        protected:
+            template <class... ArgsT>
+            Error process_fields(ArgsT&... args) {
+                if constexpr (traits::AnyTagged<ArgsT...>) {
+                    static_assert(traits::AllTagged<ArgsT...>, "tag every field of a record or none");
+                    static_assert(schema::unique_ids(schema::fields<ArgsT...>()), "field ids of a record must be unique");
+                    return process_record(std::index_sequence_for<ArgsT...>(), args...);
+                }
+                else {
+                    return static_cast<Derived&>(*this).process(args...);
+                }
+            }
+
+            template <class T>
+            Error process(T& value) {
+                Derived& archive = static_cast<Derived&>(*this);
+                if constexpr (std::is_same<T, bool>::value) {
+                    return archive.read_bool(value);
+                }
+                else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+                    int64_t raw;
+                    Error error = archive.read_signed(raw);
+                    if (error != Error::NoError || raw < std::numeric_limits<T>::min() || raw > std::numeric_limits<T>::max()) {
+                        return Error::CorruptedArchive;
+                    }
+                    value = static_cast<T>(raw);
+                    return Error::NoError;
+                }
+                else if constexpr (std::is_integral<T>::value) {
+                    uint64_t raw;
+                    Error error = archive.read_unsigned(raw);
+                    if (error != Error::NoError || raw > std::numeric_limits<T>::max()) {
+                        return Error::CorruptedArchive;
+                    }
+                    value = static_cast<T>(raw);
+                    return Error::NoError;
+                }
+                else if constexpr (std::is_floating_point<T>::value) {
+                    static_assert(sizeof(T) <= sizeof(double), "long double is not portable");
+                    return archive.read_float(value);
+                }
+                else if constexpr (std::is_enum<T>::value) {
+                    std::underlying_type_t<T> underlying{};
+                    Error error = process(underlying);
+                    if (error == Error::NoError) {
+                        value = static_cast<T>(underlying);
+                    }
+                    return error;
+                }
+                else if constexpr (traits::SerializableWith<T, Derived>) {
+                    return value.serialize(archive);
+                }
+                else if constexpr (std::is_same<T, std::string>::value) {
+                    size_t size;
+                    Error error = process_size(size, 1);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                    return read_byte_string(value, size);
+                }
+                else if constexpr (traits::IsStdArray<T>::value) {
+                    return process_elements(value.data(), value.size());
+                }
+                else if constexpr (traits::ResizableContiguous<T>) {
+                    using Element = typename T::value_type;
+                    size_t size;
+                    Error error = process_size(size, Derived::BulkCopy && traits::BulkElement<Element> ? sizeof(Element) : 1);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                    return read_growing(value, size, [&](size_t first, size_t count) {
+                        return process_elements(value.data() + first, count);
+                    });
+                }
+                else if constexpr (traits::IsVarints<T>::value) {
+                    size_t size;
+                    Error error = process_size(size, 1);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                    return read_growing(value.values, size, [&](size_t first, size_t count) {
+                        return process_varints(value.values.data() + first, count);
+                    });
+                }
+                else if constexpr (traits::IsOptional<T>::value) {
+                    bool present;
+                    Error error = archive.read_bool(present);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                    if (!present) {
+                        value.reset();
+                        return Error::NoError;
+                    }
+                    value.emplace();
+                    return process(*value);
+                }
+                else if constexpr (traits::Map<T>) {
+                    size_t size;
+                    Error error = process_size(size, 2);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                    value.clear();
+                    for (size_t i = 0; i < size; ++i) {
+                        typename T::key_type key{};
+                        typename T::mapped_type mapped{};
+                        error = process(key);
+                        if (error == Error::NoError) {
+                            error = process(mapped);
+                        }
+                        if (error != Error::NoError) {
+                            return error;
+                        }
+                        value.emplace(std::move(key), std::move(mapped));
+                    }
+                    return Error::NoError;
+                }
+                else if constexpr (traits::IsPair<T>::value) {
+                    Error error = process(value.first);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                    return process(value.second);
+                }
+                else {
+                    static_assert(traits::AlwaysFalse<T>, "type has no serialize() and is not a supported standard type");
+                    return Error::CorruptedArchive;
+                }
+            }
+
+            static constexpr size_t GrowBytes = size_t(1) << 20;
+
+            // Resizes value to `size` elements and reads them with read(first, count):
+            // at once when available() has bounded the size, else GrowBytes at a time,
+            // so a corrupted size in a stream runs out of input before it gets far
+            template <class Container, class Read>
+            Error read_growing(Container& value, size_t size, Read read) {
+                size_t step = size;
+                if (static_cast<Derived&>(*this).available() == std::numeric_limits<uint64_t>::max()) {
+                    step = std::max<size_t>(GrowBytes / sizeof(typename Container::value_type), 1);
+                }
+                size_t done = 0;
+                do {
+                    const size_t count = std::min(size - done, step);
+                    value.resize(done + count);
+                    Error error = read(done, count);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                    done += count;
+                } while (done < size);
+                return Error::NoError;
+            }
+
+            // `size` bytes as read_bytes() takes them, into a string or byte vector
+            template <class Bytes>
+            Error read_byte_string(Bytes& value, size_t size) {
+                Derived& archive = static_cast<Derived&>(*this);
+                return read_growing(value, size, [&](size_t first, size_t count) {
+                    return first == 0 ? archive.read_bytes(value.data(), count) : archive.read_more(value.data() + first, count);
+                });
+            }
+
+        private:
+            template <size_t... Index, class... Fields>
+            Error process_record(std::index_sequence<Index...>, Fields&... fields) {
+                Derived& archive = static_cast<Derived&>(*this);
+                uint64_t count;
+                Error error = archive.read_unsigned(count);
+                // A key and a length take at least a byte each
+                if (error != Error::NoError || count > archive.available() / 2) {
+                    return Error::CorruptedArchive;
+                }
+                bool seen[sizeof...(Fields)] = {};
+                for (uint64_t i = 0; i < count; ++i) {
+                    uint64_t key, length;
+                    if (archive.read_unsigned(key) != Error::NoError || archive.read_unsigned(length) != Error::NoError
+                        || length > archive.available()) {
+                        return Error::CorruptedArchive;
+                    }
+                    bool known = false;
+                    auto match = [&](auto& field, bool& field_seen) {
+                        if (known || key >> 3 != field.descriptor.id) {
+                            return;
+                        }
+                        known = field_seen = true;
+                        error = key == schema::key(field.descriptor)
+                            ? archive.read_field(field.value, static_cast<size_t>(length))
+                            : Error::SchemaMismatch;
+                    };
+                    (match(fields, seen[Index]), ...);
+                    if (!known) {
+                        error = archive.skip(static_cast<size_t>(length));
+                    }
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                }
+                ((seen[Index] ? void() : fields.set_default()), ...);
+                return Error::NoError;
+            }
+
+            // A size of elements taking at least `element_bytes` each
+            Error process_size(size_t& size, size_t element_bytes) {
+                Derived& archive = static_cast<Derived&>(*this);
+                uint64_t raw;
+                Error error = archive.read_unsigned(raw);
+                if (error != Error::NoError || raw > archive.available() / element_bytes) {
+                    return Error::CorruptedArchive;
+                }
+                size = static_cast<size_t>(raw);
+                return Error::NoError;
+            }
+
+            // Narrower elements go through a block of uint64_t at a time
+            template <class T>
+            Error process_varints(T* data, size_t count) {
+                Derived& archive = static_cast<Derived&>(*this);
+                if constexpr (std::is_same<T, uint64_t>::value) {
+                    return archive.read_unsigned(data, count);
+                }
+                else {
+                    uint64_t block[256];
+                    for (size_t first = 0; first < count; first += std::size(block)) {
+                        const size_t size = std::min(count - first, std::size(block));
+                        Error error = archive.read_unsigned(block, size);
+                        if (error != Error::NoError) {
+                            return error;
+                        }
+                        for (size_t i = 0; i < size; ++i) {
+                            if (block[i] > std::numeric_limits<T>::max()) {
+                                return Error::CorruptedArchive;
+                            }
+                            data[first + i] = static_cast<T>(block[i]);
+                        }
+                    }
+                    return Error::NoError;
+                }
+            }
+
+            template <class T>
+            Error process_elements(T* data, size_t count) {
+                Derived& archive = static_cast<Derived&>(*this);
+                if constexpr (Derived::BulkCopy && traits::BulkElement<T>) {
+                    if constexpr (std::endian::native == std::endian::little) {
+                        return archive.read_bytes(data, count * sizeof(T));
+                    }
+                    else {
+                        std::byte raw[sizeof(T)];
+                        for (size_t i = 0; i < count; ++i) {
+                            Error error = archive.read_bytes(raw, sizeof(T));
+                            if (error != Error::NoError) {
+                                return error;
+                            }
+                            data[i] = bytes::load<T>(raw);
+                        }
+                        return Error::NoError;
+                    }
+                }
+                else {
+                    for (size_t i = 0; i < count; ++i) {
+                        Error error = process(data[i]);
+                        if (error != Error::NoError) {
+                            return error;
+                        }
+                    }
+                    return Error::NoError;
+                }
+            }
+        };
+    }
+}
+
+#endif  // !ARCHIVE_H_
@@ -0,0 +1,184 @@
+#pragma once
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "buffer_serializer.hpp"
+#include "varint.hpp"
+#include "../09/thread_pool.hpp"
+
+namespace made {
+
+    namespace serializer {
+        using multithreading::ThreadPool;
+
+        // Batches of records encoded and decoded on a thread pool. The records are cut
+        // into frames of at most `frame_records` consecutive records, every frame is
+        // encoded by its own task into its own buffer, and the frames are then copied
+        // side by side into the output, again one task per frame. The output is the
+        // varint count of all records, then the frames: a varint record count, a varint
+        // payload size and the records in the BufferSerializer format. decode_batch()
+        // finds the frames from their headers and decodes every frame in its own task
+        // straight into its place in the output vector.
+        namespace batch {
+            constexpr size_t FrameRecords = 1 << 16;
+
+            // Waits for every task, since they all refer to the caller's data, and
+            // returns the first error in frame order. Only then is the first exception
+            // a task threw (bad_alloc, a throwing serialize()) rethrown.
+            inline Error wait(std::vector<std::future<Error>>& results) {
+                for (std::future<Error>& result : results) {
+                    result.wait();
+                }
+                Error error = Error::NoError;
+                for (std::future<Error>& result : results) {
+                    const Error frame_error = result.get();
+                    if (error == Error::NoError) {
+                        error = frame_error;
+                    }
+                }
+                return error;
+            }
+        }
+
+        // Encodes batches on a pool, keeping the frame buffers from one batch to the
+        // next: a stream of batches then allocates (and page-faults) only for the first
+        class BatchEncoder
+        {
+        public:
+            explicit BatchEncoder(ThreadPool& pool, size_t frame_records = batch::FrameRecords)
+                : pool_(pool), frame_records_(frame_records) {
+                if (frame_records == 0) {
+                    throw std::invalid_argument("frames of no records");
+                }
+            }
+
+            // Replaces the contents of out
+            template <class T>
+            Error encode(std::span<T> records, std::vector<std::byte>& out) {
+                const size_t frames = (records.size() + frame_records_ - 1) / frame_records_;
+                if (buffers_.size() < frames) {
+                    buffers_.resize(frames);
+                }
+                std::vector<std::future<Error>> results;
+                results.reserve(frames);
+                for (size_t frame = 0; frame < frames; ++frame) {
+                    results.push_back(pool_.exec([&, frame]() {
+                        BufferSerializer& buffer = buffers_[frame];
+                        buffer.clear();
+                        for (size_t i = first(frame); i < first(frame) + count(records.size(), frame); ++i) {
+                            Error error = buffer.save(records[i]);
+                            if (error != Error::NoError) {
+                                return error;
+                            }
+                        }
+                        return Error::NoError;
+                    }));
+                }
+                Error error = batch::wait(results);
+                if (error != Error::NoError) {
+                    return error;
+                }
+
+                std::vector<size_t> offsets(frames + 1, varint::size(records.size()));
+                for (size_t frame = 0; frame < frames; ++frame) {
+                    const size_t size = buffers_[frame].size();
+                    offsets[frame + 1] = offsets[frame] + varint::size(count(records.size(), frame)) + varint::size(size) + size;
+                }
+                out.resize(offsets[frames]);
+                varint::encode(records.size(), reinterpret_cast<uint8_t*>(out.data()));
+                results.clear();
+                for (size_t frame = 0; frame < frames; ++frame) {
+                    results.push_back(pool_.exec([&, frame]() {
+                        const BufferSerializer& buffer = buffers_[frame];
+                        uint8_t* position = reinterpret_cast<uint8_t*>(out.data() + offsets[frame]);
+                        position += varint::encode(count(records.size(), frame), position);
+                        position += varint::encode(buffer.size(), position);
+                        if (buffer.size() != 0) {
+                            std::memcpy(position, buffer.data().data(), buffer.size());
+                        }
+                        return Error::NoError;
+                    }));
+                }
+                return batch::wait(results);
+            }
+
+        private:
+            size_t first(size_t frame) const { return frame * frame_records_; }
+            size_t count(size_t records, size_t frame) const { return std::min(records - first(frame), frame_records_); }
+
+            ThreadPool& pool_;
+            size_t frame_records_;
+            std::vector<BufferSerializer> buffers_;
+        };
+
+        template <class T>
+        Error encode_batch(std::span<T> records, std::vector<std::byte>& out, ThreadPool& pool, size_t frame_records = batch::FrameRecords) {
+            return BatchEncoder(pool, frame_records).encode(records, out);
+        }
+
+        // Replaces the contents of records. Records must take at least a byte each,
+        // which bounds what a corrupted count can allocate.
+        template <class T>
+        Error decode_batch(std::span<const std::byte> in, std::vector<T>& records, ThreadPool& pool) {
+            struct Frame {
+                const uint8_t* payload;
+                size_t size;
+                size_t first;
+                size_t count;
+            };
+            std::vector<Frame> frames;
+            const uint8_t* position = reinterpret_cast<const uint8_t*>(in.data());
+            const uint8_t* end = position + in.size();
+            uint64_t expected;
+            position = varint::decode(position, end, expected);
+            if (!position || expected > in.size()) {
+                return Error::CorruptedArchive;
+            }
+            size_t total = 0;
+            while (position != end) {
+                uint64_t count, size;
+                position = varint::decode(position, end, count);
+                if (position) {
+                    position = varint::decode(position, end, size);
+                }
+                if (!position || size > static_cast<uint64_t>(end - position) || count > size || count > expected - total) {
+                    return Error::CorruptedArchive;
+                }
+                frames.push_back({ position, static_cast<size_t>(size), total, static_cast<size_t>(count) });
+                total += static_cast<size_t>(count);
+                position += size;
+            }
+            if (total != expected) {
+                return Error::CorruptedArchive;
+            }
+            records.clear();
+            records.resize(total);
+            std::vector<std::future<Error>> results;
+            results.reserve(frames.size());
+            for (const Frame& frame : frames) {
+                results.push_back(pool.exec([&records, frame]() {
+                    SpanDeserializer deserializer({ reinterpret_cast<const std::byte*>(frame.payload), frame.size });
+                    for (size_t i = frame.first; i < frame.first + frame.count; ++i) {
+                        Error error = deserializer(records[i]);
+                        if (error != Error::NoError) {
+                            return error;
+                        }
+                    }
+                    return deserializer.remaining() == 0 ? Error::NoError : Error::CorruptedArchive;
+                }));
+            }
+            return batch::wait(results);
+        }
+    }
+}
+
+#endif  // !BATCH_H_
@@ -0,0 +1,674 @@
+#include <vector>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "serializer.hpp"
+#include "binary_serializer.hpp"
+#include "buffer_serializer.hpp"
+#include "layout_serializer.hpp"
+#include "compression.hpp"
+#include "record_stream.hpp"
+#include "batch.hpp"
+#include "text_serializer.hpp"
+
+namespace made {
+
+    namespace bench {
+        typedef void(*BenchFunc)();
+
+        struct Benchmark {
+            const char* name;
+            BenchFunc function;
+        };
+
+        // Best wall time of `repeats` runs, in seconds
+        double MeasureBest(const std::function<void()>& func, int repeats = 3) {
+            double best = 0;
+            for (int i = 0; i < repeats; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                func();
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                if (i == 0 || elapsed.count() < best) {
+                    best = elapsed.count();
+                }
+            }
+            return best;
+        }
+
+        template <class T>
+        void Consume(const T& value) {
+            static volatile T sink;
+            sink = value;
+        }
+
+        // Records per second and encoded megabytes per second
+        void Report(const std::string& label, double seconds, double records, double bytes) {
+            std::cout << "  " << std::left << std::setw(40) << label << std::right
+                << std::fixed << std::setprecision(3) << std::setw(12) << seconds * 1e3 << " ms"
+                << std::setw(10) << std::setprecision(2) << records / seconds / 1e6 << " Mrec/s"
+                << std::setw(10) << bytes / seconds / 1e6 << " MB/s" << std::endl;
+        }
+
+        namespace serializer {
+            using namespace made::serializer;
+
+            struct Data {
+                uint64_t a;
+                bool b;
+                uint64_t c;
+
+                template <class Serializer>
+                Error serialize(Serializer& serializer) {
+                    return serializer(a, b, c);
+                }
+            };
+
+            // Small ids, flags and large timestamp-like values
+            std::vector<Data> MakeRecords(size_t count) {
+                std::vector<Data> records(count);
+                uint64_t state = 88172645463325252ull;
+                for (Data& record : records) {
+                    state ^= state << 13;
+                    state ^= state >> 7;
+                    state ^= state << 17;
+                    record.a = state % 10000;
+                    record.b = (state >> 20) & 1;
+                    record.c = 1500000000000ull + (state >> 24) % 100000000000ull;
+                }
+                return records;
+            }
+
+            namespace text_vs_binary {
+                const size_t kRecords = 1000000;
+
+                // Records are written back to back; the text format separates them by a space
+                template <class Archive>
+                std::string encode(const std::vector<Data>& records, bool separate) {
+                    std::stringstream stream;
+                    Archive archive(stream);
+                    for (Data record : records) {
+                        archive.save(record);
+                        if (separate) {
+                            stream << ' ';
+                        }
+                    }
+                    return stream.str();
+                }
+
+                template <class Archive>
+                uint64_t decode(const std::string& encoded, size_t count) {
+                    std::stringstream stream(encoded);
+                    Archive archive(stream);
+                    uint64_t sum = 0;
+                    Data record;
+                    for (size_t i = 0; i < count; ++i) {
+                        record.serialize(archive);
+                        sum += record.a + record.c + record.b;
+                    }
+                    return sum;
+                }
+
+                template <class Writer, class Reader>
+                void measure(const std::string& name, const std::vector<Data>& records, bool separate) {
+                    std::string encoded;
+                    double seconds = MeasureBest([&]() { encoded = encode<Writer>(records, separate); });
+                    Report(name + " encode", seconds, records.size(), encoded.size());
+                    uint64_t sum = 0;
+                    seconds = MeasureBest([&]() {
+                        sum = decode<Reader>(encoded, records.size());
+                        Consume(sum);
+                    });
+                    Report(name + " decode", seconds, records.size(), encoded.size());
+                    std::cout << "  " << std::left << std::setw(40) << (name + " bytes per record") << std::right
+                        << std::setw(15) << std::setprecision(2) << static_cast<double>(encoded.size()) / records.size() << std::endl;
+                }
+
+                void run() {
+                    const std::vector<Data> records = MakeRecords(kRecords);
+                    measure<Serializer, Deserializer>("1e6 records, text", records, true);
+                    measure<BinarySerializer, BinaryDeserializer>("1e6 records, binary", records, false);
+                }
+            }
+
+            namespace text_blocks {
+                const size_t kValues = 1000000;
+
+                void run() {
+                    const std::vector<Data> records = MakeRecords(text_vs_binary::kRecords);
+                    text_vs_binary::measure<Serializer, Deserializer>("1e6 records, text stream", records, true);
+                    text_vs_binary::measure<TextSerializer, TextDeserializer>("1e6 records, text blocks", records, true);
+
+                    std::vector<double> values(kValues);
+                    uint64_t state = 88172645463325252ull;
+                    for (double& value : values) {
+                        state ^= state << 13;
+                        state ^= state >> 7;
+                        state ^= state << 17;
+                        value = static_cast<double>(state % 1000000) / 1000;
+                    }
+                    std::string text;
+                    double seconds = MeasureBest([&]() {
+                        std::stringstream stream;
+                        Serializer(stream).save(values);
+                        text = stream.str();
+                    });
+                    Report("1e6 doubles, text stream encode", seconds, kValues, text.size());
+                    seconds = MeasureBest([&]() {
+                        std::stringstream stream(text);
+                        std::vector<double> loaded;
+                        Deserializer(stream).load(loaded);
+                        Consume(loaded.back());
+                    });
+                    Report("1e6 doubles, text stream decode", seconds, kValues, text.size());
+                    seconds = MeasureBest([&]() {
+                        std::stringstream stream;
+                        TextSerializer(stream).save(values);
+                        text = stream.str();
+                    });
+                    Report("1e6 doubles, text blocks encode", seconds, kValues, text.size());
+                    seconds = MeasureBest([&]() {
+                        std::stringstream stream(text);
+                        std::vector<double> loaded;
+                        TextDeserializer(stream).load(loaded);
+                        Consume(loaded.back());
+                    });
+                    Report("1e6 doubles, text blocks decode", seconds, kValues, text.size());
+                }
+            }
+
+            namespace buffer {
+                const size_t kRecords = 10000000;
+
+                template <class Writer, class Reader>
+                void stream(const std::string& name, const std::vector<Data>& records, bool separate) {
+                    std::string encoded;
+                    double seconds = MeasureBest([&]() { encoded = text_vs_binary::encode<Writer>(records, separate); }, 1);
+                    Report(name + " encode", seconds, records.size(), encoded.size());
+                    seconds = MeasureBest([&]() { Consume(text_vs_binary::decode<Reader>(encoded, records.size())); }, 1);
+                    Report(name + " decode", seconds, records.size(), encoded.size());
+                }
+
+                void run() {
+                    const std::vector<Data> records = MakeRecords(kRecords);
+                    stream<Serializer, Deserializer>("1e7 records, text stringstream", records, true);
+                    stream<BinarySerializer, BinaryDeserializer>("1e7 records, binary stringstream", records, false);
+
+                    BufferSerializer serializer;
+                    double seconds = MeasureBest([&]() {
+                        serializer.clear();
+                        for (Data record : records) {
+                            serializer.save(record);
+                        }
+                    });
+                    Report("1e7 records, BufferSerializer encode", seconds, records.size(), serializer.size());
+                    seconds = MeasureBest([&]() {
+                        SpanDeserializer deserializer(serializer.data());
+                        uint64_t sum = 0;
+                        Data record;
+                        for (size_t i = 0; i < kRecords; ++i) {
+                            deserializer(record);
+                            sum += record.a + record.c + record.b;
+                        }
+                        Consume(sum);
+                    });
+                    Report("1e7 records, SpanDeserializer decode", seconds, records.size(), serializer.size());
+                }
+            }
+
+            namespace one_field {
+                const size_t kRecords = 10000000;
+                const char* const kPath = "/tmp/made-serializer-layout.bin";
+
+                // 20 fields: 14 integers and 6 flags, 120 bytes in the fixed layout
+                struct Wide {
+                    uint64_t f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13;
+                    bool g0, g1, g2, g3, g4, g5;
+
+                    template <class Serializer>
+                    Error serialize(Serializer& serializer) {
+                        return serializer(f0, f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13, g0, g1, g2, g3, g4, g5);
+                    }
+                };
+
+                Wide MakeWide(uint64_t i) {
+                    return { i, i * 3, i % 1000, i << 20, 7, i % 100, i * i, i + 12345, 0, 1, i / 7, 42, i % 65536, i * 1000000007,
+                        i % 2 == 0, i % 3 == 0, true, false, i % 5 == 0, i % 7 == 0 };
+                }
+
+                void run() {
+                    BufferSerializer binary;
+                    {
+                        LayoutSerializer<Wide> fixed;
+                        fixed.reserve(kRecords);
+                        for (uint64_t i = 0; i < kRecords; ++i) {
+                            Wide record = MakeWide(i);
+                            binary.save(record);
+                            fixed.save(record);
+                        }
+                        std::ofstream file(kPath, std::ios::binary | std::ios::trunc);
+                        file.write(reinterpret_cast<const char*>(fixed.data().data()), static_cast<std::streamsize>(fixed.data().size()));
+                    }
+                    const int fd = ::open(kPath, O_RDONLY);
+                    struct stat status;
+                    ::fstat(fd, &status);
+                    const size_t mapped_size = static_cast<size_t>(status.st_size);
+                    void* mapped = ::mmap(nullptr, mapped_size, PROT_READ, MAP_SHARED, fd, 0);
+                    ::close(fd);
+                    LayoutView<Wide> view;
+                    if (mapped == MAP_FAILED || view.open({ static_cast<const std::byte*>(mapped), mapped_size }) != Error::NoError) {
+                        std::cout << "  cannot map " << kPath << std::endl;
+                        return;
+                    }
+
+                    double seconds = MeasureBest([&]() {
+                        SpanDeserializer deserializer(binary.data());
+                        uint64_t sum = 0;
+                        Wide record;
+                        for (size_t i = 0; i < kRecords; ++i) {
+                            deserializer(record);
+                            sum += record.f7;
+                        }
+                        Consume(sum);
+                    });
+                    Report("1e7 records, varint decode for 1 field", seconds, kRecords, binary.size());
+                    seconds = MeasureBest([&]() {
+                        const auto f7 = view.field(&Wide::f7);
+                        uint64_t sum = 0;
+                        for (size_t i = 0; i < kRecords; ++i) {
+                            sum += view.get(i, f7);
+                        }
+                        Consume(sum);
+                    });
+                    Report("1e7 records, mmap LayoutView 1 field", seconds, kRecords, mapped_size);
+                    seconds = MeasureBest([&]() {
+                        uint64_t sum = 0;
+                        Wide record;
+                        for (size_t i = 0; i < kRecords; ++i) {
+                            view.load(i, record);
+                            sum += record.f7;
+                        }
+                        Consume(sum);
+                    });
+                    Report("1e7 records, mmap LayoutView whole record", seconds, kRecords, mapped_size);
+                    std::cout << "  bytes per record: varint " << std::setprecision(1) << static_cast<double>(binary.size()) / kRecords
+                        << ", fixed layout " << layout::of<Wide>().size << std::endl;
+                    ::munmap(mapped, mapped_size);
+                    std::remove(kPath);
+                }
+            }
+
+            namespace containers {
+                const size_t kValues = 1000000;
+
+                void run() {
+                    std::vector<int32_t> values(kValues);
+                    uint64_t state = 88172645463325252ull;
+                    for (int32_t& value : values) {
+                        state ^= state << 13;
+                        state ^= state >> 7;
+                        state ^= state << 17;
+                        value = static_cast<int32_t>(state);
+                    }
+
+                    BufferSerializer elements;
+                    double seconds = MeasureBest([&]() {
+                        elements.clear();
+                        elements(kValues);
+                        for (int32_t value : values) {
+                            elements(value);
+                        }
+                    });
+                    Report("1e6 ints, per-element varint encode", seconds, kValues, elements.size());
+                    seconds = MeasureBest([&]() {
+                        SpanDeserializer deserializer(elements.data());
+                        uint64_t size;
+                        deserializer(size);
+                        std::vector<int32_t> loaded(size);
+                        for (int32_t& value : loaded) {
+                            deserializer(value);
+                        }
+                        Consume(loaded.back());
+                    });
+                    Report("1e6 ints, per-element varint decode", seconds, kValues, elements.size());
+
+                    BufferSerializer bulk;
+                    seconds = MeasureBest([&]() {
+                        bulk.clear();
+                        bulk(values);
+                    });
+                    Report("1e6 ints, bulk vector encode", seconds, kValues, bulk.size());
+                    seconds = MeasureBest([&]() {
+                        std::vector<int32_t> loaded;
+                        SpanDeserializer(bulk.data()).load(loaded);
+                        Consume(loaded.back());
+                    });
+                    Report("1e6 ints, bulk vector decode", seconds, kValues, bulk.size());
+
+                    std::string text;
+                    seconds = MeasureBest([&]() {
+                        std::stringstream stream;
+                        Serializer(stream).save(values);
+                        text = stream.str();
+                    });
+                    Report("1e6 ints, text vector encode", seconds, kValues, text.size());
+                    seconds = MeasureBest([&]() {
+                        std::stringstream stream(text);
+                        std::vector<int32_t> loaded;
+                        Deserializer(stream).load(loaded);
+                        Consume(loaded.back());
+                    });
+                    Report("1e6 ints, text vector decode", seconds, kValues, text.size());
+                }
+            }
+
+            // Decode rates in integers per second: "Mrec/s" counts integers here
+            namespace varint_decode {
+                const size_t kValues = 10000000;
+
+                struct Distribution {
+                    const char* name;
+                    uint64_t (*make)(uint64_t random, size_t index);
+                };
+
+                void measure(const Distribution& distribution) {
+                    std::vector<uint64_t> values(kValues);
+                    uint64_t state = 88172645463325252ull;
+                    for (size_t i = 0; i < kValues; ++i) {
+                        state ^= state << 13;
+                        state ^= state >> 7;
+                        state ^= state << 17;
+                        values[i] = distribution.make(state, i);
+                    }
+                    BufferSerializer encoded;
+                    encoded(varints(values));
+                    const std::string name = std::string("1e7 ints ") + distribution.name;
+
+                    std::vector<uint64_t> loaded;
+                    double seconds = MeasureBest([&]() {
+                        SpanDeserializer deserializer(encoded.data());
+                        uint64_t size;
+                        deserializer(size);
+                        loaded.resize(size);
+                        for (uint64_t& value : loaded) {
+                            deserializer(value);
+                        }
+                        Consume(loaded.back());
+                    });
+                    Report(name + ", one at a time", seconds, kValues, encoded.size());
+                    seconds = MeasureBest([&]() {
+                        SpanDeserializer deserializer(encoded.data());
+                        deserializer(varints(loaded));
+                        Consume(loaded.back());
+                    });
+                    Report(name + ", varints()", seconds, kValues, encoded.size());
+                }
+
+                void run() {
+                    const Distribution distributions[] = {
+                        { "< 128", [](uint64_t random, size_t) -> uint64_t { return random % 128; } },
+                        { "1-10 bytes", [](uint64_t random, size_t) -> uint64_t { return random >> (random % 64); } },
+                        { "< 2^28", [](uint64_t random, size_t) -> uint64_t { return random % (1ull << 28); } },
+                        { "as Data", [](uint64_t random, size_t index) -> uint64_t {
+                            return index % 3 == 0 ? random % 10000 : index % 3 == 1 ? (random >> 20) & 1 : 1500000000000ull + (random >> 24) % 100000000000ull; } },
+                    };
+                    for (const Distribution& distribution : distributions) {
+                        measure(distribution);
+                    }
+                    std::vector<uint64_t> values(kValues, 1ull << 40);
+                    BufferSerializer fixed;
+                    fixed(values);
+                    const double seconds = MeasureBest([&]() {
+                        std::vector<uint64_t> loaded;
+                        SpanDeserializer(fixed.data()).load(loaded);
+                        Consume(loaded.back());
+                    });
+                    Report("1e7 ints, fixed-width bulk copy", seconds, kValues, fixed.size());
+                }
+            }
+
+            namespace tagged_fields {
+                const size_t kRecords = 10000000;
+
+                struct TaggedData {
+                    uint64_t a;
+                    bool b;
+                    uint64_t c;
+
+                    template <class Serializer>
+                    Error serialize(Serializer& serializer) {
+                        return serializer(made::serializer::tagged<1>(a), made::serializer::tagged<2>(b), made::serializer::tagged<3>(c));
+                    }
+                };
+
+                template <class Record>
+                void measure(const std::string& name, const std::vector<Data>& records) {
+                    BufferSerializer serializer;
+                    double seconds = MeasureBest([&]() {
+                        serializer.clear();
+                        for (const Data& data : records) {
+                            Record record{ data.a, data.b, data.c };
+                            serializer.save(record);
+                        }
+                    });
+                    Report(name + " encode", seconds, records.size(), serializer.size());
+                    seconds = MeasureBest([&]() {
+                        SpanDeserializer deserializer(serializer.data());
+                        uint64_t sum = 0;
+                        Record record;
+                        for (size_t i = 0; i < records.size(); ++i) {
+                            deserializer(record);
+                            sum += record.a + record.c + record.b;
+                        }
+                        Consume(sum);
+                    });
+                    Report(name + " decode", seconds, records.size(), serializer.size());
+                }
+
+                void run() {
+                    const std::vector<Data> records = MakeRecords(kRecords);
+                    measure<Data>("1e7 records, untagged", records);
+                    measure<TaggedData>("1e7 records, tagged", records);
+                }
+            }
+
+            namespace record_streams {
+                const size_t kBatch = 1000000;
+                const size_t kBatches = 250;
+                const char* kPath = "/tmp/made-serializer-records.bin";
+
+                void measure(const std::string& name, record_stream::Options options) {
+                    const std::vector<Data> batch = MakeRecords(kBatch);
+                    const uint64_t records = kBatch * kBatches;
+                    double seconds = MeasureBest([&]() {
+                        std::ofstream file(kPath, std::ios::binary | std::ios::trunc);
+                        RecordWriter writer(file, options);
+                        for (size_t i = 0; i < kBatches; ++i) {
+                            for (Data record : batch) {
+                                writer.write(record);
+                            }
+                        }
+                        writer.close();
+                    }, 1);
+                    std::ifstream size_probe(kPath, std::ios::binary | std::ios::ate);
+                    const double bytes = static_cast<double>(size_probe.tellg());
+                    Report(name + " write", seconds, records, bytes);
+
+                    seconds = MeasureBest([&]() {
+                        std::ifstream file(kPath, std::ios::binary);
+                        RecordReader reader(file);
+                        reader.open();
+                        uint64_t sum = 0;
+                        Data record;
+                        while (reader.read(record) == Error::NoError) {
+                            sum += record.a + record.c + record.b;
+                        }
+                        Consume(sum);
+                    }, 1);
+                    Report(name + " read", seconds, records, bytes);
+
+                    seconds = MeasureBest([&]() {
+                        std::ifstream index_file(kPath, std::ios::binary);
+                        RecordReader index(index_file);
+                        index.open();
+                        uint64_t sum = 0;
+                        for (const record_stream::Range& range : index.split(4)) {
+                            std::ifstream file(kPath, std::ios::binary);
+                            RecordReader reader(file);
+                            reader.open();
+                            reader.seek(range.first);
+                            Data record;
+                            for (uint64_t i = 0; i < range.count && reader.read(record) == Error::NoError; ++i) {
+                                sum += record.a + record.c + record.b;
+                            }
+                        }
+                        Consume(sum);
+                    }, 1);
+                    Report(name + " read 4 ranges", seconds, records, bytes);
+                }
+
+                void run() {
+                    measure("2.5e8 records, crc32c", { 1 << 20, true });
+                    measure("2.5e8 records, no crc", { 1 << 20, false });
+                    measure("2.5e8 records, lz chunks", { 1 << 20, true, true });
+                    std::remove(kPath);
+                }
+            }
+
+            namespace block_compression {
+                const size_t kBlock = 1 << 20;
+
+                // MB/s are of the uncompressed input
+                void measure(const std::string& name, const std::vector<std::byte>& input, size_t records) {
+                    const size_t blocks = (input.size() + kBlock - 1) / kBlock;
+                    std::vector<std::vector<std::byte>> packed(blocks, std::vector<std::byte>(lz::bound(kBlock)));
+                    std::vector<size_t> sizes(blocks);
+                    double seconds = MeasureBest([&]() {
+                        for (size_t i = 0; i < blocks; ++i) {
+                            const size_t size = std::min(kBlock, input.size() - i * kBlock);
+                            sizes[i] = lz::compress(input.data() + i * kBlock, size, packed[i].data());
+                        }
+                    });
+                    Report(name + " compress", seconds, records, input.size());
+                    std::vector<std::byte> output(input.size());
+                    seconds = MeasureBest([&]() {
+                        for (size_t i = 0; i < blocks; ++i) {
+                            const size_t size = std::min(kBlock, input.size() - i * kBlock);
+                            Consume(lz::decompress(packed[i].data(), sizes[i], output.data() + i * kBlock, size));
+                        }
+                    });
+                    Report(name + " decompress", seconds, records, input.size());
+                    size_t total = 0;
+                    for (size_t size : sizes) {
+                        total += size;
+                    }
+                    std::cout << "  " << name << ": " << input.size() << " -> " << total << " bytes, ratio "
+                        << std::setprecision(2) << static_cast<double>(input.size()) / total
+                        << (output == input ? "" : " (MISMATCH)") << std::endl;
+                }
+
+                void run() {
+                    std::vector<Data> records = MakeRecords(10000000);
+                    BufferSerializer binary;
+                    for (Data& record : records) {
+                        binary.save(record);
+                    }
+                    measure("1e7 records binary, 1 MiB", std::vector<std::byte>(binary.data().begin(), binary.data().end()), records.size());
+                    records.resize(2000000);
+                    std::stringstream stream;
+                    Serializer text(stream);
+                    for (Data& record : records) {
+                        text.save(record);
+                    }
+                    const std::string encoded = stream.str();
+                    std::vector<std::byte> bytes(encoded.size());
+                    std::memcpy(bytes.data(), encoded.data(), encoded.size());
+                    measure("2e6 records text, 1 MiB", bytes, records.size());
+                }
+            }
+
+            namespace parallel_batch {
+                // 1e8 records would need about 6 GB for the records, their encoding and
+                // the decoded copy
+                const size_t kRecords = 30000000;
+
+                void run() {
+                    std::vector<Data> records = MakeRecords(kRecords);
+                    BufferSerializer serial;
+                    double seconds = MeasureBest([&]() {
+                        serial.clear();
+                        for (Data& record : records) {
+                            serial.save(record);
+                        }
+                    });
+                    Report("3e7 records, BufferSerializer loop", seconds, kRecords, serial.size());
+                    serial = BufferSerializer();
+
+                    std::vector<std::byte> encoded;
+                    std::vector<Data> decoded;
+                    std::vector<size_t> counts = { 1, 2, 4 };
+                    if (std::thread::hardware_concurrency() > 4) {
+                        counts.push_back(std::thread::hardware_concurrency());
+                    }
+                    for (size_t threads : counts) {
+                        ThreadPool pool(threads);
+                        BatchEncoder encoder(pool);
+                        const std::string name = "3e7 records, " + std::to_string(threads) + " thread(s)";
+                        seconds = MeasureBest([&]() { encoder.encode(std::span<Data>(records), encoded); });
+                        Report(name + " encode", seconds, kRecords, encoded.size());
+                        seconds = MeasureBest([&]() { decode_batch(std::span<const std::byte>(encoded), decoded, pool); });
+                        Report(name + " decode", seconds, kRecords, encoded.size());
+                    }
+                }
+            }
+        }
+
+        std::vector<Benchmark> GetBenchmarks() {
+            return {
+                { "text vs binary format", serializer::text_vs_binary::run },
+                { "text stream vs text blocks", serializer::text_blocks::run },
+                { "buffer archives vs stringstream", serializer::buffer::run },
+                { "one field of twenty", serializer::one_field::run },
+                { "bulk vs per-element arrays", serializer::containers::run },
+                { "bulk varint decode", serializer::varint_decode::run },
+                { "tagged vs untagged records", serializer::tagged_fields::run },
+                { "record stream file", serializer::record_streams::run },
+                { "parallel batches", serializer::parallel_batch::run },
+                { "lz block compression", serializer::block_compression::run },
+            };
+        }
+
+        int RunBenchmarks(const std::string& filter) {
+            std::vector<Benchmark> benchmarks = GetBenchmarks();
+            std::size_t benchmarks_count = benchmarks.size();
+            for (std::size_t i = 0; i < benchmarks_count; ++i) {
+                if (std::string(benchmarks[i].name).find(filter) == std::string::npos) {
+                    continue;
+                }
+                std::cout << "Running benchmark " << i + 1 << "/" << benchmarks_count << "... "
+                    << benchmarks[i].name << std::endl;
+                benchmarks[i].function();
+            }
+            return 0;
+        }
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    made::bench::RunBenchmarks(argc > 1 ? argv[1] : "");
+}
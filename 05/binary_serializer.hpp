@@ -0,0 +1,217 @@
+#pragma once
+#ifndef BINARY_SERIALIZER_H_
+#define BINARY_SERIALIZER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "serializer.hpp"
+#include "buffer_serializer.hpp"
+#include "varint.hpp"
+
+namespace made {
+
+    namespace serializer {
+
+        // Binary counterparts of Serializer and Deserializer for the same serialize()
+        // visitors: unsigned integers and sizes as LEB128 varints (varint.hpp), signed
+        // ones zigzag-encoded first, floating point values as little-endian IEEE bytes,
+        // bool as a single 0/1 byte, no separators. Arrays of arithmetic values are one
+        // block of little-endian fixed-width values, copied in bulk.
+        // Bytes go straight to the stream buffer, stream flags are unused; a short write
+        // is IoError and sets badbit on the stream, as its own operations would.
+        class BinarySerializer : public ArchiveWriter<BinarySerializer>
+        {
+            friend class ArchiveWriter<BinarySerializer>;
+            static constexpr bool BulkCopy = true;
+            using Sizer = BinarySizer;
+        public:
+            explicit BinarySerializer(std::ostream& out) : stream_(out), out_(*out.rdbuf()) {}
+
+            template <class T>
+            Error save(T& object) {
+                return process(object);
+            }
+
+            template <class... ArgsT>
+            Error operator()(ArgsT&&... args) {
+                return process_fields(args...);
+            }
+
+        private:
+            std::ostream& stream_;
+            std::streambuf& out_;
+
+            using ArchiveWriter<BinarySerializer>::process;
+
+            void separate() {}
+
+            Error written(bool complete) {
+                if (complete) {
+                    return Error::NoError;
+                }
+                stream_.setstate(std::ios::badbit);
+                return Error::IoError;
+            }
+
+            Error write_bool(bool value) {
+                return written(out_.sputc(value ? 1 : 0) != std::char_traits<char>::eof());
+            }
+
+            Error write_unsigned(uint64_t value) {
+                uint8_t bytes[varint::MaxBytes];
+                const size_t size = varint::encode(value, bytes);
+                return write_bytes(bytes, size);
+            }
+
+            Error write_signed(int64_t value) {
+                return write_unsigned(varint::zigzag(value));
+            }
+
+            template <class T>
+            Error write_float(T value) {
+                std::byte raw[sizeof(T)];
+                bytes::store(raw, value);
+                return write_bytes(raw, sizeof(T));
+            }
+
+            Error write_bytes(const void* data, size_t size) {
+                return written(out_.sputn(static_cast<const char*>(data), static_cast<std::streamsize>(size)) == static_cast<std::streamsize>(size));
+            }
+
+            template <class T, class... ArgsT>
+            Error process(T& value, ArgsT&... args) {
+                Error error = process(value);
+                if (error != Error::NoError) {
+                    return error;
+                }
+                return process(args...);
+            }
+        };
+
+        class BinaryDeserializer : public ArchiveReader<BinaryDeserializer> {
+            friend class ArchiveReader<BinaryDeserializer>;
+            static constexpr bool BulkCopy = true;
+        public:
+            explicit BinaryDeserializer(std::istream& in) : in_(*in.rdbuf()) {}
+
+            // Like Deserializer::load, the object must take up the rest of the input
+            template <class T>
+            Error load(T& object) {
+                Error result = process(object);
+                if (result == Error::NoError && in_.sgetc() != std::char_traits<char>::eof()) {
+                    return Error::CorruptedArchive;
+                }
+                return result;
+            }
+
+            template <class... ArgsT>
+            Error operator()(ArgsT&&... args) {
+                return process_fields(args...);
+            }
+
+        private:
+            std::streambuf& in_;
+
+            using ArchiveReader<BinaryDeserializer>::process;
+
+            int next() {
+                const std::char_traits<char>::int_type byte = in_.sbumpc();
+                return byte == std::char_traits<char>::eof() ? -1 : static_cast<int>(static_cast<unsigned char>(byte));
+            }
+
+            // A stream does not tell how much is left
+            uint64_t available() const {
+                return std::numeric_limits<uint64_t>::max();
+            }
+
+            Error read_bool(bool& value) {
+                const int byte = next();
+                if (byte != 0 && byte != 1) {
+                    return Error::CorruptedArchive;
+                }
+                value = byte == 1;
+                return Error::NoError;
+            }
+
+            Error read_unsigned(uint64_t& value) {
+                return varint::read([this]() { return next(); }, value) ? Error::NoError : Error::CorruptedArchive;
+            }
+
+            Error read_unsigned(uint64_t* values, size_t count) {
+                for (size_t i = 0; i < count; ++i) {
+                    Error error = read_unsigned(values[i]);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                }
+                return Error::NoError;
+            }
+
+            Error read_signed(int64_t& value) {
+                uint64_t encoded;
+                Error error = read_unsigned(encoded);
+                value = varint::unzigzag(encoded);
+                return error;
+            }
+
+            template <class T>
+            Error read_float(T& value) {
+                std::byte raw[sizeof(T)];
+                Error error = read_bytes(raw, sizeof(T));
+                value = bytes::load<T>(raw);
+                return error;
+            }
+
+            Error read_bytes(void* data, size_t size) {
+                const std::streamsize read = in_.sgetn(static_cast<char*>(data), static_cast<std::streamsize>(size));
+                return read == static_cast<std::streamsize>(size) ? Error::NoError : Error::CorruptedArchive;
+            }
+
+            Error read_more(void* data, size_t size) {
+                return read_bytes(data, size);
+            }
+
+            // Stream payloads are read whole, then decoded from memory
+            template <class T>
+            Error read_field(T& value, size_t length) {
+                std::vector<std::byte> payload;
+                Error error = read_byte_string(payload, length);
+                if (error != Error::NoError) {
+                    return error;
+                }
+                return SpanDeserializer(payload).load(value);
+            }
+
+            Error skip(size_t length) {
+                char discard[256];
+                while (length > 0) {
+                    const size_t chunk = std::min(length, sizeof(discard));
+                    Error error = read_bytes(discard, chunk);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                    length -= chunk;
+                }
+                return Error::NoError;
+            }
+
+            template <class T, class... ArgsT>
+            Error process(T& value, ArgsT&... args) {
+                Error error = process(value);
+                if (error != Error::NoError) {
+                    return error;
+                }
+                return process(args...);
+            }
+        };
+    }
+}
+
+#endif  // !BINARY_SERIALIZER_H_
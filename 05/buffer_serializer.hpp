@@ -0,0 +1,285 @@
+#pragma once
+#ifndef BUFFER_SERIALIZER_H_
+#define BUFFER_SERIALIZER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include "serializer.hpp"
+#include "varint.hpp"
+
+namespace made {
+
+    namespace serializer {
+
+        // Counts the bytes the binary archives write for a value, without writing them
+        class BinarySizer : public ArchiveWriter<BinarySizer>
+        {
+            friend class ArchiveWriter<BinarySizer>;
+            static constexpr bool BulkCopy = true;
+            using Sizer = BinarySizer;
+        public:
+            template <class T>
+            uint64_t measure(T& value) {
+                size_ = 0;
+                process(value);
+                return size_;
+            }
+
+            template <class... ArgsT>
+            Error operator()(ArgsT&&... args) {
+                return process_fields(args...);
+            }
+
+        private:
+            uint64_t size_ = 0;
+
+            using ArchiveWriter<BinarySizer>::process;
+
+            void separate() {}
+
+            Error write_bool(bool) {
+                ++size_;
+                return Error::NoError;
+            }
+
+            Error write_unsigned(uint64_t value) {
+                size_ += varint::size(value);
+                return Error::NoError;
+            }
+
+            Error write_signed(int64_t value) {
+                return write_unsigned(varint::zigzag(value));
+            }
+
+            template <class T>
+            Error write_float(T) {
+                size_ += sizeof(T);
+                return Error::NoError;
+            }
+
+            Error write_bytes(const void*, size_t size) {
+                size_ += size;
+                return Error::NoError;
+            }
+
+            template <class T, class... ArgsT>
+            Error process(T& value, ArgsT&... args) {
+                process(value);
+                return process(args...);
+            }
+        };
+
+        // In-memory archives with the byte format of BinarySerializer: the writer appends
+        // to its own growable buffer, the reader bumps a pointer through a span after a
+        // bounds check. No streams, virtual calls or locales are involved.
+        class BufferSerializer : public ArchiveWriter<BufferSerializer>
+        {
+            friend class ArchiveWriter<BufferSerializer>;
+            static constexpr bool BulkCopy = true;
+            using Sizer = BinarySizer;
+        public:
+            BufferSerializer() = default;
+            explicit BufferSerializer(size_t capacity) : buffer_(capacity) {}
+
+            template <class T>
+            Error save(T& object) {
+                return process(object);
+            }
+
+            template <class... ArgsT>
+            Error operator()(ArgsT&&... args) {
+                return process_fields(args...);
+            }
+
+            std::span<const std::byte> data() const { return { buffer_.data(), size_ }; }
+            size_t size() const { return size_; }
+            // Keeps the capacity for the next records
+            void clear() { size_ = 0; }
+            // Drops what was written after the first `size` bytes
+            void truncate(size_t size) { size_ = std::min(size, size_); }
+
+        private:
+            std::vector<std::byte> buffer_;
+            size_t size_ = 0;
+
+            // Pointer to `bytes` writable bytes at the end of the archive
+            std::byte* reserve(size_t bytes) {
+                if (buffer_.size() - size_ < bytes) {
+                    buffer_.resize(std::max(buffer_.size() * 2, size_ + bytes));
+                }
+                return buffer_.data() + size_;
+            }
+
+            using ArchiveWriter<BufferSerializer>::process;
+
+            void separate() {}
+
+            Error write_bool(bool value) {
+                *reserve(1) = std::byte(value ? 1 : 0);
+                ++size_;
+                return Error::NoError;
+            }
+
+            Error write_unsigned(uint64_t value) {
+                size_ += varint::encode(value, reinterpret_cast<uint8_t*>(reserve(varint::MaxBytes)));
+                return Error::NoError;
+            }
+
+            Error write_signed(int64_t value) {
+                return write_unsigned(varint::zigzag(value));
+            }
+
+            template <class T>
+            Error write_float(T value) {
+                bytes::store(reserve(sizeof(T)), value);
+                size_ += sizeof(T);
+                return Error::NoError;
+            }
+
+            Error write_bytes(const void* data, size_t size) {
+                if (size != 0) {
+                    std::memcpy(reserve(size), data, size);
+                    size_ += size;
+                }
+                return Error::NoError;
+            }
+
+            template <class T, class... ArgsT>
+            Error process(T& value, ArgsT&... args) {
+                Error error = process(value);
+                if (error != Error::NoError) {
+                    return error;
+                }
+                return process(args...);
+            }
+        };
+
+        class SpanDeserializer : public ArchiveReader<SpanDeserializer> {
+            friend class ArchiveReader<SpanDeserializer>;
+            static constexpr bool BulkCopy = true;
+        public:
+            explicit SpanDeserializer(std::span<const std::byte> in)
+                : position_(reinterpret_cast<const uint8_t*>(in.data())), end_(position_ + in.size()) {}
+
+            // Like Deserializer::load, the object must take up the rest of the input
+            template <class T>
+            Error load(T& object) {
+                Error result = process(object);
+                if (result == Error::NoError && position_ != end_) {
+                    return Error::CorruptedArchive;
+                }
+                return result;
+            }
+
+            template <class... ArgsT>
+            Error operator()(ArgsT&&... args) {
+                return process_fields(args...);
+            }
+
+            // Bytes not read yet
+            size_t remaining() const { return static_cast<size_t>(end_ - position_); }
+
+        private:
+            const uint8_t* position_;
+            const uint8_t* end_;
+
+            using ArchiveReader<SpanDeserializer>::process;
+
+            uint64_t available() const {
+                return remaining();
+            }
+
+            Error read_bool(bool& value) {
+                if (position_ == end_ || *position_ > 1) {
+                    return Error::CorruptedArchive;
+                }
+                value = *position_++ == 1;
+                return Error::NoError;
+            }
+
+            Error read_unsigned(uint64_t& value) {
+                // Single-byte values (below 128) skip the general decoder
+                if (position_ != end_ && *position_ < 0x80) {
+                    value = *position_++;
+                    return Error::NoError;
+                }
+                const uint8_t* next = varint::decode(position_, end_, value);
+                if (!next) {
+                    return Error::CorruptedArchive;
+                }
+                position_ = next;
+                return Error::NoError;
+            }
+
+            Error read_unsigned(uint64_t* values, size_t count) {
+                return varint::decode_many(position_, end_, values, count) == count ? Error::NoError : Error::CorruptedArchive;
+            }
+
+            Error read_signed(int64_t& value) {
+                uint64_t encoded;
+                Error error = read_unsigned(encoded);
+                value = varint::unzigzag(encoded);
+                return error;
+            }
+
+            template <class T>
+            Error read_float(T& value) {
+                if (remaining() < sizeof(T)) {
+                    return Error::CorruptedArchive;
+                }
+                value = bytes::load<T>(reinterpret_cast<const std::byte*>(position_));
+                position_ += sizeof(T);
+                return Error::NoError;
+            }
+
+            Error read_bytes(void* data, size_t size) {
+                if (remaining() < size) {
+                    return Error::CorruptedArchive;
+                }
+                if (size != 0) {
+                    std::memcpy(data, position_, size);
+                    position_ += size;
+                }
+                return Error::NoError;
+            }
+
+            Error read_more(void* data, size_t size) {
+                return read_bytes(data, size);
+            }
+
+            template <class T>
+            Error read_field(T& value, size_t length) {
+                if (remaining() < length) {
+                    return Error::CorruptedArchive;
+                }
+                SpanDeserializer payload({ reinterpret_cast<const std::byte*>(position_), length });
+                position_ += length;
+                return payload.load(value);
+            }
+
+            Error skip(size_t length) {
+                if (remaining() < length) {
+                    return Error::CorruptedArchive;
+                }
+                position_ += length;
+                return Error::NoError;
+            }
+
+            template <class T, class... ArgsT>
+            Error process(T& value, ArgsT&... args) {
+                Error error = process(value);
+                if (error != Error::NoError) {
+                    return error;
+                }
+                return process(args...);
+            }
+        };
+    }
+}
+
+#endif  // !BUFFER_SERIALIZER_H_
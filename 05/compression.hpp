@@ -0,0 +1,245 @@
+#pragma once
+#ifndef COMPRESSION_H_
+#define COMPRESSION_H_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace made {
+
+    namespace serializer {
+
+        // LZ77 block compression in the LZ4 block format. A block is a run of sequences,
+        // each a token byte (literal count in the high nibble, match length - 4 in the
+        // low one; 15 means more length bytes follow, each added until one is below
+        // 255), the literals, a 2-byte little-endian match offset and the extra match
+        // length bytes. The last sequence has literals only; no match starts in the last
+        // MatchLimit bytes or covers the last LastLiterals. Blocks share no state, so
+        // any number of them can be decompressed side by side.
+        namespace lz {
+            constexpr size_t MinMatch = 4;
+            constexpr size_t LastLiterals = 5;
+            constexpr size_t MatchLimit = 12;
+            constexpr size_t MaxOffset = 65535;
+            // 16 KiB of match table, which stays in L1. 14 bits compress serializer text
+            // about 10% smaller at half the speed.
+            constexpr int HashBits = 12;
+
+            // Largest compressed size of `size` bytes
+            constexpr size_t bound(size_t size) {
+                return size + size / 255 + 16;
+            }
+
+            namespace detail {
+                inline uint32_t read32(const uint8_t* in) {
+                    uint32_t value;
+                    std::memcpy(&value, in, sizeof(value));
+                    return value;
+                }
+
+                inline uint64_t read64(const uint8_t* in) {
+                    uint64_t value;
+                    std::memcpy(&value, in, sizeof(value));
+                    return value;
+                }
+
+                // Of the 5 bytes at `in`: 4-byte matches are seldom worth a sequence
+                inline uint32_t hash(const uint8_t* in) {
+                    return static_cast<uint32_t>(((read64(in) << 24) * 889523592379ull) >> (64 - HashBits));
+                }
+
+                // Bytes from a and b that are equal, stopping at limit
+                inline size_t common(const uint8_t* a, const uint8_t* b, const uint8_t* limit) {
+                    const uint8_t* const start = a;
+                    if constexpr (std::endian::native == std::endian::little) {
+                        for (; a + 8 <= limit; a += 8, b += 8) {
+                            const uint64_t difference = read64(a) ^ read64(b);
+                            if (difference != 0) {
+                                return static_cast<size_t>(a - start) + std::countr_zero(difference) / 8;
+                            }
+                        }
+                    }
+                    for (; a < limit && *a == *b; ++a, ++b) {
+                    }
+                    return static_cast<size_t>(a - start);
+                }
+
+                // The bytes after a nibble of 15
+                inline uint8_t* write_length(uint8_t* out, size_t length) {
+                    for (; length >= 255; length -= 255) {
+                        *out++ = 255;
+                    }
+                    *out++ = static_cast<uint8_t>(length);
+                    return out;
+                }
+
+                inline bool read_length(const uint8_t*& in, const uint8_t* end, size_t& length) {
+                    uint8_t byte;
+                    do {
+                        if (in == end) {
+                            return false;
+                        }
+                        byte = *in++;
+                        length += byte;
+                    } while (byte == 255);
+                    return true;
+                }
+
+                inline uint8_t* write_literals(uint8_t* out, uint8_t* token, const uint8_t* literals, size_t count) {
+                    *token = static_cast<uint8_t>(std::min<size_t>(count, 15) << 4);
+                    if (count >= 15) {
+                        out = write_length(out, count - 15);
+                    }
+                    if (count != 0) {
+                        std::memcpy(out, literals, count);
+                    }
+                    return out + count;
+                }
+            }
+
+            // Compresses `size` bytes into out, which has room for bound(size) bytes, and
+            // returns the compressed size. Greedy matching against a hash table of the
+            // last position of every 4-byte sequence, stepping faster through input that
+            // keeps missing.
+            inline size_t compress(const std::byte* input, size_t size, std::byte* output) {
+                const uint8_t* const in = reinterpret_cast<const uint8_t*>(input);
+                const uint8_t* const end = in + size;
+                uint8_t* out = reinterpret_cast<uint8_t*>(output);
+                const uint8_t* anchor = in;     // first byte not yet written
+                if (size > MatchLimit) {
+                    std::array<uint32_t, 1 << HashBits> table{};
+                    const uint8_t* const last_start = end - MatchLimit;
+                    const uint8_t* const match_end = end - LastLiterals;
+                    const uint8_t* position = in + 1;
+                    size_t misses = 0;
+                    while (position <= last_start) {
+                        const uint32_t sequence = detail::read32(position);
+                        uint32_t& slot = table[detail::hash(position)];
+                        const uint8_t* match = in + slot;
+                        slot = static_cast<uint32_t>(position - in);
+                        if (match >= position || static_cast<size_t>(position - match) > MaxOffset || detail::read32(match) != sequence) {
+                            position += 1 + (misses++ >> 6);
+                            continue;
+                        }
+                        misses = 0;
+                        while (position > anchor && match > in && position[-1] == match[-1]) {
+                            --position;
+                            --match;
+                        }
+                        const size_t length = MinMatch + detail::common(position + MinMatch, match + MinMatch, match_end);
+                        uint8_t* token = out++;
+                        out = detail::write_literals(out, token, anchor, static_cast<size_t>(position - anchor));
+                        const size_t offset = static_cast<size_t>(position - match);
+                        *out++ = static_cast<uint8_t>(offset);
+                        *out++ = static_cast<uint8_t>(offset >> 8);
+                        *token |= static_cast<uint8_t>(std::min<size_t>(length - MinMatch, 15));
+                        if (length - MinMatch >= 15) {
+                            out = detail::write_length(out, length - MinMatch - 15);
+                        }
+                        position += length;
+                        anchor = position;
+                        if (position <= last_start) {
+                            table[detail::hash(position - 2)] = static_cast<uint32_t>(position - 2 - in);
+                        }
+                    }
+                }
+                uint8_t* token = out++;
+                out = detail::write_literals(out, token, anchor, static_cast<size_t>(end - anchor));
+                return static_cast<size_t>(out - reinterpret_cast<uint8_t*>(output));
+            }
+
+            // Decompresses a block into exactly `size` bytes; false if the block is
+            // corrupted or does not decompress to that size. Never reads or writes out of
+            // the given ranges.
+            inline bool decompress(const std::byte* input, size_t input_size, std::byte* output, size_t size) {
+                const uint8_t* in = reinterpret_cast<const uint8_t*>(input);
+                const uint8_t* const in_end = in + input_size;
+                uint8_t* const begin = reinterpret_cast<uint8_t*>(output);
+                uint8_t* const end = begin + size;
+                uint8_t* out = begin;
+                while (in != in_end) {
+                    const uint8_t token = *in++;
+                    size_t literals = token >> 4;
+                    if (literals != 15 && in_end - in >= 32 && end - out >= 32) {
+                        // Short literals away from both ends, the common case, as one
+                        // fixed-size copy; a match must follow
+                        std::memcpy(out, in, 16);
+                        in += literals;
+                        out += literals;
+                    }
+                    else {
+                        if (literals == 15 && !detail::read_length(in, in_end, literals)) {
+                            return false;
+                        }
+                        if (literals > static_cast<size_t>(in_end - in) || literals > static_cast<size_t>(end - out)) {
+                            return false;
+                        }
+                        if (literals != 0) {
+                            std::memcpy(out, in, literals);
+                        }
+                        in += literals;
+                        out += literals;
+                        if (in == in_end) {
+                            return out == end;
+                        }
+                        if (in_end - in < 2) {
+                            return false;
+                        }
+                    }
+
+                    const size_t offset = in[0] | static_cast<size_t>(in[1]) << 8;
+                    in += 2;
+                    size_t length = token & 15;
+                    if (length != 15 && offset >= 8 && offset <= static_cast<size_t>(out - begin) && end - out >= 18) {
+                        // At most 18 bytes from at least 8 back: three copies that do not
+                        // overlap what they read
+                        const uint8_t* match = out - offset;
+                        std::memcpy(out, match, 8);
+                        std::memcpy(out + 8, match + 8, 8);
+                        std::memcpy(out + 16, match + 16, 2);
+                        out += length + MinMatch;
+                        continue;
+                    }
+                    if (length == 15 && !detail::read_length(in, in_end, length)) {
+                        return false;
+                    }
+                    length += MinMatch;
+                    if (offset == 0 || offset > static_cast<size_t>(out - begin) || length > static_cast<size_t>(end - out)) {
+                        return false;
+                    }
+                    const uint8_t* match = out - offset;
+                    uint8_t* const copy_end = out + length;
+                    if (end - copy_end >= 8) {
+                        // Copies 8 bytes at a time and may write up to 7 bytes past the
+                        // match, which later sequences overwrite. A match closer than 8
+                        // bytes repeats with period `offset`: after its first 8 bytes it
+                        // can be copied from the nearest multiple of the period >= 8.
+                        if (offset < 8) {
+                            for (int i = 0; i < 8; ++i) {
+                                out[i] = match[i];
+                            }
+                            out += 8;
+                            match = out - offset * ((8 + offset - 1) / offset);
+                        }
+                        for (; out < copy_end; out += 8, match += 8) {
+                            std::memcpy(out, match, 8);
+                        }
+                        out = copy_end;
+                    }
+                    else {
+                        for (; out < copy_end; ++out, ++match) {
+                            *out = *match;
+                        }
+                    }
+                }
+                return false;
+            }
+        }
+    }
+}
+
+#endif  // !COMPRESSION_H_
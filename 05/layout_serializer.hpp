@@ -0,0 +1,298 @@
+#pragma once
+#ifndef LAYOUT_SERIALIZER_H_
+#define LAYOUT_SERIALIZER_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "serializer.hpp"
+
+namespace made {
+
+    namespace serializer {
+
+        // Fixed-layout archives: an array of equally sized records whose fields sit at
+        // fixed, naturally aligned offsets in little-endian order, so a field of any
+        // record is read in place without decoding the ones before it. The offsets come
+        // from the order serialize() visits the fields; nested structs are flattened.
+        //
+        // Archive: a 32-byte header (Magic, uint32 record size, uint32 field count, uint64
+        // record count, uint64 layout hash), then the records. Record sizes are multiples
+        // of 8, so fields stay aligned in an mmap'd file.
+        namespace layout {
+            constexpr char Magic[8] = { 'M', 'A', 'D', 'E', 'L', 'A', 'Y', '\0' };
+            constexpr size_t HeaderSize = 32;
+            constexpr size_t RecordAlignment = 8;
+
+            enum class Kind : uint8_t { Unsigned, Signed, Floating, Bool };
+
+            struct Field {
+                size_t offset;          // in the record
+                size_t size;
+                Kind kind;
+                size_t member_offset;   // of the visited object in the struct, or NotMember
+            };
+            constexpr size_t NotMember = ~size_t(0);
+
+            struct RecordLayout {
+                std::vector<Field> fields;
+                size_t size = 0;
+                uint64_t hash = 0;      // of field offsets, sizes and kinds, tells layouts apart
+            };
+
+            template <class T>
+            constexpr Kind kind_of() {
+                if constexpr (std::is_same<T, bool>::value) {
+                    return Kind::Bool;
+                }
+                else if constexpr (std::is_floating_point<T>::value) {
+                    return Kind::Floating;
+                }
+                else {
+                    return std::is_signed<T>::value ? Kind::Signed : Kind::Unsigned;
+                }
+            }
+
+            inline size_t align(size_t offset, size_t alignment) {
+                return (offset + alignment - 1) / alignment * alignment;
+            }
+
+            // Visits the fields of one object, handing every arithmetic field with its
+            // offset in the record to `Visit::field`. Every fixed-layout archive below walks
+            // records with it, so they all agree on the offsets.
+            template <class Visit>
+            class Walker
+            {
+            public:
+                explicit Walker(Visit& visit) : visit_(visit) {}
+
+                template <class... ArgsT>
+                Error operator()(ArgsT&&... args) {
+                    return process(args...);
+                }
+
+                size_t offset() const { return offset_; }
+
+            private:
+                Visit& visit_;
+                size_t offset_ = 0;
+
+                template <class T>
+                Error process(T& value) {
+                    if constexpr (std::is_arithmetic<T>::value) {
+                        offset_ = align(offset_, sizeof(T));
+                        Error error = visit_.field(value, offset_);
+                        offset_ += sizeof(T);
+                        return error;
+                    }
+                    else if constexpr (traits::IsTagged<T>::value) {
+                        // Fixed layouts are versioned by their hash, tags only mark the fields
+                        return process(value.value);
+                    }
+                    else {
+                        static_assert(traits::SerializableWith<T, Walker>, "fixed layout holds arithmetic fields and nested structs only");
+                        return value.serialize(*this);
+                    }
+                }
+
+                template <class T, class... ArgsT>
+                Error process(T& value, ArgsT&... args) {
+                    Error error = process(value);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                    return process(args...);
+                }
+            };
+
+            // Records every field with the offset of the member it came from
+            template <class T>
+            struct Planner {
+                const T& object;
+                RecordLayout& layout;
+
+                template <class M>
+                Error field(M& value, size_t offset) {
+                    const char* address = reinterpret_cast<const char*>(&value);
+                    const char* base = reinterpret_cast<const char*>(&object);
+                    const bool member = address >= base && address < base + sizeof(T);
+                    layout.fields.push_back({ offset, sizeof(M), kind_of<M>(), member ? static_cast<size_t>(address - base) : NotMember });
+                    return Error::NoError;
+                }
+            };
+
+            template <class T>
+            RecordLayout plan() {
+                T sample{};
+                RecordLayout layout;
+                Planner<T> planner{ sample, layout };
+                Walker<Planner<T>> walker(planner);
+                sample.serialize(walker);
+                layout.size = std::max(align(walker.offset(), RecordAlignment), RecordAlignment);
+                // FNV-1a
+                layout.hash = 14695981039346656037ull;
+                for (const Field& field : layout.fields) {
+                    for (uint64_t value : { static_cast<uint64_t>(field.offset), static_cast<uint64_t>(field.size), static_cast<uint64_t>(field.kind) }) {
+                        layout.hash = (layout.hash ^ value) * 1099511628211ull;
+                    }
+                }
+                return layout;
+            }
+
+            // Computed once per record type
+            template <class T>
+            const RecordLayout& of() {
+                static const RecordLayout layout = plan<T>();
+                return layout;
+            }
+        }
+
+        // Writes records of type T into a fixed-layout archive held in memory
+        template <class T>
+        class LayoutSerializer
+        {
+        public:
+            LayoutSerializer() : layout_(layout::of<T>()), buffer_(layout::HeaderSize) {
+                std::memcpy(buffer_.data(), layout::Magic, sizeof(layout::Magic));
+                bytes::store(&buffer_[8], static_cast<uint32_t>(layout_.size));
+                bytes::store(&buffer_[12], static_cast<uint32_t>(layout_.fields.size()));
+                bytes::store(&buffer_[24], layout_.hash);
+                update_count();
+            }
+
+            void reserve(size_t records) {
+                buffer_.reserve(layout::HeaderSize + records * layout_.size);
+            }
+
+            Error save(T& object) {
+                const size_t begin = buffer_.size();
+                buffer_.resize(begin + layout_.size);
+                Writer writer{ buffer_.data() + begin };
+                layout::Walker<Writer> walker(writer);
+                Error error = object.serialize(walker);
+                if (error != Error::NoError) {
+                    buffer_.resize(begin);
+                    return error;
+                }
+                ++count_;
+                update_count();
+                return Error::NoError;
+            }
+
+            // Header and records
+            std::span<const std::byte> data() const { return buffer_; }
+            size_t count() const { return count_; }
+
+        private:
+            struct Writer {
+                std::byte* record;
+
+                template <class M>
+                Error field(M& value, size_t offset) {
+                    bytes::store(record + offset, value);
+                    return Error::NoError;
+                }
+            };
+
+            void update_count() {
+                bytes::store(&buffer_[16], static_cast<uint64_t>(count_));
+            }
+
+            const layout::RecordLayout& layout_;
+            std::vector<std::byte> buffer_;
+            size_t count_ = 0;
+        };
+
+        // Read-only view over a fixed-layout archive of T records, e.g. an mmap'd file.
+        // Nothing is copied: get() reads one field of one record where it lies, without
+        // checking the index against size().
+        template <class T>
+        class LayoutView {
+        public:
+            // Typed position of a field in the record, looked up once by member pointer
+            template <class M>
+            struct FieldRef {
+                size_t offset;
+            };
+
+            // CorruptedArchive if the span is not an archive of T records
+            Error open(std::span<const std::byte> archive) {
+                const layout::RecordLayout& expected = layout::of<T>();
+                if (archive.size() < layout::HeaderSize
+                    || std::memcmp(archive.data(), layout::Magic, sizeof(layout::Magic)) != 0
+                    || bytes::load<uint32_t>(&archive[8]) != expected.size
+                    || bytes::load<uint32_t>(&archive[12]) != expected.fields.size()
+                    || bytes::load<uint64_t>(&archive[24]) != expected.hash) {
+                    return Error::CorruptedArchive;
+                }
+                const uint64_t count = bytes::load<uint64_t>(&archive[16]);
+                if (count > (archive.size() - layout::HeaderSize) / expected.size) {
+                    return Error::CorruptedArchive;
+                }
+                records_ = archive.data() + layout::HeaderSize;
+                record_size_ = expected.size;
+                count_ = static_cast<size_t>(count);
+                return Error::NoError;
+            }
+
+            size_t size() const { return count_; }
+
+            // std::invalid_argument if serialize() does not visit the member
+            template <class M>
+            FieldRef<M> field(M T::* member) const {
+                const T sample{};
+                const size_t member_offset = static_cast<size_t>(
+                    reinterpret_cast<const char*>(&(sample.*member)) - reinterpret_cast<const char*>(&sample));
+                for (const layout::Field& field : layout::of<T>().fields) {
+                    if (field.member_offset == member_offset && field.size == sizeof(M) && field.kind == layout::kind_of<M>()) {
+                        return { field.offset };
+                    }
+                }
+                throw std::invalid_argument("member is not serialized");
+            }
+
+            template <class M>
+            M get(size_t index, FieldRef<M> field) const {
+                return bytes::load<M>(records_ + index * record_size_ + field.offset);
+            }
+
+            template <class M>
+            M get(size_t index, M T::* member) const {
+                return get(index, field(member));
+            }
+
+            // Reads every field of one record into object
+            Error load(size_t index, T& object) const {
+                if (index >= count_) {
+                    return Error::CorruptedArchive;
+                }
+                Reader reader{ records_ + index * record_size_ };
+                layout::Walker<Reader> walker(reader);
+                return object.serialize(walker);
+            }
+
+        private:
+            struct Reader {
+                const std::byte* record;
+
+                template <class M>
+                Error field(M& value, size_t offset) {
+                    value = bytes::load<M>(record + offset);
+                    return Error::NoError;
+                }
+            };
+
+            const std::byte* records_ = nullptr;
+            size_t record_size_ = 0;
+            size_t count_ = 0;
+        };
+    }
+}
+
+#endif  // !LAYOUT_SERIALIZER_H_
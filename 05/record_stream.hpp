@@ -0,0 +1,489 @@
+#pragma once
+#ifndef RECORD_STREAM_H_
+#define RECORD_STREAM_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#include "buffer_serializer.hpp"
+#include "compression.hpp"
+#include "varint.hpp"
+
+namespace made {
+
+    namespace serializer {
+
+        // Record streams: archives of any number of records, written and read a chunk at
+        // a time, so neither side holds more than one chunk in memory.
+        //
+        // File: a 16-byte header (Magic, uint32 flags, uint32 reserved), the chunks, then
+        // the chunk index and a 32-byte trailer. A chunk is a 24-byte header (ChunkMagic,
+        // uint32 record count, uint32 payload size, uint32 CRC-32C of the payload or 0,
+        // uint64 index of its first record) followed by the payload: every record as a
+        // varint length and its bytes in the BufferSerializer format. The index holds a
+        // uint64 offset and a uint64 first record per chunk; the trailer is IndexMagic,
+        // the uint64 index offset, chunk count and record count. All little-endian.
+        // A file whose writer never got to close() has no index: readers rebuild it from
+        // the chunk headers and drop a torn last chunk.
+        //
+        // With CompressionFlag set, a chunk payload is the uint32 size of the records
+        // followed by the records compressed as one lz block, or stored as they are when
+        // that is not smaller. The CRC covers the payload as written. Chunks stay
+        // independent, so the readers of split() ranges decompress side by side.
+        namespace record_stream {
+            constexpr char Magic[8] = { 'M', 'A', 'D', 'E', 'R', 'E', 'C', '\0' };
+            constexpr char IndexMagic[8] = { 'M', 'A', 'D', 'E', 'I', 'D', 'X', '\0' };
+            constexpr uint32_t ChunkMagic = 0x4B4E4843;     // "CHNK"
+            constexpr uint32_t ChecksumFlag = 1;
+            constexpr uint32_t CompressionFlag = 2;
+            constexpr size_t HeaderSize = 16;
+            constexpr size_t ChunkHeaderSize = 24;
+            constexpr size_t IndexEntrySize = 16;
+            constexpr size_t TrailerSize = 32;
+            // Records of a chunk, leaving room for the size in front of compressed ones
+            constexpr uint64_t MaxPayload = std::numeric_limits<uint32_t>::max() - sizeof(uint32_t);
+
+            struct Options {
+                size_t chunk_bytes = 1 << 20;   // payload size at which a chunk is written out
+                bool checksums = true;
+                bool compression = false;       // lz blocks of chunk_bytes, see compression.hpp
+            };
+
+            struct Chunk {
+                uint64_t offset;                // of its header in the file
+                uint64_t first_record;
+            };
+
+            // Records [first, first + count), e.g. the share of one parallel reader
+            struct Range {
+                uint64_t first;
+                uint64_t count;
+            };
+
+            // CRC-32C (Castagnoli), with the SSE4.2 instruction where the target has it
+            namespace crc32c {
+                constexpr std::array<uint32_t, 256> make_table() {
+                    std::array<uint32_t, 256> table{};
+                    for (uint32_t i = 0; i < 256; ++i) {
+                        uint32_t crc = i;
+                        for (int bit = 0; bit < 8; ++bit) {
+                            crc = crc & 1 ? (crc >> 1) ^ 0x82F63B78u : crc >> 1;
+                        }
+                        table[i] = crc;
+                    }
+                    return table;
+                }
+
+                inline constexpr std::array<uint32_t, 256> Table = make_table();
+
+                inline uint32_t compute(const std::byte* data, size_t size) {
+                    uint32_t crc = ~0u;
+#if defined(__SSE4_2__)
+                    for (; size >= 8; size -= 8, data += 8) {
+                        uint64_t word;
+                        std::memcpy(&word, data, sizeof(word));
+                        crc = static_cast<uint32_t>(_mm_crc32_u64(crc, word));
+                    }
+                    for (; size > 0; --size, ++data) {
+                        crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*data));
+                    }
+#else
+                    for (; size > 0; --size, ++data) {
+                        crc = Table[(crc ^ static_cast<uint8_t>(*data)) & 0xFF] ^ (crc >> 8);
+                    }
+#endif
+                    return ~crc;
+                }
+            }
+        }
+
+        // Appends records to a record stream; close() writes the index. The destructor
+        // closes a stream left open, ignoring errors.
+        class RecordWriter
+        {
+        public:
+            explicit RecordWriter(std::ostream& out, record_stream::Options options = {})
+                : out_(out), options_(options), chunk_(options.chunk_bytes + options.chunk_bytes / 8) {
+                std::byte header[record_stream::HeaderSize] = {};
+                std::memcpy(header, record_stream::Magic, sizeof(record_stream::Magic));
+                bytes::store(header + 8, (options_.checksums ? record_stream::ChecksumFlag : 0u)
+                    | (options_.compression ? record_stream::CompressionFlag : 0u));
+                out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+                offset_ = sizeof(header);
+            }
+
+            RecordWriter(const RecordWriter&) = delete;
+            RecordWriter& operator=(const RecordWriter&) = delete;
+
+            ~RecordWriter() {
+                if (!closed_) {
+                    close();
+                }
+            }
+
+            template <class T>
+            Error write(T& record) {
+                if (closed_) {
+                    throw std::logic_error("record stream is closed");
+                }
+                const uint64_t size = BinarySizer().measure(record);
+                if (size + varint::MaxBytes > record_stream::MaxPayload) {
+                    throw std::length_error("record does not fit a chunk");
+                }
+                if (chunk_.size() + size + varint::MaxBytes > record_stream::MaxPayload) {
+                    Error error = flush();
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                }
+                const size_t begin = chunk_.size();
+                chunk_(size);
+                Error error = chunk_.save(record);
+                if (error != Error::NoError) {
+                    chunk_.truncate(begin);
+                    return error;
+                }
+                ++chunk_records_;
+                return chunk_.size() >= options_.chunk_bytes ? flush() : Error::NoError;
+            }
+
+            // Writes out the records buffered so far as a chunk
+            Error flush() {
+                if (chunk_records_ == 0) {
+                    return status();
+                }
+                const std::byte* payload = chunk_.data().data();
+                size_t size = chunk_.size();
+                if (options_.compression) {
+                    packed_.resize(std::max(packed_.size(), sizeof(uint32_t) + lz::bound(size)));
+                    bytes::store(packed_.data(), static_cast<uint32_t>(size));
+                    size_t packed = lz::compress(payload, size, packed_.data() + sizeof(uint32_t));
+                    if (packed >= size) {
+                        std::memcpy(packed_.data() + sizeof(uint32_t), payload, size);
+                        packed = size;
+                    }
+                    payload = packed_.data();
+                    size = sizeof(uint32_t) + packed;
+                }
+                std::byte header[record_stream::ChunkHeaderSize];
+                bytes::store(header, record_stream::ChunkMagic);
+                bytes::store(header + 4, chunk_records_);
+                bytes::store(header + 8, static_cast<uint32_t>(size));
+                bytes::store(header + 12, options_.checksums ? record_stream::crc32c::compute(payload, size) : 0u);
+                bytes::store(header + 16, written_);
+                out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+                out_.write(reinterpret_cast<const char*>(payload), static_cast<std::streamsize>(size));
+                index_.push_back({ offset_, written_ });
+                offset_ += sizeof(header) + size;
+                written_ += chunk_records_;
+                chunk_.clear();
+                chunk_records_ = 0;
+                return status();
+            }
+
+            // Flushes the last chunk and writes the index and the trailer
+            Error close() {
+                Error error = flush();
+                closed_ = true;
+                if (error != Error::NoError) {
+                    return error;
+                }
+                std::vector<std::byte> index(index_.size() * record_stream::IndexEntrySize + record_stream::TrailerSize);
+                std::byte* entry = index.data();
+                for (const record_stream::Chunk& chunk : index_) {
+                    bytes::store(entry, chunk.offset);
+                    bytes::store(entry + 8, chunk.first_record);
+                    entry += record_stream::IndexEntrySize;
+                }
+                std::memcpy(entry, record_stream::IndexMagic, sizeof(record_stream::IndexMagic));
+                bytes::store(entry + 8, offset_);
+                bytes::store(entry + 16, static_cast<uint64_t>(index_.size()));
+                bytes::store(entry + 24, written_);
+                out_.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size()));
+                out_.flush();
+                return status();
+            }
+
+            // Records written, buffered ones included
+            uint64_t count() const { return written_ + chunk_records_; }
+
+        private:
+            Error status() const {
+                return out_ ? Error::NoError : Error::IoError;
+            }
+
+            std::ostream& out_;
+            record_stream::Options options_;
+            BufferSerializer chunk_;        // records of the chunk being filled
+            std::vector<std::byte> packed_; // the chunk compressed
+            uint32_t chunk_records_ = 0;
+            uint64_t written_ = 0;          // records in flushed chunks
+            uint64_t offset_ = 0;           // of the next chunk
+            std::vector<record_stream::Chunk> index_;
+            bool closed_ = false;
+        };
+
+        // Reads a record stream from a seekable input. Readers of one file are
+        // independent, so a file is decoded in parallel by giving every worker its own
+        // stream and reader and one of the ranges of split(); position() and seek()
+        // resume reading where an earlier reader stopped.
+        class RecordReader {
+        public:
+            explicit RecordReader(std::istream& in) : in_(in) {}
+
+            // Reads the header and the chunk index, or rebuilds the index if the file
+            // was not closed
+            Error open() {
+                in_.clear();
+                in_.seekg(0, std::ios::end);
+                const std::streamoff end = in_.tellg();
+                if (end < static_cast<std::streamoff>(record_stream::HeaderSize)) {
+                    return in_ ? Error::CorruptedArchive : Error::IoError;
+                }
+                size_ = static_cast<uint64_t>(end);
+                std::byte header[record_stream::HeaderSize];
+                if (!read_at(0, header, sizeof(header))) {
+                    return Error::IoError;
+                }
+                if (std::memcmp(header, record_stream::Magic, sizeof(record_stream::Magic)) != 0) {
+                    return Error::CorruptedArchive;
+                }
+                checksums_ = (bytes::load<uint32_t>(header + 8) & record_stream::ChecksumFlag) != 0;
+                compressed_ = (bytes::load<uint32_t>(header + 8) & record_stream::CompressionFlag) != 0;
+                chunks_.clear();
+                count_ = 0;
+                if (!read_index()) {
+                    scan();
+                }
+                return seek(0);
+            }
+
+            uint64_t count() const { return count_; }
+            const std::vector<record_stream::Chunk>& chunks() const { return chunks_; }
+            // Index of the next record read() returns
+            uint64_t position() const { return position_; }
+
+            // EndOfArchive after the last record
+            template <class T>
+            Error read(T& record) {
+                while (cursor_ == payload_.size()) {
+                    if (next_chunk_ == chunks_.size()) {
+                        return Error::EndOfArchive;
+                    }
+                    Error error = load(next_chunk_);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                }
+                const uint8_t* data = reinterpret_cast<const uint8_t*>(payload_.data());
+                uint64_t size;
+                const uint8_t* begin = varint::decode(data + cursor_, data + payload_.size(), size);
+                if (!begin || size > static_cast<uint64_t>(data + payload_.size() - begin)) {
+                    return Error::CorruptedArchive;
+                }
+                cursor_ = static_cast<size_t>(begin - data) + static_cast<size_t>(size);
+                ++position_;
+                return SpanDeserializer({ reinterpret_cast<const std::byte*>(begin), static_cast<size_t>(size) }).load(record);
+            }
+
+            // Positions the reader before record `index`, at most count()
+            Error seek(uint64_t index) {
+                if (index > count_) {
+                    return Error::CorruptedArchive;
+                }
+                payload_.clear();
+                cursor_ = 0;
+                position_ = index;
+                if (index == count_) {
+                    next_chunk_ = chunks_.size();
+                    return Error::NoError;
+                }
+                auto chunk = std::upper_bound(chunks_.begin(), chunks_.end(), index,
+                    [](uint64_t record, const record_stream::Chunk& chunk) { return record < chunk.first_record; });
+                Error error = load(static_cast<size_t>(chunk - chunks_.begin() - 1));
+                const uint8_t* data = reinterpret_cast<const uint8_t*>(payload_.data());
+                for (; error == Error::NoError && position_ < index; ++position_) {
+                    uint64_t size;
+                    const uint8_t* begin = varint::decode(data + cursor_, data + payload_.size(), size);
+                    if (!begin || size > static_cast<uint64_t>(data + payload_.size() - begin)) {
+                        error = Error::CorruptedArchive;
+                        break;
+                    }
+                    cursor_ = static_cast<size_t>(begin - data) + static_cast<size_t>(size);
+                }
+                return error;
+            }
+
+            // Up to `parts` ranges of about equal record counts, covering the file and
+            // starting at chunk boundaries so no two readers load the same chunk
+            std::vector<record_stream::Range> split(size_t parts) const {
+                if (parts == 0) {
+                    throw std::invalid_argument("split into no parts");
+                }
+                std::vector<record_stream::Range> ranges;
+                uint64_t first = 0;
+                for (size_t part = 1; part <= parts && first < count_; ++part) {
+                    uint64_t end = count_;
+                    if (part < parts) {
+                        const uint64_t target = count_ / parts * part + count_ % parts * part / parts;
+                        auto chunk = std::lower_bound(chunks_.begin(), chunks_.end(), target,
+                            [](const record_stream::Chunk& chunk, uint64_t record) { return chunk.first_record < record; });
+                        end = chunk == chunks_.end() ? count_ : chunk->first_record;
+                    }
+                    if (end > first) {
+                        ranges.push_back({ first, end - first });
+                        first = end;
+                    }
+                }
+                return ranges;
+            }
+
+        private:
+            bool read_at(uint64_t offset, void* data, size_t size) {
+                in_.clear();
+                in_.seekg(static_cast<std::streamoff>(offset));
+                in_.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+                return static_cast<size_t>(in_.gcount()) == size;
+            }
+
+            uint64_t records_in(size_t chunk) const {
+                return (chunk + 1 < chunks_.size() ? chunks_[chunk + 1].first_record : count_) - chunks_[chunk].first_record;
+            }
+
+            // From the trailer; false if there is none or it does not add up
+            bool read_index() {
+                if (size_ < record_stream::HeaderSize + record_stream::TrailerSize) {
+                    return false;
+                }
+                std::byte trailer[record_stream::TrailerSize];
+                if (!read_at(size_ - sizeof(trailer), trailer, sizeof(trailer))
+                    || std::memcmp(trailer, record_stream::IndexMagic, sizeof(record_stream::IndexMagic)) != 0) {
+                    return false;
+                }
+                const uint64_t offset = bytes::load<uint64_t>(trailer + 8);
+                const uint64_t chunks = bytes::load<uint64_t>(trailer + 16);
+                const uint64_t count = bytes::load<uint64_t>(trailer + 24);
+                if (offset < record_stream::HeaderSize || offset > size_ - sizeof(trailer)
+                    || chunks != (size_ - sizeof(trailer) - offset) / record_stream::IndexEntrySize
+                    || (size_ - sizeof(trailer) - offset) % record_stream::IndexEntrySize != 0) {
+                    return false;
+                }
+                std::vector<std::byte> index(static_cast<size_t>(chunks) * record_stream::IndexEntrySize);
+                if (!read_at(offset, index.data(), index.size())) {
+                    return false;
+                }
+                std::vector<record_stream::Chunk> entries(static_cast<size_t>(chunks));
+                for (size_t i = 0; i < entries.size(); ++i) {
+                    const std::byte* entry = index.data() + i * record_stream::IndexEntrySize;
+                    entries[i] = { bytes::load<uint64_t>(entry), bytes::load<uint64_t>(entry + 8) };
+                    const uint64_t min_offset = i == 0 ? record_stream::HeaderSize : entries[i - 1].offset + record_stream::ChunkHeaderSize;
+                    const uint64_t min_first = i == 0 ? 0 : entries[i - 1].first_record + 1;
+                    if (entries[i].offset < min_offset || entries[i].offset + record_stream::ChunkHeaderSize > offset
+                        || (i == 0 ? entries[i].first_record != 0 : entries[i].first_record < min_first)
+                        || entries[i].first_record >= count) {
+                        return false;
+                    }
+                }
+                if (entries.empty() && count != 0) {
+                    return false;
+                }
+                chunks_ = std::move(entries);
+                count_ = count;
+                return true;
+            }
+
+            // Walks the chunk headers up to the first one that is torn or not a chunk
+            void scan() {
+                uint64_t offset = record_stream::HeaderSize;
+                std::byte header[record_stream::ChunkHeaderSize];
+                while (offset + sizeof(header) <= size_ && read_at(offset, header, sizeof(header))) {
+                    const uint32_t records = bytes::load<uint32_t>(header + 4);
+                    const uint32_t payload = bytes::load<uint32_t>(header + 8);
+                    if (bytes::load<uint32_t>(header) != record_stream::ChunkMagic || records == 0
+                        || bytes::load<uint64_t>(header + 16) != count_ || offset + sizeof(header) + payload > size_) {
+                        break;
+                    }
+                    chunks_.push_back({ offset, count_ });
+                    count_ += records;
+                    offset += sizeof(header) + payload;
+                }
+            }
+
+            Error load(size_t chunk) {
+                std::byte header[record_stream::ChunkHeaderSize];
+                if (!read_at(chunks_[chunk].offset, header, sizeof(header))) {
+                    return Error::CorruptedArchive;
+                }
+                const uint32_t payload = bytes::load<uint32_t>(header + 8);
+                if (bytes::load<uint32_t>(header) != record_stream::ChunkMagic
+                    || bytes::load<uint32_t>(header + 4) != records_in(chunk)
+                    || bytes::load<uint64_t>(header + 16) != chunks_[chunk].first_record
+                    || chunks_[chunk].offset + sizeof(header) + payload > size_) {
+                    return Error::CorruptedArchive;
+                }
+                std::vector<std::byte>& stored = compressed_ ? packed_ : payload_;
+                stored.resize(payload);
+                if (!read_at(chunks_[chunk].offset + sizeof(header), stored.data(), payload)) {
+                    return Error::CorruptedArchive;
+                }
+                if (checksums_ && record_stream::crc32c::compute(stored.data(), payload) != bytes::load<uint32_t>(header + 12)) {
+                    return Error::CorruptedArchive;
+                }
+                size_t first = 0;
+                if (compressed_ && !unpack(first)) {
+                    return Error::CorruptedArchive;
+                }
+                cursor_ = first;
+                position_ = chunks_[chunk].first_record;
+                next_chunk_ = chunk + 1;
+                return Error::NoError;
+            }
+
+            // Leaves the records of packed_ in payload_ from `first` on. A block expands
+            // at most about 255 times, which bounds what a corrupted size can allocate.
+            bool unpack(size_t& first) {
+                if (packed_.size() < sizeof(uint32_t)) {
+                    return false;
+                }
+                const size_t size = bytes::load<uint32_t>(packed_.data());
+                const size_t packed = packed_.size() - sizeof(uint32_t);
+                if (size == packed) {
+                    payload_.swap(packed_);
+                    first = sizeof(uint32_t);
+                    return true;
+                }
+                if (size < packed || size / 256 > packed) {
+                    return false;
+                }
+                payload_.resize(size);
+                return lz::decompress(packed_.data() + sizeof(uint32_t), packed, payload_.data(), size);
+            }
+
+            std::istream& in_;
+            uint64_t size_ = 0;             // of the file
+            bool checksums_ = false;
+            bool compressed_ = false;
+            std::vector<record_stream::Chunk> chunks_;
+            uint64_t count_ = 0;
+            size_t next_chunk_ = 0;         // loaded when the current one is used up
+            std::vector<std::byte> payload_;
+            std::vector<std::byte> packed_; // a compressed chunk as read
+            size_t cursor_ = 0;             // in payload_
+            uint64_t position_ = 0;
+        };
+    }
+}
+
+#endif  // !RECORD_STREAM_H_
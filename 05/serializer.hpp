@@ -2,34 +2,108 @@
 #ifndef SERIALIZER_H_
 #define SERIALIZER_H_
 
+#include <charconv>
+#include <cstdint>
+#include <istream>
+#include <limits>
 #include <ostream>
+#include <sstream>
+#include <string>
 #include <type_traits>
 
+#include "archive.hpp"
+
 namespace made {
 
     namespace serializer {
-        enum class Error
+        // Counts the characters Serializer writes for a value, without writing them
+        class TextSizer : public ArchiveWriter<TextSizer>
         {
-            NoError,
-            CorruptedArchive
+            friend class ArchiveWriter<TextSizer>;
+            static constexpr bool BulkCopy = false;
+            using Sizer = TextSizer;
+        public:
+            template <class T>
+            uint64_t measure(T& value) {
+                size_ = 0;
+                process(value);
+                return size_;
+            }
+
+            template <class... ArgsT>
+            Error operator()(ArgsT&&... args) {
+                return process_fields(args...);
+            }
+
+        private:
+            uint64_t size_ = 0;
+
+            using ArchiveWriter<TextSizer>::process;
+
+            void separate() {
+                ++size_;
+            }
+
+            Error write_bool(bool value) {
+                size_ += value ? 4 : 5;
+                return Error::NoError;
+            }
+
+            template <class T>
+            Error write_number(T value) {
+                char text[32];
+                size_ += static_cast<uint64_t>(std::to_chars(text, text + sizeof(text), value).ptr - text);
+                return Error::NoError;
+            }
+
+            Error write_unsigned(uint64_t value) {
+                return write_number(value);
+            }
+
+            Error write_signed(int64_t value) {
+                return write_number(value);
+            }
+
+            template <class T>
+            Error write_float(T value) {
+                return write_number(value);
+            }
+
+            Error write_bytes(const void*, size_t size) {
+                size_ += size;
+                return Error::NoError;
+            }
+
+            template <class T, class... ArgsT>
+            Error process(T& value, ArgsT&... args) {
+                process(value);
+                separate();
+                return process(args...);
+            }
         };
 
-        class Serializer
+        // Text archive: values separated by spaces, bool as "true"/"false", floating
+        // point values in their shortest round-trip form. Strings are their length,
+        // a space and the raw characters.
+        class Serializer : public ArchiveWriter<Serializer>
         {
+            friend class ArchiveWriter<Serializer>;
             static constexpr char Separator = ' ';
+            static constexpr bool BulkCopy = false;
+            using Sizer = TextSizer;
         public:
             explicit Serializer(std::ostream& out) : out_(out) {}
 
             template <class T>
             Error save(T& object) {
-                return object.serialize(*this);
+                return (*this)(object);
             }
 
             template <class... ArgsT>
-            Error operator()(ArgsT... args) {
+            Error operator()(ArgsT&&... args) {
                 auto flags = out_.flags();
                 out_ << std::boolalpha; // interpret boolean as "true"/"false" string instead of "0"/"1"
-                auto result = process(args...);
+                auto result = process_fields(args...);
                 out_.flags(flags);
                 return result;
             }
@@ -37,48 +111,70 @@ namespace made {
         private:
             std::ostream& out_;
 
-            template <class T>
-            Error process(T& value) {
-                return value.serialize(*this);
+            using ArchiveWriter<Serializer>::process;
+
+            void separate() {
+                out_ << Separator;
+            }
+
+            Error write_bool(bool value) {
+                out_ << value;
+                return Error::NoError;
             }
 
-            Error process(bool value) {
+            Error write_unsigned(uint64_t value) {
                 out_ << value;
                 return Error::NoError;
             }
 
-            Error process(uint64_t value) {
+            Error write_signed(int64_t value) {
                 out_ << value;
                 return Error::NoError;
             }
 
+            template <class T>
+            Error write_float(T value) {
+                char text[32];
+                const std::to_chars_result result = std::to_chars(text, text + sizeof(text), value);
+                out_.write(text, result.ptr - text);
+                return Error::NoError;
+            }
+
+            Error write_bytes(const void* data, size_t size) {
+                out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                return Error::NoError;
+            }
+
             template <class T, class... ArgsT>
             Error process(T& value, ArgsT&... args) {
                 Error error = process(value);
                 if (error != Error::NoError) {
                     return error;
                 }
-                out_ << Separator;
+                separate();
                 return process(args...);
             }
         };
 
-        class Deserializer {
+        class Deserializer : public ArchiveReader<Deserializer> {
+            friend class ArchiveReader<Deserializer>;
+            static constexpr char Separator = ' ';
+            static constexpr bool BulkCopy = false;
         public:
             explicit Deserializer(std::istream& in) : in_(in) {}
 
             template <class T>
             Error load(T& object) {
-                Error result = object.serialize(*this);
-                if (!in_.eof()) return Error::CorruptedArchive;
+                Error result = (*this)(object);
+                if (result == Error::NoError && in_.peek() != std::char_traits<char>::eof()) return Error::CorruptedArchive;
                 return result;
             }
 
             template <class... ArgsT>
-            Error operator()(ArgsT&... args) {
+            Error operator()(ArgsT&&... args) {
                 auto flags = in_.flags();
                 in_ >> std::boolalpha; // interpret boolean as "true"/"false" string instead of "0"/"1"
-                auto result = process(args...);
+                auto result = process_fields(args...);
                 in_.flags(flags);
                 return result;
             }
@@ -86,21 +182,87 @@ namespace made {
         private:
             std::istream& in_;
 
-            template <class T>
-            Error process(T& value) {
-                return value.serialize(*this);
+            using ArchiveReader<Deserializer>::process;
+
+            Error status() const {
+                return in_.fail() ? Error::CorruptedArchive : Error::NoError;
+            }
+
+            // Text gives no bound on the sizes ahead
+            uint64_t available() const {
+                return std::numeric_limits<uint64_t>::max();
             }
 
-            Error process(bool& value) {
+            Error read_bool(bool& value) {
                 in_ >> value;
+                return status();
+            }
+
+            Error read_unsigned(uint64_t& value) {
+                in_ >> value;
+                return status();
+            }
+
+            Error read_unsigned(uint64_t* values, size_t count) {
+                for (size_t i = 0; i < count; ++i) {
+                    Error error = read_unsigned(values[i]);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                }
                 return Error::NoError;
             }
 
-            Error process(uint64_t& value) {
+            Error read_signed(int64_t& value) {
                 in_ >> value;
+                return status();
+            }
+
+            // Through from_chars, which unlike operator>> reads back "inf" and "nan"
+            template <class T>
+            Error read_float(T& value) {
+                std::string text;
+                in_ >> text;
+                const char* end = text.data() + text.size();
+                if (in_.fail() || std::from_chars(text.data(), end, value).ptr != end) {
+                    return Error::CorruptedArchive;
+                }
                 return Error::NoError;
             }
 
+            // The single separator after the length, then the raw bytes
+            Error read_bytes(void* data, size_t size) {
+                if (in_.get() != Separator) {
+                    return Error::CorruptedArchive;
+                }
+                in_.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+                return status();
+            }
+
+            Error read_more(void* data, size_t size) {
+                in_.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+                return status();
+            }
+
+            template <class T>
+            Error read_field(T& value, size_t length) {
+                std::string payload;
+                Error error = read_byte_string(payload, length);
+                if (error != Error::NoError) {
+                    return error;
+                }
+                std::istringstream stream(payload);
+                return Deserializer(stream).load(value);
+            }
+
+            Error skip(size_t length) {
+                if (in_.get() != Separator) {
+                    return Error::CorruptedArchive;
+                }
+                in_.ignore(static_cast<std::streamsize>(length));
+                return in_.gcount() == static_cast<std::streamsize>(length) ? Error::NoError : Error::CorruptedArchive;
+            }
+
             template <class T, class... ArgsT>
             Error process(T& value, ArgsT&... args) {
                 Error error = process(value);
@@ -2,8 +2,21 @@
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <array>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <algorithm>
 
 #include "serializer.hpp"
+#include "binary_serializer.hpp"
+#include "buffer_serializer.hpp"
+#include "layout_serializer.hpp"
+#include "compression.hpp"
+#include "record_stream.hpp"
+#include "batch.hpp"
+#include "text_serializer.hpp"
+#include "../08/vector.hpp"
 
 
 namespace made {
@@ -26,6 +39,27 @@ namespace made {
                 }
             };
 
+            struct Nested {
+                bool flag;
+                Data data;
+                uint64_t tail;
+
+                template <class Serializer>
+                Error serialize(Serializer& serializer) {
+                    return serializer(flag, data, tail);
+                }
+            };
+
+            struct PartlySerialized {
+                uint64_t skipped;
+                uint64_t kept;
+
+                template <class Serializer>
+                Error serialize(Serializer& serializer) {
+                    return serializer(kept);
+                }
+            };
+
             bool create_serializer() {
                 std::cout << "serializer";
                 std::stringstream stream;
@@ -68,6 +102,973 @@ namespace made {
                 Data data;
                 return (deserializer.load(data) == Error::CorruptedArchive);
             }
+
+            bool check_varint_sizes() {
+                std::cout << "varint sizes at 7-bit boundaries";
+                uint8_t bytes[varint::MaxBytes];
+                return varint::size(0) == 1 && varint::size(127) == 1 && varint::size(128) == 2
+                    && varint::size(UINT64_MAX) == varint::MaxBytes
+                    && varint::encode(300, bytes) == 2 && bytes[0] == 0xAC && bytes[1] == 0x02;
+            }
+
+            // decode_many() against decode() called until it fails or `count` is reached
+            bool same_as_decode(const std::vector<uint8_t>& in, size_t count) {
+                std::vector<uint64_t> bulk(count), single(count);
+                const uint8_t* end = in.data() + in.size();
+                const uint8_t* position = in.data();
+                const size_t decoded = varint::decode_many(position, end, bulk.data(), count);
+                const uint8_t* expected = in.data();
+                size_t i = 0;
+                for (; i < count; ++i) {
+                    const uint8_t* next = varint::decode(expected, end, single[i]);
+                    if (!next)
+                        break;
+                    expected = next;
+                }
+                return decoded == i && position == expected && std::equal(bulk.begin(), bulk.begin() + i, single.begin());
+            }
+
+            bool check_varint_decode_many() {
+                std::cout << "bulk varint decode matches decode()";
+                // Every length, with runs of single bytes
+                std::vector<uint8_t> encoded;
+                std::vector<size_t> ends;
+                uint64_t state = 88172645463325252ull;
+                for (size_t i = 0; i < 5000; ++i) {
+                    state ^= state << 13;
+                    state ^= state >> 7;
+                    state ^= state << 17;
+                    const uint64_t value = i % 200 < 50 ? state % 128 : state >> (state % 64);
+                    uint8_t bytes[varint::MaxBytes];
+                    encoded.insert(encoded.end(), bytes, bytes + varint::encode(value, bytes));
+                    ends.push_back(encoded.size());
+                }
+                for (size_t count : { 0, 1, 7, 4999, 5000, 6000 }) {
+                    if (!same_as_decode(encoded, count))
+                        return false;
+                }
+                for (size_t size = 0; size < 400; ++size) {
+                    if (!same_as_decode(std::vector<uint8_t>(encoded.begin(), encoded.begin() + size), 5000))
+                        return false;
+                }
+                // Past 64 bits, and longer than any value
+                const std::vector<uint8_t> overflow = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02 };
+                const std::vector<uint8_t> overlong = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00 };
+                for (const std::vector<uint8_t>& bad : { overflow, overlong }) {
+                    std::vector<uint8_t> input(encoded.begin(), encoded.begin() + ends[299]);
+                    input.insert(input.end(), bad.begin(), bad.end());
+                    input.insert(input.end(), encoded.begin() + ends[299], encoded.end());
+                    if (!same_as_decode(input, 5001))
+                        return false;
+                }
+                uint64_t max;
+                const uint8_t largest[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+                return varint::decode_array(largest, largest + sizeof(largest), &max, 1) == largest + sizeof(largest) && max == UINT64_MAX;
+            }
+
+            bool check_binary_round_trip() {
+                std::cout << "binary round trip";
+                std::stringstream stream;
+                BinarySerializer serializer(stream);
+                Data data{ 0, true, 1 };
+                if (serializer.save(data) != Error::NoError || stream.str() != std::string("\x00\x01\x01", 3))
+                    return false;
+                Data loaded{ 5, false, 5 };
+                BinaryDeserializer deserializer(stream);
+                return deserializer.load(loaded) == Error::NoError && loaded.a == 0 && loaded.b && loaded.c == 1;
+            }
+
+            bool check_binary_large_values() {
+                std::cout << "binary round trip of 64-bit values";
+                std::stringstream stream;
+                BinarySerializer serializer(stream);
+                Data data{ UINT64_MAX, false, uint64_t(1) << 63 };
+                serializer.save(data);
+                Data loaded;
+                BinaryDeserializer deserializer(stream);
+                return stream.str().size() == 1 + 2 * varint::MaxBytes && deserializer.load(loaded) == Error::NoError
+                    && loaded.a == UINT64_MAX && !loaded.b && loaded.c == uint64_t(1) << 63;
+            }
+
+            bool check_binary_corrupted() {
+                std::cout << "binary corrupted archives";
+                const std::string archives[] = {
+                    std::string("\x00\x01", 2),       // truncated
+                    std::string("\x00\x02\x01", 3),   // bool is not 0 or 1
+                    std::string("\x00\x01\x01\x01", 4), // trailing bytes
+                    std::string("\x00\x01\x81", 3),   // truncated varint
+                    std::string("\x00\x01\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x02", 12), // over 64 bits
+                };
+                for (const std::string& archive : archives) {
+                    std::stringstream stream(archive);
+                    BinaryDeserializer deserializer(stream);
+                    Data data;
+                    if (deserializer.load(data) != Error::CorruptedArchive)
+                        return false;
+                }
+                return true;
+            }
+
+            // Takes `room` bytes, then fails every write like a full disk
+            class FullBuffer : public std::streambuf {
+            public:
+                explicit FullBuffer(size_t room) : room_(room) {}
+            protected:
+                int_type overflow(int_type c) override {
+                    if (room_ == 0 || traits_type::eq_int_type(c, traits_type::eof()))
+                        return traits_type::eof();
+                    --room_;
+                    return c;
+                }
+                std::streamsize xsputn(const char*, std::streamsize count) override {
+                    const std::streamsize taken = std::min(count, static_cast<std::streamsize>(room_));
+                    room_ -= static_cast<size_t>(taken);
+                    return taken;
+                }
+            private:
+                size_t room_;
+            };
+
+            bool check_binary_write_failure() {
+                std::cout << "binary writes to a full stream";
+                Data data{ 300, true, 1 << 20 };
+                std::stringstream full;
+                BinarySerializer(full).save(data);
+                const size_t size = full.str().size();
+                for (size_t room = 0; room <= size; ++room) {
+                    FullBuffer buffer(room);
+                    std::ostream stream(&buffer);
+                    const Error expected = room == size ? Error::NoError : Error::IoError;
+                    if (BinarySerializer(stream).save(data) != expected || stream.bad() != (room < size))
+                        return false;
+                }
+                std::string text(1 << 20, 'x');
+                FullBuffer buffer(1 << 10);
+                std::ostream stream(&buffer);
+                return BinarySerializer(stream).save(text) == Error::IoError && stream.bad();
+            }
+
+            bool check_buffer_matches_binary() {
+                std::cout << "buffer archive matches the binary stream format";
+                std::stringstream stream;
+                BinarySerializer binary(stream);
+                BufferSerializer buffer(4);
+                for (uint64_t i = 0; i < 100; ++i) {
+                    Data data{ i * i * i * 1000003, i % 3 == 0, UINT64_MAX - i };
+                    binary.save(data);
+                    buffer.save(data);
+                }
+                const std::string expected = stream.str();
+                return buffer.size() == expected.size()
+                    && std::memcmp(buffer.data().data(), expected.data(), expected.size()) == 0;
+            }
+
+            bool check_span_round_trip() {
+                std::cout << "span deserializer reads records back";
+                BufferSerializer buffer;
+                for (uint64_t i = 0; i < 100; ++i) {
+                    Data data{ i << 40, i % 2 == 0, i };
+                    buffer.save(data);
+                }
+                SpanDeserializer deserializer(buffer.data());
+                for (uint64_t i = 0; i < 100; ++i) {
+                    Data data;
+                    if (deserializer(data) != Error::NoError || data.a != i << 40 || data.b != (i % 2 == 0) || data.c != i)
+                        return false;
+                }
+                Data data;
+                return deserializer.remaining() == 0 && deserializer(data) == Error::CorruptedArchive;
+            }
+
+            bool check_span_corrupted() {
+                std::cout << "span deserializer corrupted archives";
+                BufferSerializer buffer;
+                Data data{ 300, true, 1 };
+                buffer.save(data);
+                const std::span<const std::byte> bytes = buffer.data();
+                Data loaded;
+                if (SpanDeserializer(bytes).load(loaded) != Error::NoError || loaded.a != 300)
+                    return false;
+                for (size_t size = 0; size < bytes.size(); ++size) {
+                    if (SpanDeserializer(bytes.first(size)).load(loaded) != Error::CorruptedArchive)
+                        return false;
+                }
+                const std::byte trailing[] = { std::byte(0), std::byte(1), std::byte(1), std::byte(0) };
+                const std::byte bad_bool[] = { std::byte(0), std::byte(7), std::byte(1) };
+                return SpanDeserializer(trailing).load(loaded) == Error::CorruptedArchive
+                    && SpanDeserializer(bad_bool).load(loaded) == Error::CorruptedArchive;
+            }
+
+            bool check_layout_offsets() {
+                std::cout << "fixed layout offsets follow serialize()";
+                const layout::RecordLayout& data = layout::of<Data>();
+                const layout::RecordLayout& nested = layout::of<Nested>();
+                return data.size == 24 && data.fields.size() == 3
+                    && data.fields[0].offset == 0 && data.fields[1].offset == 8 && data.fields[2].offset == 16
+                    && nested.size == 40 && nested.fields.size() == 5
+                    && nested.fields[1].offset == 8 && nested.fields[2].offset == 16 && nested.fields[4].offset == 32
+                    && data.hash != nested.hash;
+            }
+
+            bool check_layout_view() {
+                std::cout << "fixed layout view reads fields in place";
+                LayoutSerializer<Nested> serializer;
+                for (uint64_t i = 0; i < 50; ++i) {
+                    Nested record{ i % 2 == 1, { i, i % 3 == 0, i * 1000 }, UINT64_MAX - i };
+                    serializer.save(record);
+                }
+                const std::span<const std::byte> archive = serializer.data();
+                if (archive.size() != layout::HeaderSize + 50 * 40 || reinterpret_cast<uintptr_t>(archive.data()) % 8 != 0)
+                    return false;
+                LayoutView<Nested> view;
+                if (view.open(archive) != Error::NoError || view.size() != 50)
+                    return false;
+                const auto tail = view.field(&Nested::tail);
+                Nested loaded;
+                if (view.load(49, loaded) != Error::NoError || !loaded.flag || loaded.data.a != 49 || loaded.data.c != 49000)
+                    return false;
+                try {
+                    LayoutView<PartlySerialized>().field(&PartlySerialized::skipped);
+                    return false;
+                }
+                catch (std::invalid_argument&) {
+                }
+                return view.get(7, tail) == UINT64_MAX - 7 && view.get(9, &Nested::flag) && !view.get(10, &Nested::flag)
+                    // Data::c of record 1 is 1000, little-endian at offset 24
+                    && std::to_integer<int>(archive[layout::HeaderSize + 40 + 24]) == 0xE8
+                    && std::to_integer<int>(archive[layout::HeaderSize + 40 + 25]) == 0x03;
+            }
+
+            bool check_layout_view_rejects() {
+                std::cout << "fixed layout view rejects other archives";
+                LayoutSerializer<Data> serializer;
+                Data data{ 1, true, 2 };
+                serializer.save(data);
+                std::vector<std::byte> archive(serializer.data().begin(), serializer.data().end());
+                LayoutView<Data> data_view;
+                LayoutView<Nested> nested_view;
+                if (data_view.open(archive) != Error::NoError || nested_view.open(archive) != Error::CorruptedArchive)
+                    return false;
+                archive.pop_back();
+                if (data_view.open(archive) != Error::CorruptedArchive)
+                    return false;
+                archive[0] = std::byte('X');
+                return data_view.open(archive) == Error::CorruptedArchive;
+            }
+
+            enum class Color : uint8_t { Red = 1, Green = 200 };
+
+            struct Rich {
+                int8_t small = 0;
+                int32_t medium = 0;
+                int64_t large = 0;
+                float ratio = 0;
+                double precise = 0;
+                Color color = Color::Red;
+                std::string name;
+                std::vector<int32_t> values;
+                std::vector<Data> records;
+                std::array<uint16_t, 3> triple{};
+                std::optional<std::string> present;
+                std::optional<std::string> absent;
+                std::map<std::string, std::vector<double>> series;
+                std::pair<uint32_t, std::string> tagged;
+                made::stl::Vector<uint64_t> own;
+
+                template <class Serializer>
+                Error serialize(Serializer& serializer) {
+                    return serializer(small, medium, large, ratio, precise, color, name, values, records, triple, present, absent, series, tagged, own);
+                }
+            };
+
+            Rich make_rich() {
+                Rich rich;
+                rich.small = -128;
+                rich.medium = -70000;
+                rich.large = INT64_MIN;
+                rich.ratio = 0.1f;
+                rich.precise = -1.0 / 3;
+                rich.color = Color::Green;
+                rich.name = "two words\nand a line";
+                rich.values = { 0, -1, 1, INT32_MIN, INT32_MAX };
+                rich.records = { { 1, true, 2 }, { 3, false, UINT64_MAX } };
+                rich.triple = { 7, 0, 65535 };
+                rich.present = "";
+                rich.series = { { "a", { 1.5, -2 } }, { "", {} } };
+                rich.tagged = { 42, "x" };
+                rich.own.push_back(5);
+                rich.own.push_back(1ull << 40);
+                return rich;
+            }
+
+            bool same(const Rich& lhs, const Rich& rhs) {
+                const bool own = lhs.own.size() == rhs.own.size() && std::equal(lhs.own.data(), lhs.own.data() + lhs.own.size(), rhs.own.data());
+                bool records = lhs.records.size() == rhs.records.size();
+                for (size_t i = 0; records && i < lhs.records.size(); ++i) {
+                    records = lhs.records[i].a == rhs.records[i].a && lhs.records[i].b == rhs.records[i].b && lhs.records[i].c == rhs.records[i].c;
+                }
+                return lhs.small == rhs.small && lhs.medium == rhs.medium && lhs.large == rhs.large
+                    && lhs.ratio == rhs.ratio && lhs.precise == rhs.precise && lhs.color == rhs.color
+                    && lhs.name == rhs.name && lhs.values == rhs.values && records && lhs.triple == rhs.triple
+                    && lhs.present == rhs.present && lhs.absent == rhs.absent && lhs.series == rhs.series
+                    && lhs.tagged == rhs.tagged && own;
+            }
+
+            bool check_standard_types_round_trip() {
+                std::cout << "strings, containers, signed and floating values round trip";
+                Rich rich = make_rich();
+                std::stringstream text;
+                std::stringstream binary;
+                BufferSerializer buffer;
+                if (Serializer(text).save(rich) != Error::NoError || BinarySerializer(binary).save(rich) != Error::NoError || buffer.save(rich) != Error::NoError)
+                    return false;
+                Rich from_text, from_binary, from_span;
+                from_text.absent = from_binary.absent = from_span.absent = "stale";
+                return Deserializer(text).load(from_text) == Error::NoError && same(rich, from_text)
+                    && BinaryDeserializer(binary).load(from_binary) == Error::NoError && same(rich, from_binary)
+                    && SpanDeserializer(buffer.data()).load(from_span) == Error::NoError && same(rich, from_span);
+            }
+
+            bool check_standard_types_text() {
+                std::cout << "text format of strings and containers";
+                std::stringstream stream;
+                Serializer serializer(stream);
+                int32_t number = -5;
+                double fraction = 0.1;
+                std::string name = "a b";
+                std::vector<uint64_t> values = { 1, 2 };
+                std::optional<bool> flag = true;
+                std::map<uint64_t, bool> map = { { 3, false } };
+                serializer(number, fraction, name, values, flag, map);
+                return stream.str() == "-5 0.1 3 a b 2 1 2 true true 1 3 false";
+            }
+
+            bool check_bulk_format() {
+                std::cout << "binary arrays of arithmetic values are copied in bulk";
+                BufferSerializer buffer;
+                std::vector<int32_t> values = { 1, -2 };
+                std::array<double, 1> one = { 1.0 };
+                buffer(values, one);
+                const unsigned char expected[] = { 2, 1, 0, 0, 0, 0xFE, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0, 0, 0, 0xF0, 0x3F };
+                if (buffer.size() != sizeof(expected) || std::memcmp(buffer.data().data(), expected, sizeof(expected)) != 0)
+                    return false;
+                std::vector<int32_t> loaded;
+                std::array<double, 1> loaded_one{};
+                SpanDeserializer deserializer(buffer.data());
+                return deserializer(loaded, loaded_one) == Error::NoError && loaded == values && loaded_one == one;
+            }
+
+            struct Counters {
+                std::vector<uint64_t> hits;
+                std::vector<uint16_t> ports;
+
+                template <class Serializer>
+                Error serialize(Serializer& serializer) {
+                    return serializer(varints(hits), varints(ports));
+                }
+            };
+
+            bool check_varint_arrays() {
+                std::cout << "integer arrays written as varints";
+                Counters counters;
+                for (uint64_t i = 0; i < 1000; ++i) {
+                    counters.hits.push_back(i % 10 == 0 ? i << 40 : i % 100);
+                }
+                counters.ports = { 80, 443, 65535 };
+                std::stringstream text;
+                std::stringstream binary;
+                BufferSerializer buffer;
+                if (Serializer(text).save(counters) != Error::NoError || BinarySerializer(binary).save(counters) != Error::NoError
+                    || buffer.save(counters) != Error::NoError || buffer.size() >= 2000)
+                    return false;
+                Counters from_text, from_binary, from_span;
+                if (Deserializer(text).load(from_text) != Error::NoError || BinaryDeserializer(binary).load(from_binary) != Error::NoError
+                    || SpanDeserializer(buffer.data()).load(from_span) != Error::NoError)
+                    return false;
+                for (const Counters* loaded : { &from_text, &from_binary, &from_span }) {
+                    if (loaded->hits != counters.hits || loaded->ports != counters.ports)
+                        return false;
+                }
+                std::stringstream small;
+                std::vector<uint64_t> values = { 3, 300 };
+                Serializer small_serializer(small);
+                small_serializer(varints(values));
+                if (small.str() != "2 3 300")
+                    return false;
+                for (size_t size = 0; size < buffer.size(); ++size) {
+                    if (SpanDeserializer(buffer.data().first(size)).load(from_span) != Error::CorruptedArchive)
+                        return false;
+                }
+                // A value too large for the element type
+                BufferSerializer wide;
+                std::vector<uint64_t> ports = { 65536 };
+                wide(varints(ports), varints(ports));
+                return SpanDeserializer(wide.data()).load(from_span) == Error::CorruptedArchive;
+            }
+
+            bool check_standard_types_corrupted() {
+                std::cout << "corrupted sizes and out of range values";
+                BufferSerializer buffer;
+                std::vector<int32_t> values = { 1, 2, 3 };
+                buffer(values);
+                std::vector<int32_t> loaded;
+                for (size_t size = 0; size < buffer.size(); ++size) {
+                    if (SpanDeserializer(buffer.data().first(size)).load(loaded) != Error::CorruptedArchive)
+                        return false;
+                }
+                // A huge size fails before anything is allocated
+                const std::byte huge[] = { std::byte(0xFF), std::byte(0xFF), std::byte(0xFF), std::byte(0xFF), std::byte(0x0F) };
+                std::string text;
+                if (SpanDeserializer(huge).load(text) != Error::CorruptedArchive || SpanDeserializer(huge).load(loaded) != Error::CorruptedArchive)
+                    return false;
+                // 300 does not fit uint8_t, 128 (zigzag 256) does not fit int8_t
+                const std::byte wide[] = { std::byte(0xAC), std::byte(0x02) };
+                const std::byte positive[] = { std::byte(0x80), std::byte(0x02) };
+                uint8_t byte;
+                int8_t signed_byte;
+                std::stringstream stream("3 ab");
+                return SpanDeserializer(wide).load(byte) == Error::CorruptedArchive
+                    && SpanDeserializer(positive).load(signed_byte) == Error::CorruptedArchive
+                    && Deserializer(stream).load(text) == Error::CorruptedArchive;
+            }
+
+            // Every stream archive reads `numbers`, then "abc", as a T
+            template <class T>
+            bool streams_reject(std::initializer_list<uint64_t> numbers) {
+                std::stringstream text;
+                std::stringstream blocks;
+                std::stringstream binary;
+                BinarySerializer binary_serializer(binary);
+                for (uint64_t number : numbers) {
+                    text << number << ' ';
+                    binary_serializer(number);
+                }
+                text << "abc";
+                blocks << text.str();
+                binary << "abc";
+                T from_text{}, from_blocks{}, from_binary{};
+                return Deserializer(text).load(from_text) == Error::CorruptedArchive
+                    && TextDeserializer(blocks).load(from_blocks) == Error::CorruptedArchive
+                    && BinaryDeserializer(binary).load(from_binary) == Error::CorruptedArchive;
+            }
+
+            // Two versions of one record: V2 adds score (with a default) and tags, and
+            // sends its fields in another order
+            struct PersonV1 {
+                uint64_t id = 0;
+                std::string name;
+
+                template <class Serializer>
+                Error serialize(Serializer& serializer) {
+                    return serializer(tagged<1>(id), tagged<2>(name));
+                }
+            };
+
+            struct PersonV2 {
+                uint64_t id = 0;
+                std::string name;
+                uint32_t score = 0;
+                std::vector<std::string> tags = { "new" };
+
+                template <class Serializer>
+                Error serialize(Serializer& serializer) {
+                    return serializer(tagged<3>(score, 100u), tagged<1>(id), tagged<4>(tags), tagged<2>(name));
+                }
+            };
+
+            // Reuses id 2 for a number
+            struct PersonRenumbered {
+                uint64_t id = 0;
+                uint64_t name = 0;
+
+                template <class Serializer>
+                Error serialize(Serializer& serializer) {
+                    return serializer(tagged<1>(id), tagged<2>(name));
+                }
+            };
+
+            struct Team {
+                int32_t rank = 0;
+                std::vector<PersonV2> members;
+                Data stats{};
+
+                template <class Serializer>
+                Error serialize(Serializer& serializer) {
+                    return serializer(tagged<1>(rank, -1), tagged<2>(members), tagged<3>(stats));
+                }
+            };
+
+            // Writes `from` with every archive and reads it back as `to`
+            template <class From, class To, class Check>
+            bool convert(From& from, Check check, Error expected = Error::NoError) {
+                std::stringstream text;
+                std::stringstream blocks;
+                std::stringstream binary;
+                BufferSerializer buffer;
+                if (Serializer(text).save(from) != Error::NoError || TextSerializer(blocks).save(from) != Error::NoError
+                    || BinarySerializer(binary).save(from) != Error::NoError || buffer.save(from) != Error::NoError)
+                    return false;
+                To from_text, from_blocks, from_binary, from_span;
+                const Error text_error = Deserializer(text).load(from_text);
+                const Error blocks_error = TextDeserializer(blocks).load(from_blocks);
+                const Error binary_error = BinaryDeserializer(binary).load(from_binary);
+                const Error span_error = SpanDeserializer(buffer.data()).load(from_span);
+                if (text_error != expected || blocks_error != expected || binary_error != expected || span_error != expected)
+                    return false;
+                return expected != Error::NoError || (check(from_text) && check(from_blocks) && check(from_binary) && check(from_span));
+            }
+
+            bool check_tagged_round_trip() {
+                std::cout << "tagged records round trip, nested in containers";
+                Team team;
+                team.rank = -3;
+                team.members.resize(2);
+                team.members[0] = { 1, "ann", 7, { "a", "b" } };
+                team.members[1] = { 2, "bob", 0, {} };
+                team.stats = { 5, true, 6 };
+                return convert<Team, Team>(team, [&](const Team& loaded) {
+                    return loaded.rank == -3 && loaded.members.size() == 2
+                        && loaded.members[0].name == "ann" && loaded.members[0].score == 7 && loaded.members[0].tags == team.members[0].tags
+                        && loaded.members[1].id == 2 && loaded.members[1].score == 0 && loaded.members[1].tags.empty()
+                        && loaded.stats.a == 5 && loaded.stats.b && loaded.stats.c == 6;
+                });
+            }
+
+            bool check_tagged_versions() {
+                std::cout << "old and new record versions read each other";
+                PersonV1 old_person{ 7, "old" };
+                PersonV2 new_person{ 8, "new", 3, { "x" } };
+                return convert<PersonV1, PersonV2>(old_person, [](const PersonV2& loaded) {
+                        return loaded.id == 7 && loaded.name == "old" && loaded.score == 100 && loaded.tags == std::vector<std::string>{ "new" };
+                    })
+                    && convert<PersonV2, PersonV1>(new_person, [](const PersonV1& loaded) {
+                        return loaded.id == 8 && loaded.name == "new";
+                    });
+            }
+
+            bool check_tagged_errors() {
+                std::cout << "tagged records with another field type or cut short";
+                PersonV1 person{ 1, "name" };
+                if (!convert<PersonV1, PersonRenumbered>(person, [](const PersonRenumbered&) { return true; }, Error::SchemaMismatch))
+                    return false;
+                BufferSerializer buffer;
+                buffer.save(person);
+                PersonV2 loaded;
+                for (size_t size = 0; size < buffer.size(); ++size) {
+                    if (SpanDeserializer(buffer.data().first(size)).load(loaded) != Error::CorruptedArchive)
+                        return false;
+                }
+                return true;
+            }
+
+            bool check_stream_corrupted_sizes() {
+                std::cout << "corrupted sizes in streams fail without huge allocations";
+                const uint64_t name_key = schema::key(Tagged<2, std::string>::descriptor);
+                return streams_reject<std::string>({ uint64_t(1) << 62 })
+                    && streams_reject<std::vector<uint64_t>>({ uint64_t(1) << 40 })
+                    && streams_reject<std::vector<std::string>>({ uint64_t(1) << 40 })
+                    && streams_reject<Counters>({ uint64_t(1) << 40 })
+                    && streams_reject<PersonV1>({ 1, name_key, uint64_t(1) << 50 });
+            }
+
+            bool check_schema_descriptors() {
+                std::cout << "schema descriptors";
+                static_assert(Tagged<3, uint32_t, unsigned>::descriptor.kind == WireKind::Unsigned);
+                static_assert(schema::key(Tagged<2, std::string>::descriptor) == (2 << 3 | static_cast<int>(WireKind::String)));
+                const std::vector<FieldDescriptor> fields = schema::of<PersonV2>();
+                return fields.size() == 4
+                    && fields[0].id == 3 && fields[0].kind == WireKind::Unsigned && fields[0].has_default
+                    && fields[1].id == 1 && !fields[1].has_default
+                    && fields[2].id == 4 && fields[2].kind == WireKind::Sequence
+                    && fields[3].id == 2 && fields[3].kind == WireKind::String
+                    && schema::of<Team>()[2].kind == WireKind::Record
+                    && schema::of<Data>().empty();
+            }
+
+            // Records of a record stream test, told apart by their index
+            Data stream_record(uint64_t i) {
+                return { i * 7919, i % 3 == 0, i * i };
+            }
+
+            bool same_record(const Data& data, uint64_t i) {
+                const Data expected = stream_record(i);
+                return data.a == expected.a && data.b == expected.b && data.c == expected.c;
+            }
+
+            std::string write_stream(uint64_t records, record_stream::Options options) {
+                std::stringstream stream;
+                RecordWriter writer(stream, options);
+                for (uint64_t i = 0; i < records; ++i) {
+                    Data data = stream_record(i);
+                    writer.write(data);
+                }
+                return writer.close() == Error::NoError ? stream.str() : std::string();
+            }
+
+            bool check_crc32c() {
+                std::cout << "crc32c check value";
+                const char text[] = "123456789";
+                return record_stream::crc32c::compute(reinterpret_cast<const std::byte*>(text), 9) == 0xE3069283
+                    && record_stream::crc32c::compute(nullptr, 0) == 0;
+            }
+
+            bool check_record_stream_round_trip() {
+                std::cout << "record stream round trip over many chunks";
+                std::stringstream stream(write_stream(1000, { 64, true }));
+                RecordReader reader(stream);
+                if (reader.open() != Error::NoError || reader.count() != 1000 || reader.chunks().size() < 100)
+                    return false;
+                Data data;
+                for (uint64_t i = 0; i < 1000; ++i) {
+                    if (reader.read(data) != Error::NoError || !same_record(data, i))
+                        return false;
+                }
+                std::stringstream empty(write_stream(0, {}));
+                RecordReader empty_reader(empty);
+                return reader.read(data) == Error::EndOfArchive && reader.position() == 1000
+                    && empty_reader.open() == Error::NoError && empty_reader.count() == 0 && empty_reader.read(data) == Error::EndOfArchive;
+            }
+
+            bool check_record_stream_seek_split() {
+                std::cout << "record stream seek, resume and split";
+                const std::string file = write_stream(1000, { 100, false });
+                std::stringstream stream(file);
+                RecordReader reader(stream);
+                Data data;
+                if (reader.open() != Error::NoError)
+                    return false;
+                for (uint64_t index : { 999, 0, 517, 518, 1000 }) {
+                    if (reader.seek(index) != Error::NoError || reader.position() != index)
+                        return false;
+                    const Error error = reader.read(data);
+                    if (index == 1000 ? error != Error::EndOfArchive : error != Error::NoError || !same_record(data, index))
+                        return false;
+                }
+                if (reader.seek(1001) != Error::CorruptedArchive)
+                    return false;
+                const std::vector<record_stream::Range> ranges = reader.split(4);
+                uint64_t next = 0;
+                for (const record_stream::Range& range : ranges) {
+                    std::stringstream part(file);
+                    RecordReader part_reader(part);
+                    if (range.first != next || part_reader.open() != Error::NoError || part_reader.seek(range.first) != Error::NoError)
+                        return false;
+                    for (uint64_t i = range.first; i < range.first + range.count; ++i) {
+                        if (part_reader.read(data) != Error::NoError || !same_record(data, i))
+                            return false;
+                    }
+                    next = range.first + range.count;
+                }
+                return ranges.size() == 4 && next == 1000 && reader.split(5000).size() == reader.chunks().size();
+            }
+
+            bool check_record_stream_recovery() {
+                std::cout << "record stream without index or with damaged chunks";
+                std::stringstream stream;
+                std::string unclosed;
+                {
+                    RecordWriter writer(stream, { 64, true });
+                    for (uint64_t i = 0; i < 100; ++i) {
+                        Data data = stream_record(i);
+                        writer.write(data);
+                    }
+                    writer.flush();
+                    unclosed = stream.str();
+                }
+                // Cut into the last chunk: the reader keeps the chunks before it
+                std::stringstream torn(unclosed.substr(0, unclosed.size() - 3));
+                RecordReader reader(torn);
+                Data data;
+                if (reader.open() != Error::NoError || reader.count() == 0 || reader.count() >= 100)
+                    return false;
+                for (uint64_t i = 0; i < reader.count(); ++i) {
+                    if (reader.read(data) != Error::NoError || !same_record(data, i))
+                        return false;
+                }
+                if (reader.read(data) != Error::EndOfArchive)
+                    return false;
+                // A flipped payload byte fails the checksum
+                std::string damaged = write_stream(100, { 64, true });
+                damaged[record_stream::HeaderSize + record_stream::ChunkHeaderSize + 2] ^= 0x10;
+                std::stringstream damaged_stream(damaged);
+                RecordReader damaged_reader(damaged_stream);
+                std::stringstream not_a_stream("not a record stream");
+                RecordReader other(not_a_stream);
+                return damaged_reader.open() == Error::CorruptedArchive && other.open() == Error::CorruptedArchive;
+            }
+
+            bool lz_round_trip(const std::vector<std::byte>& input, size_t& packed_size) {
+                std::vector<std::byte> packed(lz::bound(input.size()));
+                packed_size = lz::compress(input.data(), input.size(), packed.data());
+                std::vector<std::byte> unpacked(input.size() + 1);
+                if (packed_size > packed.size() || !lz::decompress(packed.data(), packed_size, unpacked.data(), input.size())
+                    || !std::equal(input.begin(), input.end(), unpacked.begin())
+                    || lz::decompress(packed.data(), packed_size, unpacked.data(), input.size() + 1))
+                    return false;
+                for (size_t size = 0; size < packed_size; ++size) {
+                    if (lz::decompress(packed.data(), size, unpacked.data(), input.size()))
+                        return false;
+                }
+                return true;
+            }
+
+            bool check_lz_blocks() {
+                std::cout << "lz block compression round trip";
+                std::vector<std::vector<std::byte>> inputs(5);
+                inputs[1].assign(5, std::byte('x'));
+                for (size_t i = 0; i < 10000; ++i) {
+                    inputs[2].push_back(std::byte("abc"[i % 3]));
+                }
+                const std::string text = "serializer archives are large and i/o-bound; ";
+                for (size_t i = 0; i < 200; ++i) {
+                    for (char c : text + std::to_string(i * i)) {
+                        inputs[3].push_back(std::byte(c));
+                    }
+                }
+                uint64_t state = 88172645463325252ull;
+                for (size_t i = 0; i < 70000; ++i) {
+                    state ^= state << 13;
+                    state ^= state >> 7;
+                    state ^= state << 17;
+                    inputs[4].push_back(std::byte(state));
+                }
+                std::vector<size_t> sizes(inputs.size());
+                for (size_t i = 0; i < inputs.size(); ++i) {
+                    if (!lz_round_trip(inputs[i], sizes[i]))
+                        return false;
+                }
+                return sizes[0] == 1 && sizes[2] < 100 && sizes[3] * 3 < inputs[3].size() && sizes[4] <= lz::bound(inputs[4].size());
+            }
+
+            // Records repeating every `period`, which compress once a chunk holds a period
+            std::string write_periodic(uint64_t records, uint64_t period, record_stream::Options options) {
+                std::stringstream stream;
+                RecordWriter writer(stream, options);
+                for (uint64_t i = 0; i < records; ++i) {
+                    Data data = stream_record(i % period);
+                    writer.write(data);
+                }
+                return writer.close() == Error::NoError ? stream.str() : std::string();
+            }
+
+            bool check_record_stream_compressed() {
+                std::cout << "record stream with compressed chunks";
+                const std::string file = write_periodic(1000, 50, { 4096, true, true });
+                if (file.size() * 2 > write_periodic(1000, 50, { 4096, true }).size())
+                    return false;
+                // Chunks that do not compress are stored as they are
+                for (uint64_t period : { 50, 1000 }) {
+                    std::stringstream stream(period == 50 ? file : write_stream(1000, { 64, false, true }));
+                    RecordReader reader(stream);
+                    if (reader.open() != Error::NoError || reader.count() != 1000)
+                        return false;
+                    Data data;
+                    for (uint64_t i = 0; i < 1000; ++i) {
+                        if (reader.read(data) != Error::NoError || !same_record(data, i % period))
+                            return false;
+                    }
+                    if (reader.read(data) != Error::EndOfArchive || reader.seek(517) != Error::NoError
+                        || reader.read(data) != Error::NoError || !same_record(data, 517 % period))
+                        return false;
+                }
+                // Without checksums damaged blocks reach the decompressor, which rejects
+                // them or yields other bytes but stays within its buffers
+                const std::string unchecked = write_periodic(1000, 50, { 4096, false, true });
+                for (size_t i = record_stream::HeaderSize + record_stream::ChunkHeaderSize; i < unchecked.size(); i += 3) {
+                    std::string damaged = unchecked;
+                    damaged[i] ^= 0x5A;
+                    std::stringstream stream(damaged);
+                    RecordReader reader(stream);
+                    Data data;
+                    if (reader.open() == Error::NoError) {
+                        while (reader.read(data) == Error::NoError) {
+                        }
+                    }
+                }
+                return true;
+            }
+
+            bool check_thread_pool() {
+                std::cout << "thread pool runs tasks and returns their results";
+                ThreadPool pool(3);
+                std::vector<std::future<uint64_t>> results;
+                for (uint64_t i = 0; i < 100; ++i) {
+                    results.push_back(pool.exec([](uint64_t value) { return value * value; }, i));
+                }
+                uint64_t sum = 0;
+                for (std::future<uint64_t>& result : results) {
+                    sum += result.get();
+                }
+                return sum == 328350 && pool.size() == 3;
+            }
+
+            bool check_batch_round_trip() {
+                std::cout << "parallel batch encode and decode";
+                std::vector<Data> records(10000);
+                for (uint64_t i = 0; i < records.size(); ++i) {
+                    records[i] = stream_record(i);
+                }
+                ThreadPool pool(4);
+                ThreadPool single(1);
+                std::vector<std::byte> parallel, serial;
+                if (encode_batch(std::span<Data>(records), parallel, pool, 333) != Error::NoError
+                    || encode_batch(std::span<Data>(records), serial, single, 333) != Error::NoError
+                    || parallel != serial)
+                    return false;
+                // An encoder reused for a smaller batch must not leak the frames of the larger one
+                BatchEncoder encoder(pool, 333);
+                std::vector<std::byte> reused;
+                if (encoder.encode(std::span<Data>(records), reused) != Error::NoError || reused != parallel
+                    || encode_batch(std::span<Data>(records).first(1000), serial, single, 333) != Error::NoError
+                    || encoder.encode(std::span<Data>(records).first(1000), reused) != Error::NoError || reused != serial)
+                    return false;
+                std::vector<Data> loaded = { Data{ 1, true, 1 } };
+                if (decode_batch(std::span<const std::byte>(parallel), loaded, pool) != Error::NoError || loaded.size() != records.size())
+                    return false;
+                for (uint64_t i = 0; i < loaded.size(); ++i) {
+                    if (!same_record(loaded[i], i))
+                        return false;
+                }
+                std::vector<Data> none;
+                std::vector<std::byte> empty;
+                return encode_batch(std::span<Data>(none), empty, pool) == Error::NoError && empty.size() == 1
+                    && decode_batch(std::span<const std::byte>(empty), loaded, pool) == Error::NoError && loaded.empty();
+            }
+
+            struct Number {
+                uint64_t value = 0;
+
+                template <class Serializer>
+                Error serialize(Serializer& serializer) {
+                    return serializer(value);
+                }
+            };
+
+            // Number that throws from serialize() when it holds 3
+            struct Throwing {
+                uint64_t value = 0;
+
+                template <class Serializer>
+                Error serialize(Serializer& serializer) {
+                    Error error = serializer(value);
+                    if (value == 3) {
+                        throw std::runtime_error("record refused");
+                    }
+                    return error;
+                }
+            };
+
+            bool check_batch_exceptions() {
+                std::cout << "parallel batch rethrows after every frame is done";
+                ThreadPool pool(3);
+                std::vector<Throwing> records(200);
+                std::vector<Number> numbers(200);
+                for (uint64_t i = 0; i < records.size(); ++i) {
+                    records[i].value = i == 150 ? 3 : i + 4;
+                    numbers[i].value = i == 150 ? 3 : i + 4;
+                }
+                std::vector<std::byte> encoded;
+                bool thrown = false;
+                try {
+                    encode_batch(std::span<Throwing>(records), encoded, pool, 1);
+                }
+                catch (std::runtime_error&) {
+                    thrown = true;
+                }
+                // The same records as Number, loaded as Throwing
+                std::vector<Throwing> loaded;
+                if (!thrown || encode_batch(std::span<Number>(numbers), encoded, pool, 1) != Error::NoError)
+                    return false;
+                try {
+                    decode_batch(std::span<const std::byte>(encoded), loaded, pool);
+                }
+                catch (std::runtime_error&) {
+                    return true;
+                }
+                return false;
+            }
+
+            bool check_batch_corrupted() {
+                std::cout << "parallel batch decode of corrupted input";
+                std::vector<Data> records(50);
+                for (uint64_t i = 0; i < records.size(); ++i) {
+                    records[i] = stream_record(i);
+                }
+                ThreadPool pool(2);
+                std::vector<std::byte> encoded;
+                encode_batch(std::span<Data>(records), encoded, pool, 7);
+                std::vector<Data> loaded;
+                for (size_t size = 0; size < encoded.size(); ++size) {
+                    if (decode_batch(std::span<const std::byte>(encoded).first(size), loaded, pool) != Error::CorruptedArchive)
+                        return false;
+                }
+                // A frame claiming one record more than its payload holds
+                encoded[1] = std::byte(8);
+                return decode_batch(std::span<const std::byte>(encoded), loaded, pool) == Error::CorruptedArchive;
+            }
+
+            // Writes value with Serializer and TextSerializer and reads the text back
+            template <class T, class Check>
+            bool same_text(T& value, Check check) {
+                std::stringstream text;
+                std::stringstream blocks;
+                if (Serializer(text).save(value) != Error::NoError || TextSerializer(blocks).save(value) != Error::NoError || text.str() != blocks.str())
+                    return false;
+                T loaded{};
+                return TextDeserializer(blocks).load(loaded) == Error::NoError && check(loaded);
+            }
+
+            bool check_text_blocks_format() {
+                std::cout << "text blocks write what Serializer writes";
+                Data data{ 0, true, 1 };
+                std::stringstream stream;
+                TextSerializer(stream).save(data);
+                if (stream.str() != "0 true 1")
+                    return false;
+                Rich rich = make_rich();
+                // Longer than a block
+                std::string line(100000, 'x');
+                line[50000] = ' ';
+                return same_text(data, [](const Data& loaded) { return loaded.a == 0 && loaded.b && loaded.c == 1; })
+                    && same_text(rich, [&](const Rich& loaded) { return same(rich, loaded); })
+                    && same_text(line, [&](const std::string& loaded) { return loaded == line; });
+            }
+
+            bool check_text_blocks_input() {
+                std::cout << "text blocks across block boundaries and bad input";
+                // Records split by the caller's own newlines, over several blocks
+                std::stringstream stream;
+                TextSerializer serializer(stream);
+                for (uint64_t i = 0; i < 20000; ++i) {
+                    Data record = stream_record(i);
+                    serializer.save(record);
+                    stream << '\n';
+                }
+                TextDeserializer deserializer(stream);
+                Data record;
+                for (uint64_t i = 0; i < 20000; ++i) {
+                    if (deserializer(record) != Error::NoError || !same_record(record, i))
+                        return false;
+                }
+                if (deserializer(record) != Error::CorruptedArchive)
+                    return false;
+                // Either both text readers take an input or neither does
+                const char* const inputs[] = { "0 true 1", " 0\ttrue\n1", "0 false 18446744073709551615", "", "0o true 1", "0 tru 1",
+                    "0 True 1", "0 true", "0 true 1 ", "0 false 18446744073709551616", "1 true 2.5" };
+                for (const char* input : inputs) {
+                    std::stringstream text(input);
+                    std::stringstream blocks(input);
+                    Data expected{}, loaded{};
+                    const Error error = Deserializer(text).load(expected);
+                    if (TextDeserializer(blocks).load(loaded) != error)
+                        return false;
+                    if (error == Error::NoError && (loaded.a != expected.a || loaded.b != expected.b || loaded.c != expected.c))
+                        return false;
+                }
+                double fraction;
+                std::stringstream word("0.5x");
+                return TextDeserializer(word).load(fraction) == Error::CorruptedArchive;
+            }
         }
 
         std::vector<TestFunc> GetTests() {
@@ -78,6 +1079,40 @@ namespace made {
                 check_serializer_save_execute_correct,
                 check_deserializer_save_execute_correct,
                 check_deserializer_save_execute_uncorrect,
+                check_varint_sizes,
+                check_binary_round_trip,
+                check_binary_large_values,
+                check_binary_corrupted,
+                check_binary_write_failure,
+                check_buffer_matches_binary,
+                check_span_round_trip,
+                check_span_corrupted,
+                check_layout_offsets,
+                check_layout_view,
+                check_layout_view_rejects,
+                check_standard_types_round_trip,
+                check_standard_types_text,
+                check_bulk_format,
+                check_standard_types_corrupted,
+                check_tagged_round_trip,
+                check_tagged_versions,
+                check_tagged_errors,
+                check_stream_corrupted_sizes,
+                check_schema_descriptors,
+                check_crc32c,
+                check_record_stream_round_trip,
+                check_record_stream_seek_split,
+                check_record_stream_recovery,
+                check_lz_blocks,
+                check_record_stream_compressed,
+                check_thread_pool,
+                check_batch_round_trip,
+                check_batch_corrupted,
+                check_batch_exceptions,
+                check_varint_decode_many,
+                check_varint_arrays,
+                check_text_blocks_format,
+                check_text_blocks_input,
             };
         }
 
@@ -0,0 +1,362 @@
+#pragma once
+#ifndef TEXT_SERIALIZER_H_
+#define TEXT_SERIALIZER_H_
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "serializer.hpp"
+
+namespace made {
+
+    namespace serializer {
+
+        // The text format of Serializer and Deserializer without operator<< and >>:
+        // numbers go through std::to_chars and std::from_chars, bools are matched by
+        // hand, and the text moves between the stream buffer and a block of BlockSize
+        // bytes in single calls. Output is byte for byte that of Serializer. Neither
+        // side depends on the stream's locale or flags.
+        class TextSerializer : public ArchiveWriter<TextSerializer>
+        {
+            friend class ArchiveWriter<TextSerializer>;
+            static constexpr char Separator = ' ';
+            static constexpr bool BulkCopy = false;
+            using Sizer = TextSizer;
+            static constexpr size_t BlockSize = 1 << 16;
+            static constexpr size_t MaxNumber = 32;     // characters of the longest to_chars result
+        public:
+            explicit TextSerializer(std::ostream& out) : out_(*out.rdbuf()), buffer_(BlockSize) {}
+
+            template <class T>
+            Error save(T& object) {
+                return (*this)(object);
+            }
+
+            // The text of every call reaches the stream before it returns, so what is
+            // written to the stream between calls keeps its place. IoError from the
+            // first stream buffer that takes fewer characters than given on.
+            template <class... ArgsT>
+            Error operator()(ArgsT&&... args) {
+                Error result = process_fields(args...);
+                flush();
+                return failed_ ? Error::IoError : result;
+            }
+
+        private:
+            std::streambuf& out_;
+            std::vector<char> buffer_;
+            size_t size_ = 0;
+            bool failed_ = false;
+
+            using ArchiveWriter<TextSerializer>::process;
+
+            void flush() {
+                if (size_ != 0 && out_.sputn(buffer_.data(), static_cast<std::streamsize>(size_)) != static_cast<std::streamsize>(size_)) {
+                    failed_ = true;
+                }
+                size_ = 0;
+            }
+
+            // Room for `bytes` characters, at most BlockSize, at the end of the block
+            char* reserve(size_t bytes) {
+                if (BlockSize - size_ < bytes) {
+                    flush();
+                }
+                return buffer_.data() + size_;
+            }
+
+            void separate() {
+                *reserve(1) = Separator;
+                ++size_;
+            }
+
+            Error write_bool(bool value) {
+                return value ? write_bytes("true", 4) : write_bytes("false", 5);
+            }
+
+            template <class T>
+            Error write_number(T value) {
+                char* text = reserve(MaxNumber);
+                size_ += static_cast<size_t>(std::to_chars(text, text + MaxNumber, value).ptr - text);
+                return Error::NoError;
+            }
+
+            Error write_unsigned(uint64_t value) {
+                return write_number(value);
+            }
+
+            Error write_signed(int64_t value) {
+                return write_number(value);
+            }
+
+            template <class T>
+            Error write_float(T value) {
+                return write_number(value);
+            }
+
+            // Strings of a block or more bypass it
+            Error write_bytes(const void* data, size_t size) {
+                if (size >= BlockSize) {
+                    flush();
+                    if (out_.sputn(static_cast<const char*>(data), static_cast<std::streamsize>(size)) != static_cast<std::streamsize>(size)) {
+                        failed_ = true;
+                    }
+                }
+                else if (size != 0) {
+                    std::memcpy(reserve(size), data, size);
+                    size_ += size;
+                }
+                return Error::NoError;
+            }
+
+            template <class T, class... ArgsT>
+            Error process(T& value, ArgsT&... args) {
+                Error error = process(value);
+                if (error != Error::NoError) {
+                    return error;
+                }
+                separate();
+                return process(args...);
+            }
+        };
+
+        // Reads the stream a block at a time, so it takes input ahead of what it has
+        // parsed: read a stream with a single TextDeserializer and nothing else. Values
+        // are whitespace-separated as for operator>>; numbers are what from_chars
+        // takes, so unlike Deserializer no '+' sign and no '-' on unsigned values.
+        class TextDeserializer : public ArchiveReader<TextDeserializer> {
+            friend class ArchiveReader<TextDeserializer>;
+            static constexpr char Separator = ' ';
+            static constexpr bool BulkCopy = false;
+            static constexpr size_t BlockSize = 1 << 16;
+            // Longer numbers are rejected rather than read across blocks; what
+            // Serializer writes takes at most 24 characters
+            static constexpr size_t MaxNumber = 128;
+        public:
+            explicit TextDeserializer(std::istream& in)
+                : in_(in.rdbuf()), buffer_(BlockSize), position_(buffer_.data()), end_(position_) {}
+
+            // Like Deserializer::load, the object must take up the rest of the input
+            template <class T>
+            Error load(T& object) {
+                Error result = (*this)(object);
+                if (result == Error::NoError && fill(1)) {
+                    return Error::CorruptedArchive;
+                }
+                return result;
+            }
+
+            template <class... ArgsT>
+            Error operator()(ArgsT&&... args) {
+                return process_fields(args...);
+            }
+
+        private:
+            std::streambuf* in_;            // nullptr when the input is all in [position_, end_)
+            std::vector<char> buffer_;
+            const char* position_;
+            const char* end_;
+
+            // Payloads of tagged fields, read in place
+            TextDeserializer(const char* begin, size_t size) : in_(nullptr), position_(begin), end_(begin + size) {}
+
+            using ArchiveReader<TextDeserializer>::process;
+
+            size_t remaining() const {
+                return static_cast<size_t>(end_ - position_);
+            }
+
+            // True if `bytes` (at most BlockSize) characters are buffered, moving the
+            // rest of the block to its front and reading more if needed
+            bool fill(size_t bytes) {
+                if (remaining() >= bytes) {
+                    return true;
+                }
+                if (!in_) {
+                    return false;
+                }
+                const size_t kept = remaining();
+                std::memmove(buffer_.data(), position_, kept);
+                position_ = buffer_.data();
+                end_ = position_ + kept;
+                while (remaining() < bytes) {
+                    const std::streamsize read = in_->sgetn(buffer_.data() + remaining(), static_cast<std::streamsize>(BlockSize - remaining()));
+                    if (read <= 0) {
+                        return false;
+                    }
+                    end_ += read;
+                }
+                return true;
+            }
+
+            static bool is_space(char c) {
+                return c == ' ' || (c >= '\t' && c <= '\r');
+            }
+
+            // Passes over whitespace as operator>> does; false at the end of the input
+            bool skip_space() {
+                for (;;) {
+                    while (position_ != end_ && is_space(*position_)) {
+                        ++position_;
+                    }
+                    if (position_ != end_ || !fill(1)) {
+                        return position_ != end_;
+                    }
+                }
+            }
+
+            // A stream does not tell how much is left
+            uint64_t available() const {
+                return in_ ? std::numeric_limits<uint64_t>::max() : remaining();
+            }
+
+            Error read_bool(bool& value) {
+                if (!skip_space()) {
+                    return Error::CorruptedArchive;
+                }
+                fill(5);
+                if (remaining() >= 4 && std::memcmp(position_, "true", 4) == 0) {
+                    value = true;
+                    position_ += 4;
+                }
+                else if (remaining() >= 5 && std::memcmp(position_, "false", 5) == 0) {
+                    value = false;
+                    position_ += 5;
+                }
+                else {
+                    return Error::CorruptedArchive;
+                }
+                return Error::NoError;
+            }
+
+            template <class T>
+            Error read_number(T& value) {
+                if (!skip_space()) {
+                    return Error::CorruptedArchive;
+                }
+                fill(MaxNumber);
+                const std::from_chars_result result = std::from_chars(position_, end_, value);
+                if (result.ec != std::errc() || static_cast<size_t>(result.ptr - position_) >= MaxNumber) {
+                    return Error::CorruptedArchive;
+                }
+                position_ = result.ptr;
+                return Error::NoError;
+            }
+
+            Error read_unsigned(uint64_t& value) {
+                return read_number(value);
+            }
+
+            Error read_unsigned(uint64_t* values, size_t count) {
+                for (size_t i = 0; i < count; ++i) {
+                    Error error = read_number(values[i]);
+                    if (error != Error::NoError) {
+                        return error;
+                    }
+                }
+                return Error::NoError;
+            }
+
+            Error read_signed(int64_t& value) {
+                return read_number(value);
+            }
+
+            // Deserializer reads floating point values as whole words, so they must
+            // end at whitespace
+            template <class T>
+            Error read_float(T& value) {
+                Error error = read_number(value);
+                if (error == Error::NoError && position_ != end_ && !is_space(*position_)) {
+                    return Error::CorruptedArchive;
+                }
+                return error;
+            }
+
+            Error read_separator() {
+                if (!fill(1) || *position_ != Separator) {
+                    return Error::CorruptedArchive;
+                }
+                ++position_;
+                return Error::NoError;
+            }
+
+            // The rest of the characters past the block come straight from the stream
+            Error read_raw(char* data, size_t size) {
+                const size_t buffered = std::min(size, remaining());
+                if (buffered != 0) {
+                    std::memcpy(data, position_, buffered);
+                    position_ += buffered;
+                }
+                if (buffered == size) {
+                    return Error::NoError;
+                }
+                const std::streamsize rest = static_cast<std::streamsize>(size - buffered);
+                return in_ && in_->sgetn(data + buffered, rest) == rest ? Error::NoError : Error::CorruptedArchive;
+            }
+
+            // The single separator after the length, then the raw bytes
+            Error read_bytes(void* data, size_t size) {
+                Error error = read_separator();
+                if (error != Error::NoError) {
+                    return error;
+                }
+                return read_raw(static_cast<char*>(data), size);
+            }
+
+            Error read_more(void* data, size_t size) {
+                return read_raw(static_cast<char*>(data), size);
+            }
+
+            template <class T>
+            Error read_field(T& value, size_t length) {
+                if (length <= BlockSize) {
+                    if (read_separator() != Error::NoError || !fill(length)) {
+                        return Error::CorruptedArchive;
+                    }
+                    TextDeserializer payload(position_, length);
+                    position_ += length;
+                    return payload.load(value);
+                }
+                std::string payload;
+                Error error = read_byte_string(payload, length);
+                if (error != Error::NoError) {
+                    return error;
+                }
+                return TextDeserializer(payload.data(), length).load(value);
+            }
+
+            Error skip(size_t length) {
+                Error error = read_separator();
+                while (error == Error::NoError && length > 0) {
+                    if (!fill(1)) {
+                        return Error::CorruptedArchive;
+                    }
+                    const size_t step = std::min(length, remaining());
+                    position_ += step;
+                    length -= step;
+                }
+                return error;
+            }
+
+            template <class T, class... ArgsT>
+            Error process(T& value, ArgsT&... args) {
+                Error error = process(value);
+                if (error != Error::NoError) {
+                    return error;
+                }
+                return process(args...);
+            }
+        };
+    }
+}
+
+#endif  // !TEXT_SERIALIZER_H_
@@ -0,0 +1,212 @@
+#pragma once
+#ifndef VARINT_H_
+#define VARINT_H_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__AVX2__) || defined(__BMI2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace made {
+
+    namespace serializer {
+
+        // LEB128 unsigned integers: 7 bits per byte, least significant group first, the
+        // high bit set on every byte but the last. Values below 128 take a single byte,
+        // any uint64_t at most MaxBytes.
+        namespace varint {
+            constexpr size_t MaxBytes = 10;
+
+            inline size_t size(uint64_t value) {
+                size_t bytes = 1;
+                while (value >= 0x80) {
+                    value >>= 7;
+                    ++bytes;
+                }
+                return bytes;
+            }
+
+            // Writes at most MaxBytes bytes to out, returns how many
+            inline size_t encode(uint64_t value, uint8_t* out) {
+                size_t bytes = 0;
+                while (value >= 0x80) {
+                    out[bytes++] = static_cast<uint8_t>(value) | 0x80;
+                    value >>= 7;
+                }
+                out[bytes++] = static_cast<uint8_t>(value);
+                return bytes;
+            }
+
+            // next() returns the following byte, or a negative value at the end of input.
+            // False if the input ends inside the value or the value overflows 64 bits.
+            template <class NextByte>
+            bool read(NextByte next, uint64_t& value) {
+                uint64_t result = 0;
+                for (unsigned shift = 0; shift < 64; shift += 7) {
+                    const int byte = next();
+                    if (byte < 0) {
+                        return false;
+                    }
+                    result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                    if (byte < 0x80) {
+                        if (shift == 63 && byte > 1) {
+                            return false;
+                        }
+                        value = result;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // Reads one value from [begin, end), returns the position after it or nullptr
+            inline const uint8_t* decode(const uint8_t* begin, const uint8_t* end, uint64_t& value) {
+                if (end - begin >= static_cast<ptrdiff_t>(MaxBytes)) {
+                    // The longest value fits: no bounds check per byte
+                    uint64_t result = 0;
+                    for (unsigned shift = 0; shift < 64; shift += 7) {
+                        const uint8_t byte = *begin++;
+                        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                        if (byte < 0x80) {
+                            if (shift == 63 && byte > 1) {
+                                return nullptr;
+                            }
+                            value = result;
+                            return begin;
+                        }
+                    }
+                    return nullptr;
+                }
+                const bool ok = read([&]() { return begin != end ? static_cast<int>(*begin++) : -1; }, value);
+                return ok ? begin : nullptr;
+            }
+
+            namespace detail {
+                // The value of a varint of `length` bytes, at most 8, from the 8 bytes
+                // starting with it
+                inline uint64_t assemble(uint64_t word, size_t length) {
+                    word &= ~0ull >> (64 - 8 * length);
+#if defined(__BMI2__)
+                    return _pext_u64(word, 0x7F7F7F7F7F7F7F7Full);
+#else
+                    // Closes the gaps of the high bits: 7-bit groups to 14, 28 and 56 bits
+                    word &= 0x7F7F7F7F7F7F7F7Full;
+                    word = (word & 0x007F007F007F007Full) | ((word & 0x7F007F007F007F00ull) >> 1);
+                    word = (word & 0x00003FFF00003FFFull) | ((word & 0x3FFF00003FFF0000ull) >> 2);
+                    return (word & 0x000000000FFFFFFFull) | ((word & 0x0FFFFFFF00000000ull) >> 4);
+#endif
+                }
+            }
+
+#if defined(__AVX2__) || defined(__SSE2__)
+            namespace detail {
+                // Zero-extends 8 bytes to 8 values
+                inline void widen8(const uint8_t* in, uint64_t* out) {
+                    const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in));
+#if defined(__AVX2__)
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_cvtepu8_epi64(bytes));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4), _mm256_cvtepu8_epi64(_mm_srli_si128(bytes, 4)));
+#else
+                    const __m128i zero = _mm_setzero_si128();
+                    const __m128i words = _mm_unpacklo_epi8(bytes, zero);
+                    const __m128i low = _mm_unpacklo_epi16(words, zero);
+                    const __m128i high = _mm_unpackhi_epi16(words, zero);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi32(low, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2), _mm_unpackhi_epi32(low, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpacklo_epi32(high, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 6), _mm_unpackhi_epi32(high, zero));
+#endif
+                }
+            }
+#endif
+
+            // Reads up to `count` values from [begin, end) into values and moves begin
+            // past them, stopping early at the end of input or at a value decode() would
+            // reject; returns how many it read.
+            //
+            // A varint ends at the first byte below 0x80, so one SIMD compare finds where
+            // every value in a 16- or 32-byte block ends (as in masked VByte) and each
+            // value up to 8 bytes is put together from a single 8-byte load, without a
+            // branch per byte. Longer values and the last bytes of the input go through
+            // decode().
+            inline size_t decode_many(const uint8_t*& begin, const uint8_t* end, uint64_t* values, size_t count) {
+                size_t decoded = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+#if defined(__AVX2__)
+                constexpr ptrdiff_t Block = 32;
+#else
+                constexpr ptrdiff_t Block = 16;
+#endif
+                // Reads at most 8 bytes from any value start in the block
+                while (decoded < count && end - begin >= Block + 8) {
+#if defined(__AVX2__)
+                    uint32_t ends = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin))));
+#else
+                    uint32_t ends = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(begin)))) & 0xFFFF;
+#endif
+                    if (ends == 0) {
+                        return decoded;         // longer than MaxBytes
+                    }
+                    const uint8_t* start = begin;
+                    do {
+                        const unsigned offset = static_cast<unsigned>(start - begin);
+                        if (offset + 8 <= Block && ((ends >> offset) & 0xFF) == 0xFF && count - decoded >= 8) {
+                            // Eight single-byte values, the common case of small numbers
+                            detail::widen8(start, values + decoded);
+                            decoded += 8;
+                            start += 8;
+                            ends &= offset + 8 < 32 ? ~0u << (offset + 8) : 0;
+                            continue;
+                        }
+                        const uint8_t* next = begin + std::countr_zero(ends) + 1;
+                        const size_t length = static_cast<size_t>(next - start);
+                        if (length <= 8) {
+                            uint64_t word;
+                            std::memcpy(&word, start, sizeof(word));
+                            values[decoded] = detail::assemble(word, length);
+                        }
+                        else if (!decode(start, end, values[decoded])) {
+                            begin = start;
+                            return decoded;
+                        }
+                        ++decoded;
+                        start = next;
+                        ends &= ends - 1;
+                    } while (ends != 0 && decoded < count);
+                    begin = start;
+                }
+#endif
+                for (; decoded < count; ++decoded) {
+                    const uint8_t* next = decode(begin, end, values[decoded]);
+                    if (!next) {
+                        break;
+                    }
+                    begin = next;
+                }
+                return decoded;
+            }
+
+            // Reads exactly `count` values, returns the position after them or nullptr
+            inline const uint8_t* decode_array(const uint8_t* begin, const uint8_t* end, uint64_t* values, size_t count) {
+                return decode_many(begin, end, values, count) == count ? begin : nullptr;
+            }
+
+            // Signed integers interleaved by magnitude (0, -1, 1, -2, ...) so that small
+            // negative values stay short
+            inline uint64_t zigzag(int64_t value) {
+                return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+            }
+
+            inline int64_t unzigzag(uint64_t value) {
+                return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+            }
+        }
+    }
+}
+
+#endif  // !VARINT_H_
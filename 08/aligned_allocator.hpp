@@ -0,0 +1,132 @@
+#pragma once
+#ifndef ALIGNED_ALLOCATOR_H_
+#define ALIGNED_ALLOCATOR_H_
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "common.h"
+
+_MADE_BEGIN
+_STL_BEGIN
+
+// Allocator returning blocks aligned to Alignment bytes (never less than alignof(T)).
+// With UseHugePages blocks of huge_page_size and more are mapped on a huge page boundary
+// and advised as MADV_HUGEPAGE, so the kernel can back them with transparent huge pages.
+// On platforms without madvise the hint is dropped and such blocks are just page aligned.
+template <class T, std::size_t Alignment = 64, bool UseHugePages = false>
+class AlignedAllocator {
+    static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::true_type;
+
+    static constexpr size_type alignment = Alignment < alignof(T) ? alignof(T) : Alignment;
+    static constexpr size_type huge_page_size = static_cast<size_type>(2) << 20;
+
+    template <class U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment, UseHugePages>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment, UseHugePages>&) noexcept {}
+
+    [[nodiscard]] T* allocate(size_type count) {
+        if (count > max_size()) {
+            throw std::bad_array_new_length();
+        }
+        const size_type bytes = count * sizeof(T);
+        if (UseHugePages && bytes >= huge_page_size) {
+            return static_cast<T*>(MapHugePages(RoundUp(bytes, huge_page_size)));
+        }
+        return static_cast<T*>(::operator new(RoundUp(bytes, alignment), std::align_val_t(alignment)));
+    }
+
+    void deallocate(T* ptr, size_type count) noexcept {
+        const size_type bytes = count * sizeof(T);
+        if (UseHugePages && bytes >= huge_page_size) {
+            UnmapHugePages(ptr, RoundUp(bytes, huge_page_size));
+            return;
+        }
+        ::operator delete(ptr, RoundUp(bytes, alignment), std::align_val_t(alignment));
+    }
+
+    [[nodiscard]] size_type max_size() const noexcept {
+        return (std::numeric_limits<size_type>::max() - huge_page_size) / sizeof(T);
+    }
+
+private:
+    static constexpr size_type RoundUp(size_type bytes, size_type boundary) noexcept {
+        return (bytes + boundary - 1) & ~(boundary - 1);
+    }
+
+#if defined(__linux__)
+    // Over-maps by one huge page and trims both ends so the block starts on a huge page boundary
+    static void* MapHugePages(size_type bytes) {
+        const size_type mapped_size = bytes + huge_page_size;
+        void* mapped = mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        char* const mapped_begin = static_cast<char*>(mapped);
+        char* const mapped_end = mapped_begin + mapped_size;
+        char* const begin = reinterpret_cast<char*>(RoundUp(reinterpret_cast<size_type>(mapped_begin), huge_page_size));
+        char* const end = begin + bytes;
+        if (begin != mapped_begin) {
+            munmap(mapped_begin, begin - mapped_begin);
+        }
+        if (end != mapped_end) {
+            munmap(end, mapped_end - end);
+        }
+#if defined(MADV_HUGEPAGE)
+        madvise(begin, bytes, MADV_HUGEPAGE);
+#endif
+        return begin;
+    }
+
+    static void UnmapHugePages(void* ptr, size_type bytes) noexcept {
+        munmap(ptr, bytes);
+    }
+#else
+    static void* MapHugePages(size_type bytes) {
+        return ::operator new(bytes, std::align_val_t(huge_page_size));
+    }
+
+    static void UnmapHugePages(void* ptr, size_type bytes) noexcept {
+        ::operator delete(ptr, bytes, std::align_val_t(huge_page_size));
+    }
+#endif
+};
+
+template <class T, class U, std::size_t Alignment, bool UseHugePages>
+[[nodiscard]] bool operator==(const AlignedAllocator<T, Alignment, UseHugePages>&, const AlignedAllocator<U, Alignment, UseHugePages>&) noexcept {
+    return true;
+}
+
+template <class T, class U, std::size_t Alignment, bool UseHugePages>
+[[nodiscard]] bool operator!=(const AlignedAllocator<T, Alignment, UseHugePages>&, const AlignedAllocator<U, Alignment, UseHugePages>&) noexcept {
+    return false;
+}
+
+// Cache line aligned storage suitable for AVX-512 loads, huge pages for large buffers
+template <class T>
+using HugePageAllocator = AlignedAllocator<T, 64, true>;
+
+_STL_END
+_MADE_END
+
+#endif // !ALIGNED_ALLOCATOR_H_
@@ -0,0 +1,36 @@
+#include <vector>
+#include <iostream>
+#include <string>
+
+#include "vector_bench.hpp"
+
+namespace made {
+
+    namespace bench {
+
+        // Runs every benchmark whose name contains `filter` (all of them for an empty filter)
+        int RunBenchmarks(const BenchGetter& benchmarks_getter, const std::string& filter) {
+            std::vector<Benchmark> benchmarks = benchmarks_getter();
+            std::size_t benchmarks_count = benchmarks.size();
+            for (std::size_t i = 0; i < benchmarks_count; ++i) {
+                if (benchmarks[i].name.find(filter) == std::string::npos)
+                    continue;
+                std::cout << "Running benchmark " << i + 1 << "/" << benchmarks_count << "... "
+                    << benchmarks[i].name << std::endl;
+                try {
+                    benchmarks[i].function();
+                }
+                catch (std::exception &e) {
+                    std::cerr << "Failed!" << std::endl << e.what() << std::endl;
+                }
+            }
+            return 0;
+        }
+
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    made::bench::RunBenchmarks(&made::bench::stl::GetBenchmarks, argc > 1 ? argv[1] : "");
+}
@@ -0,0 +1,154 @@
+#pragma once
+#ifndef CONCURRENT_VECTOR_H_
+#define CONCURRENT_VECTOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "common.h"
+#include "vector.hpp"
+
+_MADE_BEGIN
+_STL_BEGIN
+
+// Append-only vector safe for concurrent push_back/grow_by from many threads.
+// Storage is a table of segments growing geometrically (8, 16, 32, ... elements),
+// so elements never move and returned references stay valid until destruction.
+// Appends are lock-free: a slot is claimed with a single fetch_add and a missing
+// segment is installed with compare-exchange. An element is readable by other threads
+// once they synchronize with the appending thread (join, future, etc.).
+// Growing is noexcept: a failed allocation or throwing constructor would leave a
+// claimed but unconstructed slot, so it terminates instead.
+template <class T, class Alloc = std::allocator<T>>
+class ConcurrentVector {
+private:
+    using alloc_traits = std::allocator_traits<Alloc>;
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using pointer = typename alloc_traits::pointer;
+    using reference = T&;
+    using const_reference = const T&;
+    using size_type = std::size_t;
+private:
+    static constexpr size_type kFirstSegmentLog = 3;
+    static constexpr size_type kMaxSegments = 64 - kFirstSegmentLog;
+
+    allocator_type alloc_;
+    std::atomic<size_type> size_;
+    std::atomic<pointer> segments_[kMaxSegments];
+public:
+    ConcurrentVector() : alloc_(allocator_type()), size_(0) {
+        for (auto& segment : segments_)
+            segment.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector() {
+        clear();
+        for (size_type s = 0; s < kMaxSegments; ++s) {
+            pointer segment = segments_[s].load(std::memory_order_relaxed);
+            if (segment)
+                alloc_.deallocate(segment, SegmentSize(s));
+        }
+    }
+
+    reference push_back(const_reference value) noexcept { return emplace_back(value); }
+    reference push_back(T&& value) noexcept { return emplace_back(std::move(value)); }
+
+    template <class... VT>
+    reference emplace_back(VT&&... values) noexcept {
+        const size_type index = size_.fetch_add(1, std::memory_order_relaxed);
+        pointer slot = Slot(index, true);
+        alloc_traits::construct(alloc_, slot, std::forward<VT>(values)...);
+        return *slot;
+    }
+
+    // Appends `count` default constructed elements and returns the index of the first one.
+    // The new elements are not contiguous when the range spans several segments.
+    size_type grow_by(size_type count) noexcept {
+        const size_type first = size_.fetch_add(count, std::memory_order_relaxed);
+        for (size_type i = first; i < first + count; ++i)
+            alloc_traits::construct(alloc_, Slot(i, true));
+        return first;
+    }
+
+    size_type grow_by(size_type count, const_reference value) noexcept {
+        const size_type first = size_.fetch_add(count, std::memory_order_relaxed);
+        for (size_type i = first; i < first + count; ++i)
+            alloc_traits::construct(alloc_, Slot(i, true), value);
+        return first;
+    }
+
+    [[nodiscard]] reference operator[](size_type i) noexcept { return *Slot(i, false); }
+    [[nodiscard]] const_reference operator[](size_type i) const noexcept { return *const_cast<ConcurrentVector*>(this)->Slot(i, false); }
+    [[nodiscard]] size_type size() const noexcept { return size_.load(std::memory_order_acquire); }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+    // Copies the elements into one contiguous Vector. Not safe against concurrent appends.
+    [[nodiscard]] Vector<T, Alloc> to_vector() const {
+        const size_type count = size();
+        Vector<T, Alloc> result;
+        result.reserve(count);
+        for (size_type s = 0, first = 0; first < count; ++s) {
+            const T* segment = segments_[s].load(std::memory_order_acquire);
+            const size_type last = std::min(count, first + SegmentSize(s));
+            for (size_type i = first; i < last; ++i)
+                result.push_back(segment[i - first]);
+            first = last;
+        }
+        return result;
+    }
+
+    // Destroys the elements but keeps the segments for reuse. Not safe against concurrent appends.
+    void clear() noexcept {
+        const size_type count = size();
+        for (size_type i = 0; i < count; ++i)
+            alloc_traits::destroy(alloc_, Slot(i, false));
+        size_.store(0, std::memory_order_release);
+    }
+
+private:
+    static size_type Log2(size_type value) noexcept {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(value);
+#else
+        size_type result = 0;
+        while (value >>= 1)
+            ++result;
+        return result;
+#endif
+    }
+
+    static size_type SegmentSize(size_type segment) noexcept {
+        return static_cast<size_type>(1) << (segment + kFirstSegmentLog);
+    }
+
+    // Element i lives in segment log2(i + 8) - 3 at offset (i + 8) - 2^log2(i + 8)
+    pointer Slot(size_type index, bool allocate) noexcept {
+        const size_type biased = index + SegmentSize(0);
+        const size_type log = Log2(biased);
+        const size_type segment = log - kFirstSegmentLog;
+        pointer base = segments_[segment].load(std::memory_order_acquire);
+        if (!base && allocate)
+            base = InstallSegment(segment);
+        return base + (biased - (static_cast<size_type>(1) << log));
+    }
+
+    pointer InstallSegment(size_type segment) noexcept {
+        pointer fresh = alloc_.allocate(SegmentSize(segment));
+        pointer expected = nullptr;
+        if (segments_[segment].compare_exchange_strong(expected, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+            return fresh;
+        alloc_.deallocate(fresh, SegmentSize(segment));
+        return expected;
+    }
+};
+
+_STL_END
+_MADE_END
+
+#endif // !CONCURRENT_VECTOR_H_
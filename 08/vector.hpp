@@ -4,6 +4,8 @@
 
 #include <cassert>
 #include <algorithm>
+#include <limits>
+#include <memory>
 
 #include "common.h"
 
@@ -170,6 +172,14 @@ public:
     {
     }
 
+    explicit Vector(const allocator_type& alloc)
+        : alloc_(alloc),
+        capacity_(0),
+        begin_(alloc_.allocate(capacity_)),
+        end_(begin_)
+    {
+    }
+
     explicit Vector(size_type count)
         : alloc_(Alloc()),
         capacity_(std::max(count, static_cast<size_type>(1))),
@@ -200,6 +210,57 @@ public:
             alloc_traits::construct(alloc_, end_, *(init_list.begin() + i));
     }
 
+    Vector(const Vector& copied)
+        : alloc_(alloc_traits::select_on_container_copy_construction(copied.alloc_)),
+        capacity_(copied.size()),
+        begin_(alloc_.allocate(capacity_)),
+        end_(begin_)
+    {
+        try {
+            end_ = std::uninitialized_copy(copied.begin_, copied.end_, begin_);
+        }
+        catch (...) {
+            alloc_.deallocate(begin_, capacity_);
+            throw;
+        }
+    }
+
+    Vector(Vector&& moved) noexcept
+        : alloc_(std::move(moved.alloc_)),
+        capacity_(moved.capacity_),
+        begin_(moved.begin_),
+        end_(moved.end_)
+    {
+        moved.capacity_ = 0;
+        moved.begin_ = nullptr;
+        moved.end_ = nullptr;
+    }
+
+    Vector& operator=(const Vector& copied) {
+        if (this != &copied) {
+            Vector temp(copied);
+            Swap(temp);
+        }
+        return *this;
+    }
+
+    Vector& operator=(Vector&& moved) noexcept {
+        if (this != &moved) {
+            Vector temp(std::move(moved));
+            Swap(temp);
+        }
+        return *this;
+    }
+
+    ~Vector() {
+        if (begin_) {
+            Destroy(begin_, end_);
+            alloc_.deallocate(begin_, capacity_);
+        }
+    }
+
+    [[nodiscard]] allocator_type get_allocator() const noexcept { return alloc_; }
+
     [[nodiscard]] iterator begin() noexcept { return iterator(begin_); }
     [[nodiscard]] reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
     [[nodiscard]] const_iterator cbegin() const noexcept { return const_iterator(begin_); }
@@ -231,6 +292,8 @@ public:
             ThrowRangeError();
         return begin_[pos];
     }
+    [[nodiscard]] pointer data() noexcept { return begin_; }
+    [[nodiscard]] const_pointer data() const noexcept { return begin_; }
     [[nodiscard]] reference front() noexcept { return *begin_; }
     [[nodiscard]] const_reference front() const noexcept { return *begin_; }
     [[nodiscard]] reference back() noexcept { return end_[-1]; }
@@ -412,6 +475,13 @@ private:
         SwapDestroying(new_begin, size(), new_capacity);
     }
 
+    void Swap(Vector& other) noexcept {
+        std::swap(alloc_, other.alloc_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(begin_, other.begin_);
+        std::swap(end_, other.end_);
+    }
+
     void Destroy(pointer _First, pointer _Last) {
         for (; _First != _Last; ++_First) {
             alloc_traits::destroy(alloc_, _First);
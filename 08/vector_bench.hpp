@@ -0,0 +1,204 @@
+#pragma once
+#ifndef VECTOR_BENCH_H_
+#define VECTOR_BENCH_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vector.hpp"
+#include "aligned_allocator.hpp"
+#include "concurrent_vector.hpp"
+
+namespace made {
+    namespace bench {
+        using BenchFunc = std::function<void()>;
+
+        struct Benchmark {
+            std::string name;
+            BenchFunc function;
+        };
+
+        using BenchGetter = std::function<std::vector<Benchmark>()>;
+
+        // Best wall time of `repeats` runs, in seconds
+        template <class Func>
+        double MeasureBest(Func&& func, int repeats = 5) {
+            double best = 0;
+            for (int i = 0; i < repeats; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                func();
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                if (i == 0 || elapsed.count() < best)
+                    best = elapsed.count();
+            }
+            return best;
+        }
+
+        // Stores the value through a volatile so the measured work is not optimized out
+        template <class T>
+        void Consume(const T& value) {
+            static volatile T sink;
+            sink = value;
+        }
+
+        inline void Report(const std::string& label, double seconds, double bytes) {
+            std::cout << "  " << std::left << std::setw(52) << label << std::right
+                << std::fixed << std::setprecision(3) << std::setw(10) << seconds * 1e3 << " ms"
+                << std::setw(10) << std::setprecision(2) << bytes / seconds / 1e9 << " GB/s" << std::endl;
+        }
+
+        namespace stl {
+            using namespace made::stl;
+
+#pragma region allocator_bench
+            constexpr std::size_t kAllocatorBenchCount = std::size_t(1) << 25; // 128MB of 4-byte elements
+            constexpr std::size_t kRandomAccesses = std::size_t(1) << 24;
+
+            template <class T, class Alloc>
+            void run_allocator_passes(const std::string& label) {
+                using Buffer = Vector<T, Alloc>;
+                const std::size_t count = kAllocatorBenchCount;
+                const double bytes = static_cast<double>(count * sizeof(T));
+
+                double seconds = MeasureBest([&]() {
+                    Buffer v(count, T(1));
+                    Consume(v[count - 1]);
+                }, 3);
+                Report(label + " allocate + first touch", seconds, bytes);
+
+                Buffer x(count, T(1));
+                Buffer y(count, T(2));
+                seconds = MeasureBest([&]() {
+                    T sum = 0;
+                    for (const T* p = x.data(), *end = p + count; p != end; ++p)
+                        sum += *p;
+                    Consume(sum);
+                });
+                Report(label + " streaming sum", seconds, bytes);
+
+                seconds = MeasureBest([&]() {
+                    T* py = y.data();
+                    const T* px = x.data();
+                    for (std::size_t i = 0; i < count; ++i)
+                        py[i] += T(3) * px[i];
+                    Consume(py[count / 2]);
+                });
+                Report(label + " streaming triad", seconds, bytes * 3);
+
+                seconds = MeasureBest([&]() {
+                    std::uint64_t state = 88172645463325252ull;
+                    T sum = 0;
+                    const T* px = x.data();
+                    for (std::size_t i = 0; i < kRandomAccesses; ++i) {
+                        state ^= state << 13;
+                        state ^= state >> 7;
+                        state ^= state << 17;
+                        sum += px[state & (count - 1)];
+                    }
+                    Consume(sum);
+                });
+                Report(label + " random access", seconds, static_cast<double>(kRandomAccesses * sizeof(T)));
+            }
+
+            void allocator_passes_int() {
+                run_allocator_passes<int, std::allocator<int>>("Vector<int> std::allocator");
+                run_allocator_passes<int, AlignedAllocator<int, 64>>("Vector<int> AlignedAllocator<64>");
+                run_allocator_passes<int, HugePageAllocator<int>>("Vector<int> HugePageAllocator");
+            }
+
+            void allocator_passes_float() {
+                run_allocator_passes<float, std::allocator<float>>("Vector<float> std::allocator");
+                run_allocator_passes<float, AlignedAllocator<float, 64>>("Vector<float> AlignedAllocator<64>");
+                run_allocator_passes<float, HugePageAllocator<float>>("Vector<float> HugePageAllocator");
+            }
+
+            std::vector<Benchmark> get_allocator_benchmarks() {
+                return {
+                    { "allocator passes over Vector<int>", allocator_passes_int },
+                    { "allocator passes over Vector<float>", allocator_passes_float },
+                };
+            }
+#pragma endregion allocator_bench
+
+#pragma region concurrent_vector_bench
+            constexpr std::size_t kAppendsPerThread = 2000000;
+
+            template <class Append>
+            void run_threaded_appends(std::size_t threads_count, Append& append) {
+                std::vector<std::thread> threads;
+                for (std::size_t t = 0; t < threads_count; ++t) {
+                    threads.emplace_back([&append, t]() {
+                        for (std::size_t i = 0; i < kAppendsPerThread; ++i)
+                            append(static_cast<int>(t * kAppendsPerThread + i));
+                    });
+                }
+                for (auto& thread : threads)
+                    thread.join();
+            }
+
+            void ReportAppends(const std::string& label, double seconds, std::size_t appends) {
+                std::cout << "  " << std::left << std::setw(52) << label << std::right
+                    << std::fixed << std::setprecision(3) << std::setw(10) << seconds * 1e3 << " ms"
+                    << std::setw(10) << std::setprecision(1) << appends / seconds / 1e6 << " Mappend/s" << std::endl;
+            }
+
+            void concurrent_appends() {
+                const std::size_t max_threads = std::max(4u, std::thread::hardware_concurrency());
+                for (std::size_t threads_count = 1; threads_count <= max_threads; threads_count *= 2) {
+                    const std::size_t appends = threads_count * kAppendsPerThread;
+                    double seconds = MeasureBest([&]() {
+                        std::mutex mutex;
+                        Vector<int> v;
+                        auto append = [&](int value) {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            v.push_back(value);
+                        };
+                        run_threaded_appends(threads_count, append);
+                        Consume(v.size());
+                    }, 3);
+                    ReportAppends(std::to_string(threads_count) + " threads, mutex + Vector::push_back", seconds, appends);
+
+                    seconds = MeasureBest([&]() {
+                        ConcurrentVector<int> cv;
+                        auto append = [&](int value) { cv.push_back(value); };
+                        run_threaded_appends(threads_count, append);
+                        Consume(cv.size());
+                    }, 3);
+                    ReportAppends(std::to_string(threads_count) + " threads, ConcurrentVector::push_back", seconds, appends);
+
+                    ConcurrentVector<int> cv;
+                    auto append = [&](int value) { cv.push_back(value); };
+                    run_threaded_appends(threads_count, append);
+                    seconds = MeasureBest([&]() {
+                        Vector<int> compact = cv.to_vector();
+                        Consume(compact.size());
+                    }, 3);
+                    Report(std::to_string(threads_count) + " threads, ConcurrentVector::to_vector()", seconds, static_cast<double>(appends * sizeof(int) * 2));
+                }
+            }
+
+            std::vector<Benchmark> get_concurrent_vector_benchmarks() {
+                return {
+                    { "concurrent appends", concurrent_appends },
+                };
+            }
+#pragma endregion concurrent_vector_bench
+
+            std::vector<Benchmark> GetBenchmarks() {
+                std::vector<Benchmark> result = get_allocator_benchmarks();
+                std::vector<Benchmark> other = get_concurrent_vector_benchmarks();
+                result.insert(result.end(), other.begin(), other.end());
+                return result;
+            }
+        }
+    }
+}
+
+#endif // !VECTOR_BENCH_H_
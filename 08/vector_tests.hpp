@@ -4,8 +4,11 @@
 
 #include <algorithm>
 #include <functional>
+#include <thread>
 
 #include "vector.hpp"
+#include "aligned_allocator.hpp"
+#include "concurrent_vector.hpp"
 #include <deque>
 
 namespace made {
@@ -323,6 +326,109 @@ namespace made {
             }
 #pragma endregion uninitialized_move_tests
 
+#pragma region allocator_tests
+            bool check_copy_and_move() {
+                std::cout << "testing copy and move";
+                Vector<A> v{ 1, 3, 4 };
+                Vector<A> copied(v);
+                copied[0].x = 7;
+                Vector<A> moved(std::move(v));
+                Vector<A> assigned{ 5 };
+                assigned = copied;
+                return v.empty() && moved.size() == 3 && moved[0].x == 1
+                    && copied[0].x == 7 && assigned.size() == 3 && assigned[2].x == 4;
+            }
+
+            bool check_aligned_allocator() {
+                std::cout << "testing AlignedAllocator<float, 64> alignment while growing";
+                Vector<float, AlignedAllocator<float, 64>> v;
+                for (int i = 0; i < 1000; ++i) {
+                    v.push_back(static_cast<float>(i));
+                    if (reinterpret_cast<std::uintptr_t>(v.data()) % 64 != 0)
+                        return false;
+                }
+                return v[999] == 999.0f;
+            }
+
+            bool check_huge_page_allocator() {
+                std::cout << "testing HugePageAllocator<int> on a 8MB buffer";
+                const std::size_t count = 2 << 20;
+                Vector<int, HugePageAllocator<int>> v(count, 1);
+                if (reinterpret_cast<std::uintptr_t>(v.data()) % HugePageAllocator<int>::huge_page_size != 0)
+                    return false;
+                v[count - 1] = 5;
+                Vector<int, HugePageAllocator<int>> small(16, 3);
+                return v[0] == 1 && v[count - 1] == 5
+                    && reinterpret_cast<std::uintptr_t>(small.data()) % 64 == 0;
+            }
+
+            std::vector<TestFunc> get_allocator_test_functions() {
+                return {
+                    check_copy_and_move,
+                    check_aligned_allocator,
+                    check_huge_page_allocator,
+                };
+            }
+#pragma endregion allocator_tests
+
+#pragma region concurrent_vector_tests
+            bool check_concurrent_push_back() {
+                std::cout << "testing ConcurrentVector push_back keeps references stable";
+                ConcurrentVector<int> v;
+                int* first = &v.push_back(0);
+                for (int i = 1; i < 1000; ++i) {
+                    if (v.push_back(i) != i)
+                        return false;
+                }
+                for (int i = 0; i < 1000; ++i) {
+                    if (v[i] != i)
+                        return false;
+                }
+                return first == &v[0] && v.size() == 1000;
+            }
+
+            bool check_concurrent_grow_by() {
+                std::cout << "testing ConcurrentVector grow_by across segments";
+                ConcurrentVector<B> v;
+                v.push_back(B(1));
+                std::size_t first = v.grow_by(100, B(7));
+                return first == 1 && v.size() == 101 && v[0].x == 1 && v[1].x == 7 && v[100].x == 7;
+            }
+
+            bool check_concurrent_threads_to_vector() {
+                std::cout << "testing ConcurrentVector push_back from 4 threads";
+                const int threads_count = 4;
+                const int per_thread = 10000;
+                ConcurrentVector<int> v;
+                std::vector<std::thread> threads;
+                for (int t = 0; t < threads_count; ++t) {
+                    threads.emplace_back([&v, t]() {
+                        for (int i = 0; i < per_thread; ++i)
+                            v.push_back(t * per_thread + i);
+                    });
+                }
+                for (auto& thread : threads)
+                    thread.join();
+                Vector<int> result = v.to_vector();
+                std::sort(result.begin(), result.end());
+                if (result.size() != threads_count * per_thread)
+                    return false;
+                for (int i = 0; i < threads_count * per_thread; ++i) {
+                    if (result[i] != i)
+                        return false;
+                }
+                return true;
+            }
+
+            std::vector<TestFunc> get_concurrent_vector_test_functions() {
+                return {
+                    check_concurrent_push_back,
+                    check_concurrent_grow_by,
+                    check_concurrent_threads_to_vector,
+                };
+            }
+#pragma endregion concurrent_vector_tests
+
             template <typename T>
             struct type_wrapper { using type = T; };
 
@@ -347,6 +453,10 @@ namespace made {
                 result.insert(result.end(), other.begin(), other.end());
                 other = get_uninitialized_move_test_functions();
                 result.insert(result.end(), other.begin(), other.end());
+                other = get_allocator_test_functions();
+                result.insert(result.end(), other.begin(), other.end());
+                other = get_concurrent_vector_test_functions();
+                result.insert(result.end(), other.begin(), other.end());
                 return result;
             }
         }
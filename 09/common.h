@@ -1,6 +1,6 @@
 #pragma once
-#ifndef COMMON_H_
-#define COMMON_H_
+#ifndef MULTITHREADING_COMMON_H_
+#define MULTITHREADING_COMMON_H_
 
 #define _MADE_BEGIN namespace made {
 #define _MADE_END }
@@ -10,4 +10,4 @@
 #define _TEST_END }
 
 
-#endif //!COMMON_H_
\ No newline at end of file
+#endif //!MULTITHREADING_COMMON_H_
\ No newline at end of file
@@ -11,7 +11,10 @@ ThreadPool::ThreadPool(size_t poolSize) {
 }
 
 ThreadPool::~ThreadPool() {
-    shutdown_ = true;
+    {
+        std::unique_lock<std::mutex> lock(tasks_mutex_);
+        shutdown_ = true;
+    }
     tasks_notifier_.notify_all();
     for (auto& thread : pool_)
         if (thread.joinable())
@@ -20,13 +23,17 @@ ThreadPool::~ThreadPool() {
 
 void ThreadPool::RunThreadLifeCycle() {
     while (true) {
-        std::unique_lock<std::mutex> lock(tasks_mutex_);
-        while (!shutdown_ && tasks_.empty())
-            tasks_notifier_.wait(lock);
-        if (shutdown_)
-            return;
-        tasks_.front()();
-        tasks_.pop();
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasks_mutex_);
+            while (!shutdown_ && tasks_.empty())
+                tasks_notifier_.wait(lock);
+            if (tasks_.empty())
+                return;
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
     }
 }
 
@@ -14,11 +14,17 @@
 _MADE_BEGIN
 _MULTITHREADING_BEGIN
 
+// Workers take tasks off the queue under the lock and run them outside of it, so
+// tasks run side by side. The destructor finishes the tasks already queued.
 class ThreadPool
 {
 public:
     explicit ThreadPool(size_t poolSize);
     ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return pool_.size(); }
 
     template <class Func, class... Args>
     auto exec(Func func, Args... args)->std::future<decltype(func(args...))> {
@@ -32,10 +32,35 @@ bool multiply_chain() {
     return task3.get() == 125;
 }
 
+bool tasks_run_side_by_side() {
+    std::cout << "running tasks waiting on each other";
+    // The first task only finishes once the second one has run
+    ThreadPool pool(2);
+    std::promise<int> started;
+    std::future<int> second_started = started.get_future();
+    auto task1 = pool.exec([&second_started]() { return second_started.get() + 1; });
+    auto task2 = pool.exec([&started]() { started.set_value(1); });
+    task2.get();
+    return task1.get() == 2 && pool.size() == 2;
+}
+
+bool destructor_finishes_queued_tasks() {
+    std::cout << "finishing queued tasks on destruction";
+    std::future<int> last;
+    {
+        ThreadPool pool(1);
+        for (int i = 0; i < 100; ++i)
+            last = pool.exec([i]() { return i; });
+    }
+    return last.get() == 99;
+}
+
 std::vector<TestFunc> GetTests() {
     return {
         thread_sample,
         multiply_chain,
+        tasks_run_side_by_side,
+        destructor_finishes_queued_tasks,
     };
 }
 